@@ -0,0 +1,425 @@
+/* ************************************************************//** @file ana.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Network analytics: the clustering coefficient C and the characteristic
+       path length L of Ref.[1] of swn.c.
+
+C is exact, from a count of the triangles at every node.  L is estimated from
+breadth-first searches out of a sample of source nodes; the searches proceed
+64 at a time, each node carrying one bit per search, so a single sweep over
+the links of the frontier advances all 64.  Both use several threads.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ana.h"
+#include "par.h"
+
+#define ANA_RANGE (1 << 12)  /**< Nodes handed to a thread at a time         */
+
+/** Work of one thread of anaclustering() */
+struct anatri
+  {
+  int           manynode;     /**< The number of nodes                       */
+  struct node  *pnode0;       /**< The base of the array of nodes            */
+  int          *pnext;        /**< Next range of nodes to be claimed         */
+  struct node **ptable;       /**< Hash table of the neighbours of a node    */
+  size_t        roomtable;    /**< Number of entries at .ptable              */
+  double        sumlocal;     /**< Sum of local clustering coefficients      */
+  double        sumhit;       /**< Sum of twice the triangles at each node   */
+  double        sumpair;      /**< Sum of ordered pairs of neighbours        */
+  int           rc;           /**< Zero unless error                         */
+  };
+
+/** Work of one thread of anapathlength() */
+struct anabfs
+  {
+  int           phase;        /**< 0 => clear, 1 => expand, 2 => commit      */
+  int           thread;       /**< This thread's number                      */
+  int           manythread;   /**< The number of threads                     */
+  int           manynode;     /**< The number of nodes                       */
+  int           level;        /**< Distance of the nodes being committed     */
+  struct node  *pnode0;       /**< The base of the array of nodes            */
+  uint64_t     *pseen;        /**< Searches which have reached each node     */
+  uint64_t     *pfront;       /**< Searches for which a node is in frontier  */
+  uint64_t     *pnext;        /**< Searches reaching a node at this level    */
+  int          *pfrom;        /**< This thread's share of the frontier       */
+  size_t        manyfrom;     /**< Number of entries in use at .pfrom        */
+  size_t        roomfrom;     /**< Number of entries allocated at .pfrom     */
+  int          *pto;          /**< Nodes this thread found for next frontier */
+  size_t        manyto;       /**< Number of entries in use at .pto          */
+  size_t        roomto;       /**< Number of entries allocated at .pto       */
+  double        sumdist;      /**< Sum of distances from the sources         */
+  double        sumpair;      /**< Number of (source, node) pairs reached    */
+  int           rc;           /**< Zero unless error                         */
+  };
+
+/* ************************************************************************//**
+@brief   Slot of a node in a hash table of  mask+1  entries.
+*//***************************************************************************/
+static inline size_t
+ slot(const struct node *pnode, const struct node *pnode0, size_t mask)
+{
+return (size_t)(((uint64_t)(pnode - pnode0) * 0x9E3779B97F4A7C15ULL) >> 20) \
+                                                                       & mask;
+}
+/* ************************************************************************//**
+@brief   Count the triangles at each node of the ranges claimed by one thread.
+         The neighbours of node  j  are put in a hash table, and every
+         neighbour of every neighbour is looked up in it.
+*//***************************************************************************/
+static void *
+ triangles(void *pvoid)
+{
+struct anatri *pw;
+struct node *pnode0, **pp, **ppm, **ptable;
+size_t d, room, mask, s, hit;
+void *pnew;
+int j, jend;
+
+pw = (struct anatri *)pvoid;
+pnode0 = pw->pnode0;
+while (1)
+  {
+  j = __atomic_fetch_add(pw->pnext, ANA_RANGE, __ATOMIC_RELAXED);
+  if (j >= pw->manynode) break;
+  jend = ((pw->manynode - j) > ANA_RANGE) ? j + ANA_RANGE : pw->manynode;
+  for (; j < jend; j++)
+    {
+    pp = (pnode0 + j)->pp0;
+    while (NULL != *pp) { pp++; }
+    d = (size_t)(pp - (pnode0 + j)->pp0);
+    if (2 > d) continue;
+    for (room = 16; room < 2 * d; room *= 2) {;}
+    if (room > pw->roomtable)
+      {
+      if (NULL == (pnew = realloc(pw->ptable, room * sizeof(struct node *))))
+        {
+        pw->rc = -8; return NULL;
+        }
+      pw->ptable = (struct node **)pnew;
+      memset(pw->ptable + pw->roomtable, 0, \
+                           (room - pw->roomtable) * sizeof(struct node *));
+      pw->roomtable = room;
+      }
+    ptable = pw->ptable; mask = room - 1;
+    for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+      {
+      for (s = slot(*pp, pnode0, mask); NULL != *(ptable + s); s = (s+1) & mask)
+        {;}
+      *(ptable + s) = *pp;
+      }
+    hit = 0;
+    for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+      {
+      for (ppm = (*pp)->pp0; NULL != *ppm; ppm++)
+        {
+        for (s = slot(*ppm, pnode0, mask); NULL != *(ptable + s); \
+                                                              s = (s+1) & mask)
+          {
+          if (*(ptable + s) == *ppm) { hit++; break; }
+          }
+        }
+      }
+    for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+      {
+      for (s = slot(*pp, pnode0, mask); *(ptable + s) != *pp; s = (s+1) & mask)
+        {;}
+      *(ptable + s) = NULL;     /* leaves the table empty for the next node */
+      }
+    pw->sumlocal += ((double)hit) / ((double)d * (double)(d - 1));
+    pw->sumhit   += (double)hit;
+    pw->sumpair  += (double)d * (double)(d - 1);
+    }
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief   Compute the clustering coefficient exactly.
+@param   manynode    The number of nodes.
+@param   pnode0      The base of the array of nodes.
+@param   manythread  The number of threads.
+@param   pana        Location to receive .clustering and .transitivity.
+@return              Zero unless error.
+@note    Nodes with fewer than two neighbours count as having local
+         clustering coefficient zero, as in Ref.[1] of swn.c.
+*//***************************************************************************/
+int
+ anaclustering(int manynode, struct node *pnode0, int manythread, \
+                                                        struct analytics *pana)
+{
+struct anatri *pw0;
+double sumlocal, sumhit, sumpair;
+int n, next, rc;
+
+if (1 > manythread) manythread = 1;
+if (NULL == (pw0 = (struct anatri *)calloc(manythread, sizeof(struct anatri))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+next = 0;
+for (n = 0; n < manythread; n++)
+  {
+  (pw0 + n)->manynode = manynode; (pw0 + n)->pnode0 = pnode0;
+  (pw0 + n)->pnext = &next;
+  }
+rc = parallel(manythread, triangles, pw0, sizeof(struct anatri));
+sumlocal = 0.; sumhit = 0.; sumpair = 0.;
+for (n = 0; n < manythread; n++)
+  {
+  if ((pw0 + n)->rc) rc = (pw0 + n)->rc;
+  sumlocal += (pw0 + n)->sumlocal;
+  sumhit   += (pw0 + n)->sumhit;
+  sumpair  += (pw0 + n)->sumpair;
+  free((pw0 + n)->ptable);
+  }
+free(pw0);
+if (rc) { fprintf(stderr, "ERROR: memory request refused\n"); return rc; }
+pana->clustering   = sumlocal / (double)manynode;
+pana->transitivity = (0. < sumpair) ? sumhit / sumpair : 0.;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Append a node to a growable list.
+@return  Zero unless error.
+*//***************************************************************************/
+static inline int
+ append(int **pplist, size_t *pmany, size_t *proom, int j)
+{
+void *pnew;
+size_t room;
+
+if (*pmany >= *proom)
+  {
+  room = *proom ? 2 * *proom : 1024;
+  if (NULL == (pnew = realloc(*pplist, room * sizeof(int)))) return -8;
+  *pplist = (int *)pnew; *proom = room;
+  }
+*(*pplist + (*pmany)++) = j;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Carry out one phase of one level of 64 concurrent searches, on the
+         share of the work belonging to one thread.
+*//***************************************************************************/
+static void *
+ searches(void *pvoid)
+{
+struct anabfs *pw;
+struct node *pnode0, **pp;
+uint64_t bits, add, next;
+size_t i;
+int j, jend, u;
+
+pw = (struct anabfs *)pvoid;
+pnode0 = pw->pnode0;
+switch (pw->phase)
+  {
+  case 0:
+    j = (int)(((int64_t)pw->manynode * pw->thread) / pw->manythread);
+    jend = (int)(((int64_t)pw->manynode * (pw->thread + 1)) / pw->manythread);
+    memset(pw->pseen  + j, 0, (size_t)(jend - j) * sizeof(uint64_t));
+    memset(pw->pfront + j, 0, (size_t)(jend - j) * sizeof(uint64_t));
+    memset(pw->pnext  + j, 0, (size_t)(jend - j) * sizeof(uint64_t));
+    break;
+/*-----------------------------------------------------------------------------
+EXPAND: OFFER EACH NEIGHBOUR OF THE FRONTIER THE SEARCHES IT HAS NOT YET SEEN.
+ONLY THIS THREAD READS .pfront AT ITS OWN FRONTIER NODES, SO MAY CLEAR THEM.
+-----------------------------------------------------------------------------*/
+  case 1:
+    pw->manyto = 0;
+    for (i = 0; i < pw->manyfrom; i++)
+      {
+      j = *(pw->pfrom + i);
+      bits = *(pw->pfront + j); *(pw->pfront + j) = 0;
+      for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+        {
+        u = (int)(*pp - pnode0);
+        next = (1 == pw->manythread) ? *(pw->pnext + u) : \
+                           __atomic_load_n(pw->pnext + u, __ATOMIC_RELAXED);
+        add = bits & ~(*(pw->pseen + u) | next);
+        if ( ! add) continue;
+        if (1 == pw->manythread)
+          {
+          if (*(pw->pnext + u)) { *(pw->pnext + u) |= add; continue; }
+          *(pw->pnext + u) = add;
+          }
+        else if (__atomic_fetch_or(pw->pnext + u, add, __ATOMIC_RELAXED))
+          {
+          continue;
+          }
+        if (append(&pw->pto, &pw->manyto, &pw->roomto, u))
+          {
+          pw->rc = -8; return NULL;
+          }
+        }
+      }
+    break;
+/*-----------------------------------------------------------------------------
+COMMIT: THE NODES FIRST OFFERED TO THIS THREAD FORM ITS SHARE OF THE FRONTIER
+-----------------------------------------------------------------------------*/
+  case 2:
+    for (i = 0; i < pw->manyto; i++)
+      {
+      u = *(pw->pto + i);
+      bits = *(pw->pnext + u); *(pw->pnext + u) = 0;
+      *(pw->pseen + u) |= bits;
+      *(pw->pfront + u) = bits;
+      pw->sumdist += (double)pw->level * (double)__builtin_popcountll(bits);
+      pw->sumpair += (double)__builtin_popcountll(bits);
+      }
+    {
+    int *pswap; size_t swap;
+
+    pswap = pw->pfrom; pw->pfrom = pw->pto; pw->pto = pswap;
+    swap = pw->roomfrom; pw->roomfrom = pw->roomto; pw->roomto = swap;
+    pw->manyfrom = pw->manyto; pw->manyto = 0;
+    }
+    break;
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief   Estimate the characteristic path length.
+@param   manynode    The number of nodes.
+@param   pnode0      The base of the array of nodes.
+@param   manysource  The number of source nodes, drawn at random.
+@param   seed        Seed for the choice of sources.
+@param   manythread  The number of threads.
+@param   pana        Location to receive .length, .reach and .manysource.
+@return              Zero unless error.
+@note    Needs 24 bytes per node whatever the number of threads.
+*//***************************************************************************/
+int
+ anapathlength(int manynode, struct node *pnode0, int manysource, \
+                         unsigned int seed, int manythread, struct analytics *pana)
+{
+struct anabfs *pw0, *pw;
+uint64_t *pseen, *pfront, *pnext, state;
+double sumdist, sumpair;
+size_t manyfrom;
+int n, k, batch, level, j, rc;
+
+if (1 > manythread) manythread = 1;
+pseen  = (uint64_t *)malloc((size_t)manynode * sizeof(uint64_t));
+pfront = (uint64_t *)malloc((size_t)manynode * sizeof(uint64_t));
+pnext  = (uint64_t *)malloc((size_t)manynode * sizeof(uint64_t));
+pw0 = (struct anabfs *)calloc(manythread, sizeof(struct anabfs));
+if ((NULL == pseen) || (NULL == pfront) || (NULL == pnext) || (NULL == pw0))
+  {
+  free(pseen); free(pfront); free(pnext); free(pw0);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 0; n < manythread; n++)
+  {
+  pw = pw0 + n;
+  pw->thread = n; pw->manythread = manythread; pw->manynode = manynode;
+  pw->pnode0 = pnode0;
+  pw->pseen = pseen; pw->pfront = pfront; pw->pnext = pnext;
+  }
+rc = 0;
+for (batch = 0; (batch < manysource) && ( ! rc); batch += 64)
+  {
+/*-----------------------------------------------------------------------------
+CLEAR THE BITS, THEN START UP TO 64 SEARCHES, SHARING OUT THEIR SOURCES
+-----------------------------------------------------------------------------*/
+  for (n = 0; n < manythread; n++)
+    {
+    (pw0 + n)->phase = 0; (pw0 + n)->manyfrom = 0;
+    }
+  if ((rc = parallel(manythread, searches, pw0, sizeof(struct anabfs)))) break;
+  for (k = 0; (k < 64) && (batch + k < manysource); k++)
+    {
+    state = rngstream((uint64_t)seed, (uint64_t)(batch + k));
+    j = (int)rngbelow(&state, manynode);
+    if ( ! *(pfront + j))
+      {
+      pw = pw0 + (k % manythread);
+      if (append(&pw->pfrom, &pw->manyfrom, &pw->roomfrom, j)) { rc = -8; break; }
+      }
+    *(pseen + j)  |= ((uint64_t)1) << k;
+    *(pfront + j) |= ((uint64_t)1) << k;
+    }
+/*-----------------------------------------------------------------------------
+ADVANCE ALL THE SEARCHES ONE LEVEL AT A TIME UNTIL NONE HAS A FRONTIER
+-----------------------------------------------------------------------------*/
+  for (level = 1; ! rc; level++)
+    {
+    for (n = 0, manyfrom = 0; n < manythread; n++)
+      {
+      manyfrom += (pw0 + n)->manyfrom;
+      }
+    if ( ! manyfrom) break;
+    for (n = 0; n < manythread; n++)
+      {
+      (pw0 + n)->phase = 1; (pw0 + n)->level = level;
+      }
+    if ((rc = parallel(manythread, searches, pw0, sizeof(struct anabfs)))) break;
+    for (n = 0; n < manythread; n++) { if ((pw0 + n)->rc) rc = (pw0 + n)->rc; }
+    if (rc) break;
+    for (n = 0; n < manythread; n++) { (pw0 + n)->phase = 2; }
+    if ((rc = parallel(manythread, searches, pw0, sizeof(struct anabfs)))) break;
+    }
+  }
+sumdist = 0.; sumpair = 0.;
+for (n = 0; n < manythread; n++)
+  {
+  sumdist += (pw0 + n)->sumdist; sumpair += (pw0 + n)->sumpair;
+  free((pw0 + n)->pfrom); free((pw0 + n)->pto);
+  }
+free(pw0); free(pseen); free(pfront); free(pnext);
+if (rc) { fprintf(stderr, "ERROR: memory request refused\n"); return rc; }
+pana->manysource = manysource;
+pana->length = (0. < sumpair) ? sumdist / sumpair : 0.;
+pana->reach  = (0 < manysource) ? \
+           sumpair / ((double)manysource * (double)(manynode - 1)) : 0.;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Write the results of anaclustering() and anapathlength().
+@param   pf          The output file, usually that of the degree distribution.
+@param   manynode    The number of nodes.
+@param   halfdegree  Half the degree of nodes in the first-stage ring, to give
+                     the values for the ring itself for comparison.
+@param   pana        The results.
+*//***************************************************************************/
+void
+ anareport(FILE *pf, int manynode, int halfdegree, const struct analytics *pana)
+{
+double c0, l0;
+
+c0 = (1 < halfdegree) ? \
+    (3. * (halfdegree - 1)) / (2. * ((2 * halfdegree) - 1)) : 0.;
+l0 = ((double)manynode) / (4. * halfdegree);
+fprintf(pf, "\n  Clustering coefficient  C = %8.6f   (ring: %8.6f)\n", \
+                                                        pana->clustering, c0);
+fprintf(pf, "  Transitivity              = %8.6f\n", pana->transitivity);
+if (pana->manysource)
+  {
+  fprintf(pf, "  Characteristic path   L = %10.4f (ring: about %.1f)\n", \
+                                                           pana->length, l0);
+  fprintf(pf, "  from %i sources, reaching %8.6f of nodes\n", \
+                                             pana->manysource, pana->reach);
+  }
+}
+/* ***************************************************************************/
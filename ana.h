@@ -0,0 +1,49 @@
+/* ************************************************************//** @file ana.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the network analytics functions.
+*//* *************************************************************************/
+
+#ifndef NETWORK_ANALYTICS_H
+#define NETWORK_ANALYTICS_H
+
+#include <stdio.h>
+#include "swn.h"
+
+/** Results of anaclustering() and anapathlength() */
+struct analytics
+  {
+  double   clustering;   /**< Mean over nodes of the local clustering
+                              coefficient: C of Ref.[1] of swn.c          */
+  double   transitivity; /**< Three times triangles over connected triples */
+  double   length;       /**< Mean shortest path over reachable pairs: L  */
+  double   reach;        /**< Fraction of pairs from the sources that are
+                              connected                                    */
+  int      manysource;   /**< Number of sources from which L was estimated */
+  };
+
+int  anaclustering(int, struct node *, int, struct analytics *);
+int  anapathlength(int, struct node *, int, unsigned int, int, \
+                                                          struct analytics *);
+void anareport(FILE *, int, int, const struct analytics *);
+
+#endif /*NETWORK_ANALYTICS_H*/
@@ -29,99 +29,1074 @@ _______________________________________________________________________________
 #include <errno.h>
 #include <math.h>
 #include <assert.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "swn.h"
+#include "net.h"
+#include "ana.h"
+#include "epi.h"
+#include "prf.h"
+#include "ens.h"
+#include "par.h"
+#include "srv.h"
+#include "shd.h"
+#include "hyb.h"
+#include "lay.h"
+
+#define COV_MANYDAY (365)     /**< Days for which each epidemic is run       */
+#define COV_MANYREPLICATE (1000) /**< Replicates at most under -e, unless -r  */
+#define COV_BATCH (16)        /**< Fewest replicates run between tests of -e */
+#define COV_MANYNET (8)       /**< Networks the server keeps, unless -C      */
+#define COV_MANYWORD (64)     /**< Most words in a request to the server     */
+#define COV_MANYLAYER (8)     /**< Most layers of contacts given by -l       */
 
 /** Help message in response to command-line input mistakes */
 #define USAGE do { \
    fprintf(stderr, \
-   "USAGE: ./cov  seedcov  seedswn  manynode  halfdegree  beta\n" \
+   "USAGE: ./cov  [-g network]  [-w image]  [-p]  [-j threads]\n" \
+   "              [-d report]  [-a sources]  [-t trace]  [-H]  [-f]\n" \
+   "              [-r replicates]  [-e width[,day]]  [-c]  [-n label]\n" \
+   "              [-s shards  [-N]]  [-m up[,down]  [-k]]  [-l layer]...\n" \
+   "              seedcov  seedswn  manynode  halfdegree  beta\n" \
    "              chance  inert  incubating  recovery  [output_directory]\n" \
-   "       where  0  <  halfdegree,\n" \
+   "   or: ./cov  -S socket  [-j workers]  [-C networks]\n" \
+   "       where  -g  reads the network from an edge list or image file\n" \
+   "                  instead of calling swn(); manynode is then taken\n" \
+   "                  from the file, and seedswn and beta serve only to\n" \
+   "                  name the output,\n" \
+   "              -w  writes the network to an image file for use with -g,\n" \
+   "              -p  constructs the network with swnpar() rather than\n" \
+   "                  swn(), on the number of threads given by -j,\n" \
+   "              -d  writes the degree distribution of each network to\n" \
+   "                  the file report, or to stdout if report is -,\n" \
+   "              -a  writes the clustering coefficient and, unless\n" \
+   "                  sources is 0, the path length estimated from that\n" \
+   "                  many sources, computed on -j threads, to the file\n" \
+   "                  given by -d, or else to stdout,\n" \
+   "              -t  times each phase of the run, writing one line per\n" \
+   "                  day and then a summary to the file trace,\n" \
+   "              -H  adds hardware counters to the timings, where the\n" \
+   "                  system allows them; without -t, the summary alone\n" \
+   "                  is written, to stderr; neither -t nor -H may be\n" \
+   "                  used with -r or -e,\n" \
+   "              -r  runs that many epidemics on each network, on -j\n" \
+   "                  threads, writing the mean, standard deviation and\n" \
+   "                  quantiles of each day to a single file,\n" \
+   "              -e  stops the replicates, -r of them at most (default\n" \
+   "                  1000), once the 95%% confidence interval on the\n" \
+   "                  infected fraction on day (default the last) is no\n" \
+   "                  wider than width,\n" \
+   "              -c  draws common random numbers, so that runs differing\n" \
+   "                  only in chance or inert are coupled,\n" \
+   "              -n  ends the name of each output file with -label,\n" \
+   "              -f  writes out each day of a run as soon as it is done,\n" \
+   "                  so that gracov -f can follow the run,\n" \
+   ); \
+   fprintf(stderr, \
+   "              -s  runs instead a synchronous model of the epidemic,\n" \
+   "                  in which every node is updated from the day\n" \
+   "                  before, with common random numbers, on that many\n" \
+   "                  processes, each building and owning a range of\n" \
+   "                  the nodes of a network much as -p would, and\n" \
+   "                  exchanging the states of its boundary with the\n" \
+   "                  others each day; its curve is the same for any\n" \
+   "                  number of shards, but not that of the run without\n" \
+   "                  -s, and no process holds the whole network,\n" \
+   "              -N  pins each shard to a CPU, spreading them over the\n" \
+   "                  NUMA nodes so that each allocates on its own, and\n" \
+   "                  reports to stderr where the memory of each lay\n" \
+   "                  and how many of its loads were remote,\n" \
+   "              -m  hands the epidemic to a pair approximation once\n" \
+   "                  the fraction up of the nodes are infected and not\n" \
+   "                  yet recovered, and back to the simulation once\n" \
+   "                  fewer than down (default up/10) are, unless the\n" \
+   "                  network is too clustered for it,\n" \
+   "              -k  runs each epidemic both with -m and without, on\n" \
+   "                  the same seeds, and reports their differences,\n" \
+   "              -l  adds a layer of contacts on the same nodes, each\n" \
+   "                  neighbour in it infecting at its own chance, as\n" \
+   "                  swn,halfdegree,beta,chance  or  clique,size,chance\n" \
+   "                  or  file,path,chance; up to 8 layers may be given,\n" \
+   "              -S  serves runs on the Unix domain socket, each asked\n" \
+   "                  for by a line of options and arguments as above,\n" \
+   "                  without output_directory, and written back to it,\n" \
+   "                  on a pool of -j workers, keeping the last networks\n" \
+   "                  built, as many as -C gives (default 8),\n" \
+   "              0  <  halfdegree,\n" \
    "              (1 + 2*halfdegree) <= manynode,\n" \
-   "              0. <= beta   <  1.,\n" \
+   "              0. <= beta   <  1.,  or  min:increment:max  for a series\n" \
+   "                  of coupled networks constructed by swncouple(),\n" \
    "              0. <= chance <= 1.,\n" \
    "              0. <= inert  <= 1.,\n" \
    "              0  <= incubating < recovery\n"); \
    } while(0)
 
-/** Information residing on a single node */
-struct status
-  {
-  struct node *pnode;   /**< Pointer to the connectivity information provided
-                                                    by the small-world model */
-  int   day;            /**< Count of days since infection                   */
-  int   inert;          /**< Flag set if this node is inert                  */
-  int   shuffle;        /**< Position of this node in the queue for updating */
+/** Phases of a run, to which -t attributes its cost */
+enum { COV_BUILD, COV_INIT, COV_SHUFFLE, COV_SWEEP, COV_COUNT, COV_OUTPUT, \
+                                                              COV_MANYPHASE };
+
+/** Names of the phases, in the order of the enumeration */
+static const char *const phasename[COV_MANYPHASE] =
+  {
+  "build", "init", "shuffle", "sweep", "count", "output"
+  };
+
+/** Costs of the phases of a run, for option -t */
+struct trace
+  {
+  FILE     *pf;                      /**< Per-day trace, or NULL             */
+  struct prf prf;                    /**< Hardware counters, maybe none      */
+  double    was;                     /**< Clock at the end of the last phase */
+  uint64_t  hwwas[PRF_MANY];         /**< Counters at the same moment        */
+  double    sec[COV_MANYPHASE];      /**< Seconds in each phase, this run    */
+  uint64_t  hw[COV_MANYPHASE][PRF_MANY]; /**< Counts in each phase, this run */
+  double    daysec[COV_MANYPHASE];   /**< Seconds in each phase, this day    */
+  uint64_t  dayhw[PRF_MANY];         /**< Counts on this day                 */
+  };
+
+/* ************************************************************************//**
+@brief  Charge the time (and hardware counts) since the last call to a phase.
+@param  ptr     The trace, or NULL if the run is not being timed.
+@param  phase   The phase, or  -1  to discard the cost.
+*//* *************************************************************************/
+static void
+ lap(struct trace *ptr, int phase)
+{
+uint64_t hw[PRF_MANY];
+double t;
+int n;
+
+if (NULL == ptr) return;
+t = prfnow();
+prfread(&ptr->prf, hw);
+if (0 <= phase)
+  {
+  ptr->sec[phase] += t - ptr->was;
+  ptr->daysec[phase] += t - ptr->was;
+  for (n = 0; n < PRF_MANY; n++)
+    {
+    ptr->hw[phase][n] += hw[n] - ptr->hwwas[n];
+    ptr->dayhw[n] += hw[n] - ptr->hwwas[n];
+    }
+  }
+ptr->was = t;
+memcpy(ptr->hwwas, hw, sizeof(hw));
+}
+/* ************************************************************************//**
+@brief  Write one line of the per-day trace, and start the next day.
+*//* *************************************************************************/
+static void
+ traceday(struct trace *ptr, const struct epidemic *pepi, long drawwas, \
+                                              long visitwas, long newwas)
+{
+int n;
+
+if ((NULL == ptr) || (NULL == ptr->pf)) return;
+fprintf(ptr->pf, "%3i", pepi->day);
+for (n = COV_SHUFFLE; n < COV_MANYPHASE; n++)
+  {
+  fprintf(ptr->pf, " %10.6f", ptr->daysec[n]);
+  }
+fprintf(ptr->pf, " %11li %11li %9li", pepi->manydraw - drawwas, \
+                       pepi->manyvisit - visitwas, pepi->manynew - newwas);
+for (n = 0; n < ptr->prf.many; n++)
+  {
+  fprintf(ptr->pf, " %14llu", (unsigned long long)ptr->dayhw[n]);
+  }
+fprintf(ptr->pf, "\n");
+memset(ptr->daysec, 0, sizeof(ptr->daysec));
+memset(ptr->dayhw, 0, sizeof(ptr->dayhw));
+}
+/* ************************************************************************//**
+@brief  Summarise the costs of a run, at the end of its trace if there is a
+        trace file or else on stderr, then clear them for the next run.
+*//* *************************************************************************/
+static void
+ tracesummary(struct trace *ptr, const struct epidemic *pepi, double dbeta)
+{
+FILE *pf;
+const char *pmark;
+double total;
+int n, m;
+
+if (NULL == ptr) return;
+if (ptr->pf) { pf = ptr->pf; pmark = "#"; } else { pf = stderr; pmark = ""; }
+for (n = 0, total = 0.; n < COV_MANYPHASE; n++) { total += ptr->sec[n]; }
+fprintf(pf, "%s\n%s  beta = %5.3f:  %i nodes, %i days, %.3f seconds\n", \
+                      pmark, pmark, dbeta, pepi->manynode, pepi->day, total);
+fprintf(pf, "%s  Phase       Seconds   Share  ns/node-day", pmark);
+for (m = 0; m < ptr->prf.many; m++) fprintf(pf, " %14s", prfname[m]);
+fprintf(pf, "\n");
+for (n = 0; n < COV_MANYPHASE; n++)
+  {
+  fprintf(pf, "%s  %-8s %10.4f  %5.1f%%", pmark, phasename[n], ptr->sec[n], \
+                               (0. < total) ? 100. * ptr->sec[n] / total : 0.);
+  if ((COV_SHUFFLE <= n) && pepi->day)
+    {
+    fprintf(pf, " %12.2f", 1.e9 * ptr->sec[n] / \
+                           ((double)pepi->manynode * (double)pepi->day));
+    }
+  else fprintf(pf, " %12s", "");
+  for (m = 0; m < ptr->prf.many; m++)
+    {
+    fprintf(pf, " %14llu", (unsigned long long)ptr->hw[n][m]);
+    }
+  fprintf(pf, "\n");
+  }
+fprintf(pf, "%s  %li random numbers, %li neighbour visits, %li infections\n", \
+                  pmark, pepi->manydraw, pepi->manyvisit, pepi->manynew);
+if (ptr->pf)
+  {
+  fprintf(pf, "# seconds");
+  for (n = 0; n < COV_MANYPHASE; n++)
+    {
+    fprintf(pf, " %s %.6f", phasename[n], ptr->sec[n]);
+    }
+  fprintf(pf, "\n");
+  }
+memset(ptr->sec, 0, sizeof(ptr->sec));
+memset(ptr->hw, 0, sizeof(ptr->hw));
+}
+/* ************************************************************************//**
+@brief  Warn that the network is too clustered for the approximation of -m,
+        which is then not used.
+*//* *************************************************************************/
+static void
+ declined(const struct hybrid *ph)
+{
+fprintf(stderr, "WORRY: clustering coefficient %.3f is above %.2f, where" \
+        " the approximation of -m errs: simulating throughout\n", \
+                                             ph->clustering, HYB_CLUSTERED);
+}
+/* ************************************************************************//**
+@brief  Run the epidemic on a network, writing one line per day to a file.
+@param  outfnm      The output file.
+@param  pfto        A stream to write to instead, or NULL.
+@param  pnode0      The base of the array of nodes.
+@param  manynode    The number of nodes.
+@param  halfdegree  Half the degree of nodes in the first-stage ring.
+@param  seedcov     Seed for the random numbers used by the epidemic.
+@param  chance      Probability of infection per neighbour per day, in 1024ths.
+@param  inert       Fraction of inert nodes, in 1024ths.
+@param  incubating  Days after infection that a node becomes infectious.
+@param  recovery    Days after infection that a node ceases to be infectious.
+@param  common      Non-zero for common random numbers (see epi.c).
+@param  flush       Non-zero to flush the output at the end of each day.
+@param  pnet        The network as hybmeasure() found it, if up is not zero.
+@param  up          Fraction of nodes infected at which the approximation of
+                    hyb.c takes over, or zero for simulation throughout.
+@param  down        Fraction at which the simulation resumes.
+@param  manylayer   The number of layers of contacts besides the network.
+@param  player      The layers, or NULL.
+@param  dbeta       The rewiring fraction, to label the trace.
+@param  ptrace      The trace of costs, or NULL.
+@return             Zero unless error.
+*//* *************************************************************************/
+static int
+ epidemic(const char *outfnm, FILE *pfto, struct node *pnode0, \
+                    int manynode, int halfdegree, unsigned int seedcov, \
+                         int chance, int inert, int incubating, int recovery, \
+                      int common, int flush, const struct hybnet *pnet, \
+                        double up, double down, int manylayer, \
+               const struct layer *player, double dbeta, struct trace *ptrace)
+{
+struct epidemic epi;
+struct hybrid hyb;
+FILE *pfout;
+long drawwas, visitwas, newwas;
+int n, rc;
+
+if (0 > (rc = epiinit(&epi, pnode0, manynode, halfdegree, seedcov, chance, \
+                                       inert, incubating, recovery, common)))
+  {
+  return rc;
+  }
+if (manylayer) epilayers(&epi, manylayer, player);
+if (0 > (rc = hybinit(&hyb, &epi, pnet, up, down, COV_MANYDAY)))
+  {
+  epifree(&epi); return rc;
+  }
+if (hyb.declined) declined(&hyb);
+lap(ptrace, COV_INIT);
+/*-----------------------------------------------------------------------------
+OPEN THE OUTPUT FILE
+-----------------------------------------------------------------------------*/
+if (pfto) pfout = pfto;
+else if (NULL == (pfout = fopen(outfnm, "w")))
+  {
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", outfnm);
+  hybfree(&hyb); epifree(&epi); return -16;
+  }
+fprintf(pfout, "Day Infected Uninfected Contacts\n");
+epiline(pfout, &epi);
+if (flush) fflush(pfout);
+if (ptrace && ptrace->pf)
+  {
+  fprintf(ptrace->pf, "# beta = %5.3f\nDay %10s %10s %10s %10s %11s %11s %9s", \
+      dbeta, "Shuffle", "Sweep", "Count", "Output", "Draws", "Visits", "Infected");
+  for (n = 0; n < ptrace->prf.many; n++)
+    {
+    fprintf(ptrace->pf, " %14s", prfname[n]);
+    }
+  fprintf(ptrace->pf, "\n");
+  }
+lap(ptrace, COV_OUTPUT);
+/*-----------------------------------------------------------------------------
+MAIN LOOP: SHUFFLE, UPDATE EVERY NODE, COUNT
+-----------------------------------------------------------------------------*/
+while (COV_MANYDAY > epi.day)
+  {
+  drawwas = epi.manydraw; visitwas = epi.manyvisit; newwas = epi.manynew;
+  if (0. < up) { hybday(&hyb, &epi); lap(ptrace, COV_SWEEP); }
+  else
+    {
+    epishuffle(&epi);       lap(ptrace, COV_SHUFFLE);
+    episweep(&epi);         lap(ptrace, COV_SWEEP);
+    epicount(&epi);         lap(ptrace, COV_COUNT);
+    }
+  epiline(pfout, &epi);
+  if (flush) fflush(pfout);
+  lap(ptrace, COV_OUTPUT);
+  traceday(ptrace, &epi, drawwas, visitwas, newwas);
+  }
+tracesummary(ptrace, &epi, dbeta);
+/*-----------------------------------------------------------------------------
+MAIN LOOP ENDS.  PRINT OUTPUT FILENAME ON  stdout.
+-----------------------------------------------------------------------------*/
+if ( ! pfto) fprintf(stdout,"-> %s\n", outfnm);
+/*----------------------------------------------------------------------------
+CLEAN UP
+-----------------------------------------------------------------------------*/
+if ( ! pfto) fclose(pfout);
+hybfree(&hyb);
+epifree(&epi);
+return 0;
+}
+/** Work of one thread of replicates() */
+struct repwork
+  {
+  struct node     *pnode0;       /**< The base of the array of nodes         */
+  int              manynode;     /**< The number of nodes                    */
+  int              halfdegree;   /**< Half the degree of the ring            */
+  unsigned int     seedcov;      /**< Seed of replicate zero                 */
+  int              chance;       /**< As for epidemic()                      */
+  int              inert;        /**< As for epidemic()                      */
+  int              incubating;   /**< As for epidemic()                      */
+  int              recovery;     /**< As for epidemic()                      */
+  int              common;       /**< As for epidemic()                      */
+  const struct hybnet *pnet;     /**< As for epidemic()                      */
+  double           up;           /**< As for epidemic()                      */
+  double           down;         /**< As for epidemic()                      */
+  int              manylayer;    /**< As for epidemic()                      */
+  const struct layer *player;    /**< As for epidemic()                      */
+  int              manyreplicate;/**< The number of replicates               */
+  int             *pnext;        /**< Next replicate to be claimed           */
+  struct ensemble  ens;          /**< This thread's replicates               */
+  int              rc;           /**< Zero unless error                      */
   };
 
-extern int swn(unsigned int,int,int,double,struct node **);
+/* ************************************************************************//**
+@brief  Run the replicates claimed by one thread, adding each day of each to
+        the thread's own ensemble.
+*//* *************************************************************************/
+static void *
+ replicate(void *pvoid)
+{
+struct repwork *pw;
+struct epidemic epi;
+struct hybrid hyb;
+unsigned int seed;
+int r;
+
+pw = (struct repwork *)pvoid;
+while (pw->manyreplicate > (r = __atomic_fetch_add(pw->pnext, 1, \
+                                                         __ATOMIC_RELAXED)))
+  {
+  seed = r ? (unsigned int)rngstream(pw->seedcov, r) : pw->seedcov;
+  if (0 > (pw->rc = epiinit(&epi, pw->pnode0, pw->manynode, pw->halfdegree, \
+                seed, pw->chance, pw->inert, pw->incubating, pw->recovery, \
+                                                             pw->common)))
+    {
+    return NULL;
+    }
+  if (pw->manylayer) epilayers(&epi, pw->manylayer, pw->player);
+  if (0 > (pw->rc = hybinit(&hyb, &epi, pw->pnet, pw->up, pw->down, \
+                                                            COV_MANYDAY)))
+    {
+    epifree(&epi); return NULL;
+    }
+  if ((0 == r) && hyb.declined) declined(&hyb);
+  ensadd(&pw->ens, 0, epi.manycase, epi.manyedge);
+  while (COV_MANYDAY > epi.day)
+    {
+    if (0. < pw->up) hybday(&hyb, &epi);
+    else
+      {
+      epishuffle(&epi);
+      episweep(&epi);
+      epicount(&epi);
+      }
+    ensadd(&pw->ens, epi.day, epi.manycase, epi.manyedge);
+    }
+  hybfree(&hyb);
+  epifree(&epi);
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief  Run many epidemics on one network, writing their statistics day by
+        day to one file.  Replicate zero uses seedcov itself, as a single run
+        would; replicate  r  uses a seed drawn from stream  r  of seedcov.
+
+Given a width, the replicates are run in rounds, after each of which the 95%
+confidence interval on the mean infected fraction on the given day is found
+from all the replicates so far.  They stop once it is no wider than width,
+or once manyreplicate have been run.  Each round is as long as the interval
+so far suggests is needed, but at least COV_BATCH replicates; as the rounds
+do not depend on the number of threads, neither does the output.
+@param  outfnm         The output file.
+@param  pfto           A stream to write to instead, or NULL.
+@param  manyreplicate  The number of replicates, or the most under width.
+@param  manythread     The number of threads.
+@param  width          The width wanted of the interval, or zero.
+@param  stopday        The day on which the interval is wanted.
+@return                Zero unless error.
+@note   The other parameters are those of epidemic().
+*//* *************************************************************************/
+static int
+ replicates(const char *outfnm, FILE *pfto, struct node *pnode0, \
+                    int manynode, int halfdegree, unsigned int seedcov, \
+            int chance, int inert, int incubating, int recovery, int common, \
+            const struct hybnet *pnet, double up, double down, int manylayer, \
+                       const struct layer *player, int manyreplicate, \
+                                  int manythread, double width, int stopday)
+{
+struct repwork *pw0;
+struct node **pp;
+FILE *pfout;
+double sd, wide;
+long manystub;
+int n, next, done, round, rc;
+
+if (manythread > manyreplicate) manythread = manyreplicate;
+if (NULL == (pw0 = (struct repwork *)calloc(manythread, sizeof(struct repwork))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 0, manystub = 0; n < manynode; n++)
+  {
+  for (pp = (pnode0 + n)->pp0; NULL != *pp; pp++) { manystub++; }
+  }
+for (n = 0; n < manylayer; n++) manystub += (player + n)->manystub;
+rc = 0; next = 0;
+for (n = 0; n < manythread; n++)
+  {
+  (pw0 + n)->pnode0 = pnode0; (pw0 + n)->manynode = manynode;
+  (pw0 + n)->halfdegree = halfdegree; (pw0 + n)->seedcov = seedcov;
+  (pw0 + n)->chance = chance; (pw0 + n)->inert = inert;
+  (pw0 + n)->incubating = incubating; (pw0 + n)->recovery = recovery;
+  (pw0 + n)->common = common; (pw0 + n)->pnet = pnet;
+  (pw0 + n)->up = up; (pw0 + n)->down = down;
+  (pw0 + n)->manylayer = manylayer; (pw0 + n)->player = player;
+  (pw0 + n)->manyreplicate = manyreplicate; (pw0 + n)->pnext = &next;
+  if (0 > (rc = ensinit(&(pw0 + n)->ens, COV_MANYDAY + 1, manynode, manystub))) break;
+  }
+/*-----------------------------------------------------------------------------
+RUN THE REPLICATES IN ROUNDS, UNTIL THE INTERVAL IS NARROW ENOUGH
+-----------------------------------------------------------------------------*/
+done = 0; wide = 0.;
+round = ((0. < width) && (COV_BATCH < manyreplicate)) ? COV_BATCH \
+                                                      : manyreplicate;
+while ( ! rc)
+  {
+  for (n = 0; n < manythread; n++)
+    {
+    (pw0 + n)->manyreplicate = done + round;
+    }
+  next = done;
+  rc = parallel(manythread, replicate, pw0, sizeof(struct repwork));
+  for (n = 1; n < manythread; n++)
+    {
+    if ((pw0 + n)->rc) rc = (pw0 + n)->rc;
+    ensmerge(&pw0->ens, &(pw0 + n)->ens);
+    ensclear(&(pw0 + n)->ens);
+    }
+  if (pw0->rc) rc = pw0->rc;
+  done += round;
+  if (done >= manyreplicate) break;
+  sd = enssd(&pw0->ens, stopday);
+  wide = 2. * 1.96 * sd / sqrt((double)done);
+  if (wide <= width) break;
+  round = (int)ceil(pow(2. * 1.96 * sd / width, 2.)) - done;
+  if (COV_BATCH > round) round = COV_BATCH;
+  if (manyreplicate - done < round) round = manyreplicate - done;
+  }
+if (( ! rc) && (0. < width) && (wide > width))
+  {
+  fprintf(stderr, "WORRY: %i replicates leave the interval %6.4f wide: %s\n", \
+                                                      done, wide, outfnm);
+  }
+/*-----------------------------------------------------------------------------
+WRITE THE STATISTICS OF ALL THE REPLICATES
+-----------------------------------------------------------------------------*/
+if (( ! rc) && pfto) enswrite(pfto, &pw0->ens);
+else if ( ! rc)
+  {
+  if (NULL == (pfout = fopen(outfnm, "w")))
+    {
+    fprintf(stderr, "ERROR: cannot open output file: %s\n", outfnm);
+    rc = -16;
+    }
+  else
+    {
+    enswrite(pfout, &pw0->ens);
+    fclose(pfout);
+    fprintf(stdout,"-> %s\n", outfnm);
+    }
+  }
+for (n = 0; n < manythread; n++) { ensfree(&(pw0 + n)->ens); }
+free(pw0);
+return rc;
+}
+/* ************************************************************************//**
+@brief  Estimate the error of the hybrid engine: run the epidemics of the
+        seeds replicates() would use, both hybrid and simulated throughout,
+        and report on stdout how far their infected fractions differ.
+@param  dbeta    The rewiring fraction, to label the report.
+@param  manyrun  The number of runs.
+@return          Zero unless error.
+@note   The other parameters are those of epidemic().
+*//* *************************************************************************/
+static int
+ check(struct node *pnode0, int manynode, int halfdegree, \
+            unsigned int seedcov, int chance, int inert, int incubating, \
+             int recovery, int common, const struct hybnet *pnet, double up, \
+                                      double down, double dbeta, int manyrun)
+{
+struct epidemic epi;
+struct hybrid hyb;
+double *pcurve, *pmean;
+double sec[2], final[2], finalsq, worst, most, t, sd;
+long manyode, manyswitch;
+unsigned int seed;
+int r, way, d, day, rc;
 
+if (NULL == (pcurve = (double *)calloc(4 * (COV_MANYDAY + 1), \
+                                                              sizeof(double))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+pmean = pcurve + 2 * (COV_MANYDAY + 1);
+sec[0] = 0.; sec[1] = 0.; final[0] = 0.; final[1] = 0.; finalsq = 0.;
+most = 0.; manyode = 0; manyswitch = 0; rc = 0;
+for (r = 0; (0 == rc) && (r < manyrun); r++)
+  {
+  seed = r ? (unsigned int)rngstream(seedcov, r) : seedcov;
+/*-----------------------------------------------------------------------------
+THE SAME EPIDEMIC HYBRID (WAY 0) AND SIMULATED THROUGHOUT (WAY 1)
+-----------------------------------------------------------------------------*/
+  for (way = 0; (0 == rc) && (2 > way); way++)
+    {
+    t = prfnow();
+    if (0 > (rc = epiinit(&epi, pnode0, manynode, halfdegree, seed, chance, \
+                                     inert, incubating, recovery, common))) \
+      {
+      break;
+      }
+    if (0 > (rc = hybinit(&hyb, &epi, pnet, way ? 0. : up, down, \
+                                                            COV_MANYDAY)))
+      {
+      epifree(&epi); break;
+      }
+    pcurve[way * (COV_MANYDAY + 1)] = (double)epi.manycase / manynode;
+    while (COV_MANYDAY > epi.day)
+      {
+      hybday(&hyb, &epi);
+      if (hyb.on) manyode++;
+      pcurve[way * (COV_MANYDAY + 1) + epi.day] = \
+                                              (double)epi.manycase / manynode;
+      }
+    manyswitch += hyb.manyswitch;
+    hybfree(&hyb); epifree(&epi);
+    sec[way] += prfnow() - t;
+    }
+  for (d = 0, worst = 0.; (0 == rc) && (d <= COV_MANYDAY); d++)
+    {
+    if (worst < fabs(pcurve[d] - pcurve[COV_MANYDAY + 1 + d]))
+      {
+      worst = fabs(pcurve[d] - pcurve[COV_MANYDAY + 1 + d]);
+      }
+    pmean[d] += pcurve[d] / manyrun;
+    pmean[COV_MANYDAY + 1 + d] += pcurve[COV_MANYDAY + 1 + d] / manyrun;
+    }
+  most += worst / manyrun;
+  final[0] += pcurve[COV_MANYDAY] / manyrun;
+  final[1] += pcurve[2 * COV_MANYDAY + 1] / manyrun;
+  finalsq += pcurve[2 * COV_MANYDAY + 1] * pcurve[2 * COV_MANYDAY + 1];
+  }
+/*-----------------------------------------------------------------------------
+REPORT
+-----------------------------------------------------------------------------*/
+if (0 == rc)
+  {
+  for (d = 0, day = 0, worst = 0.; d <= COV_MANYDAY; d++)
+    {
+    if (worst < fabs(pmean[d] - pmean[COV_MANYDAY + 1 + d]))
+      {
+      worst = fabs(pmean[d] - pmean[COV_MANYDAY + 1 + d]); day = d;
+      }
+    }
+  sd = (1 < manyrun) ? sqrt(fmax(0., (finalsq - manyrun * final[1] * \
+                        final[1]) / (manyrun - 1)) / manyrun) : 0.;
+  fprintf(stdout, "check of -m: %i run%s at beta = %5.3f, hybrid against " \
+                  "simulation throughout\n", manyrun, \
+                                          (1 < manyrun) ? "s" : "", dbeta);
+  fprintf(stdout, "  mean infected differs most on day %3i:  %6.4f " \
+          "against %6.4f\n", day, pmean[day], pmean[COV_MANYDAY + 1 + day]);
+  fprintf(stdout, "  final size %6.4f against %6.4f (standard error " \
+                             "%6.4f)\n", final[0], final[1], sd);
+  fprintf(stdout, "  greatest difference within a run, mean over runs:  " \
+                                                          "%6.4f\n", most);
+  fprintf(stdout, "  approximation ran %5.1f days a run, taking over %4.2f " \
+               "times;  %.3f s against %.3f s\n", (double)manyode / manyrun, \
+                        (double)manyswitch / manyrun, sec[0], sec[1]);
+  }
+free(pcurve);
+return rc;
+}
+/* ************************************************************************//**
+@brief  Parse the value of -m:  up[,down], fractions of the nodes infected
+        and not yet recovered, down being up/10 unless given.
+@return Zero unless it is malformed.
+*//* *************************************************************************/
+static int
+ hybridspec(const char *pspec, double *pup, double *pdown)
+{
+char *pend;
+
+errno = 0;
+*pup = strtod(pspec, &pend);
+*pdown = 0.1 * *pup;
+if (',' == *pend) *pdown = strtod(pend + 1, &pend);
+return (errno || *pend || (0. >= *pup) || (1. < *pup) || (0. > *pdown) || \
+                                                    (*pdown >= *pup)) ? -1 : 0;
+}
+/** The parameters of a run given by the positional arguments of cov */
+struct run
+  {
+  unsigned int  seedcov;      /**< Seed of the epidemic                      */
+  unsigned int  seedswn;      /**< Seed of the network                       */
+  int           manynode;     /**< Nodes                                     */
+  int           halfdegree;   /**< Half the degree of the ring               */
+  int           coupled;      /**< Non-zero for a series of beta             */
+  double        dbetamin;     /**< The rewiring fraction, or the first       */
+  double        dbetastep;    /**< Its increment, for a series               */
+  double        dbetamax;     /**< The last, for a series                    */
+  double        dchance;      /**< Chance of infection per neighbour per day */
+  double        dinert;       /**< Fraction of inert nodes                   */
+  int           chance;       /**< The same, in 1024ths                      */
+  int           inert;        /**< The same, in 1024ths                      */
+  int           incubating;   /**< Days after infection before infectious    */
+  int           recovery;     /**< Days after infection before recovered     */
+  };
+
+/* ************************************************************************//**
+@brief  Parse the nine positional arguments of cov, from seedcov to recovery.
+@param  argv    The arguments.
+@param  graph   Non-zero if the network is read from a file (-g).
+@param  prun    Set to the parameters.
+@param  pmess   Set to what is wrong, if anything.
+@param  room    Room at pmess.
+@return         Zero unless error.
+*//* *************************************************************************/
+static int
+ arguments(char *const *argv, int graph, struct run *prun, char *pmess, \
+                                                                 size_t room)
+{
+char *p1;
+
+#define BAD(...) do { snprintf(pmess, room, __VA_ARGS__); return -1; } while(0)
+errno = 0; prun->seedcov = (int)strtol(argv[0], NULL, 16);
+if (errno) BAD("bad seedcov");
+errno = 0; prun->seedswn = (int)strtol(argv[1], NULL, 16);
+if (errno) BAD("bad seedswn");
+errno = 0; prun->manynode = (int)strtol(argv[2], NULL, 10);
+if (errno) BAD("bad manynode");
+if (( ! prun->manynode) && ( ! graph)) BAD("no nodes");
+errno = 0; prun->halfdegree = (int)strtol(argv[3], NULL, 10);
+if (errno) BAD("bad halfdegree");
+if (( ! graph) && (prun->manynode < (2 * prun->halfdegree)))
+  {
+  BAD("too few nodes: must exceed %i", 2 * prun->halfdegree);
+  }
+prun->coupled = (NULL != strchr(argv[4], ':'));
+errno = 0; prun->dbetamin = strtod(argv[4], &p1);
+prun->dbetastep = 0.; prun->dbetamax = prun->dbetamin;
+if (prun->coupled && ( ! errno) && (':' == *p1))
+  {
+  prun->dbetastep = strtod(p1 + 1, &p1);
+  if (( ! errno) && (':' == *p1)) prun->dbetamax = strtod(p1 + 1, &p1);
+  else errno = EINVAL;
+  if (0. > prun->dbetastep) errno = EINVAL;
+  if (0.0000001 > fabs(prun->dbetastep)) prun->dbetastep = 1.e8;
+  if (( ! errno) && ((0. > prun->dbetamin) || (1. <= prun->dbetamax) || \
+                           (prun->dbetamin > prun->dbetamax))) errno = EINVAL;
+  }
+if (errno) BAD("bad beta");
+errno = 0; prun->dchance = strtod(argv[5], NULL);
+if (errno) BAD("bad chance");
+prun->chance = (int)(nearbyint(1024. * prun->dchance));
+if ((0 > prun->chance) || (1024 < prun->chance)) BAD("chance out of range");
+errno = 0; prun->dinert = strtod(argv[6], NULL);
+if (errno) BAD("bad inert");
+prun->inert = (int)(nearbyint(1024. * prun->dinert));
+errno = 0; prun->incubating = (int)strtol(argv[7], NULL, 10);
+if (errno) BAD("bad incubating");
+errno = 0; prun->recovery  = (int)strtol(argv[8], NULL, 10);
+if (errno) BAD("bad recovery");
+if (prun->incubating >= prun->recovery)
+  {
+  BAD("incubating must precede recovery");
+  }
+#undef BAD
+return 0;
+}
+/* ************************************************************************//**
+@brief  Serve a request to the server of -S: a line of options and arguments
+        as on the command line of cov, but without output_directory.  The
+        output the run would write to its file is written back instead, or
+        else a line beginning ERROR: which says why not.
+@param  ps        The server, and its cache of networks.
+@param  pf        The stream back to the client.
+@param  prequest  The request.
+@return           Zero unless error.
+@note   Of the options only -g, -p, -j, -r, -e, -c and -f are served, and a
+        series of beta is not; -j gives the threads of swnpar() and of the
+        replicates of this one request.
+*//* *************************************************************************/
+static int
+ serve(struct srv *ps, FILE *pf, char *prequest)
+{
+char line[SRV_MANYREQUEST], mess[128];
+char *parg[COV_MANYWORD], *p1, *pend;
+const char *pgraph;
+struct srvkey key;
+struct stat st;
+struct run run;
+struct node *pnode0;
+struct hybnet shape;
+int manyarg, k, slab, common, flush, manythread, manyreplicate, stopday;
+int manynode, m, rc;
+double width, up, down;
+
+strncpy(line, prequest, sizeof(line) - 1); line[sizeof(line) - 1] = 0;
+p1 = strtok_r(line, " \t", &pend);
+for (manyarg = 0; p1; p1 = strtok_r(NULL, " \t", &pend))
+  {
+  if (COV_MANYWORD <= manyarg)
+    {
+    fprintf(pf, "ERROR: more than %i words\n", COV_MANYWORD); return -1;
+    }
+  parg[manyarg++] = p1;
+  }
+/*-----------------------------------------------------------------------------
+THE OPTIONS SERVED, ONE TO A WORD, THEN THE NINE ARGUMENTS
+-----------------------------------------------------------------------------*/
+pgraph = NULL; slab = 0; common = 0; flush = 0; manythread = 1;
+manyreplicate = 0; width = 0.; stopday = COV_MANYDAY; up = 0.; down = 0.;
+for (k = 0; (k < manyarg) && ('-' == parg[k][0]) && \
+                                     isalpha((unsigned char)parg[k][1]); k++)
+  {
+  m = parg[k][1];
+  if (parg[k][2] || ! strchr("gpjrecfm", m))
+    {
+    fprintf(pf, "ERROR: option not served: %s\n", parg[k]); return -1;
+    }
+  if (strchr("gjrem", m) && (++k >= manyarg))
+    {
+    fprintf(pf, "ERROR: option -%c wants a value\n", m); return -1;
+    }
+  errno = 0;
+  switch (m)
+    {
+    case 'p': slab = 1; break;
+    case 'c': common = 1; break;
+    case 'f': flush = 1; break;
+    case 'g': pgraph = parg[k]; slab = 1; break;
+    case 'j':
+      manythread = (int)strtol(parg[k], &p1, 10);
+      if (errno || *p1 || (1 > manythread))
+        {
+        fprintf(pf, "ERROR: bad thread count\n"); return -1;
+        }
+      break;
+    case 'r':
+      manyreplicate = (int)strtol(parg[k], &p1, 10);
+      if (errno || *p1 || (1 > manyreplicate))
+        {
+        fprintf(pf, "ERROR: bad number of replicates\n"); return -1;
+        }
+      break;
+    case 'e':
+      width = strtod(parg[k], &p1);
+      if (',' == *p1) stopday = (int)strtol(p1 + 1, &p1, 10);
+      if (errno || *p1 || (0. >= width) || (0 > stopday) || \
+                                                     (COV_MANYDAY < stopday))
+        {
+        fprintf(pf, "ERROR: bad width of interval\n"); return -1;
+        }
+      break;
+    case 'm':
+      if (hybridspec(parg[k], &up, &down))
+        {
+        fprintf(pf, "ERROR: bad fractions for the hybrid engine\n");
+        return -1;
+        }
+      break;
+    }
+  }
+if (9 != manyarg - k)
+  {
+  fprintf(pf, "ERROR: expected 9 arguments, got %i\n", manyarg - k);
+  return -1;
+  }
+if (arguments(parg + k, NULL != pgraph, &run, &mess[0], sizeof(mess)))
+  {
+  fprintf(pf, "ERROR: %s\n", &mess[0]); return -1;
+  }
+if (run.coupled)
+  {
+  fprintf(pf, "ERROR: a series of beta is not served\n"); return -1;
+  }
+if ((0. < width) && ( ! manyreplicate)) manyreplicate = COV_MANYREPLICATE;
+/*-----------------------------------------------------------------------------
+THE NETWORK, FROM THE CACHE IF IT IS THERE
+-----------------------------------------------------------------------------*/
+memset(&key, 0, sizeof(key));
+key.manynode = run.manynode; key.halfdegree = run.halfdegree;
+if (pgraph)
+  {
+  if (stat(pgraph, &st) || (sizeof(key.path) <= strlen(pgraph)))
+    {
+    fprintf(pf, "ERROR: cannot read network: %s\n", pgraph); return -16;
+    }
+  key.kind = SRV_FILE; strcpy(key.path, pgraph);
+  key.mtime = (long)st.st_mtime; key.size = (long)st.st_size;
+  key.manynode = 0; key.halfdegree = 0;
+  }
+else
+  {
+  key.kind = slab ? SRV_SWNPAR : SRV_SWN; key.seed = run.seedswn;
+  key.beta = (int)nearbyint(1024. * run.dbetamin);
+  }
+if (0 > (rc = srvnetwork(ps, &key, manythread, &pnode0, &manynode, \
+                                                                 &shape)))
+  {
+  fprintf(pf, "ERROR: failed to construct the network, retcode %i\n", rc);
+  return rc;
+  }
+if (manyreplicate) rc = replicates(prequest, pf, pnode0, manynode, \
+                      run.halfdegree, run.seedcov, run.chance, run.inert, \
+                  run.incubating, run.recovery, common, &shape, up, down, 0, \
+                          NULL, manyreplicate, manythread, width, stopday);
+else rc = epidemic(prequest, pf, pnode0, manynode, run.halfdegree, \
+                  run.seedcov, run.chance, run.inert, run.incubating, \
+                 run.recovery, common, flush, &shape, up, down, 0, NULL, \
+                                                       run.dbetamin, NULL);
+srvrelease(ps, pnode0);
+if (0 > rc) fprintf(pf, "ERROR: run failed, retcode %i\n", rc);
+return rc;
+}
 /* ************************************************************************//**
 @brief  Run the epidemic.
-        USAGE: ./cov  seedcov  seedswn  manynode  halfdegree  beta \
+        USAGE: ./cov  [-g network] [-w image] [-p] [-j threads] \
+                      [-d report] [-a sources] \
+                      seedcov  seedswn  manynode  halfdegree  beta \
                       chance  inert  incubating  recovery [output_directory]
 *//* *************************************************************************/
 int
  main(int argc, char *argv[])
 {
-FILE *pfout;
 char outfnm[2048];
-char outdir[1024], *p1;
-struct node **pp;
-struct status *pother;
+char outdir[1024], mess[128], *p1;
+struct run run;
+char *pgraph, *pimage, *preport;
+struct analytics ana;
+struct hybnet shape;
+struct trace trace, *ptrace;
+char *ptracefnm, *plabel, *psocket;
+FILE *pfreport, *pfout;
 double dbeta, dchance, dinert;
-unsigned int seed, seedcov, seedswn;
+double dbetamin, dbetastep, dbetamax, dbetawas;
+double width, up, down;
+char *pend;
+unsigned int seedcov, seedswn;
 int manynode, halfdegree;
-int manycase, manycasewas;
-int manyedge;
+int manythread, slab, coupled;
+int manysource, manyreplicate, stopday, common;
 int chance, inert;
 int incubating, recovery;
-struct status *pstatus0;
 struct node *pnode0;
-int i, j, m, tick, day;
+struct layer layer[COV_MANYLAYER];
+int m, n, kbeta, flush, manynet, manyshard, numa, checked, manylayer;
 int rc;
 
 rc = 0;
 /*-----------------------------------------------------------------------------
-PARSE THE COMMAND LINE
+PARSE THE COMMAND LINE: FIRST THE OPTIONS, THEN THE POSITIONAL ARGUMENTS
 -----------------------------------------------------------------------------*/
+pgraph = NULL; pimage = NULL; preport = NULL;
+manythread = 1; slab = 0; manysource = -1;
+ptracefnm = NULL; ptrace = NULL; memset(&trace, 0, sizeof(trace));
+manyreplicate = 0; width = 0.; stopday = COV_MANYDAY; common = 0;
+plabel = NULL; flush = 0; psocket = NULL; manynet = 0; manyshard = 0;
+numa = 0; up = 0.; down = 0.; checked = 0; manylayer = 0;
+while (-1 != (m = getopt(argc, argv, "+g:w:pj:d:a:t:Hr:e:cn:fs:Nm:kl:S:C:")))
+  {
+  switch (m)
+    {
+    case 'g': pgraph = optarg; slab = 1; break;
+    case 'w': pimage = optarg; break;
+    case 'd': preport = optarg; break;
+    case 't': ptracefnm = optarg; ptrace = &trace; break;
+    case 'H':
+      ptrace = &trace;
+      if ( ! prfopen(&trace.prf))
+        {
+        fprintf(stderr, "WORRY: hardware counters are not available\n");
+        }
+      break;
+    case 'p': slab = 1; break;
+    case 'c': common = 1; break;
+    case 'f': flush = 1; break;
+    case 'n': plabel = optarg; break;
+    case 'N': numa = 1; break;
+    case 'k': checked = 1; break;
+    case 'm':
+      if (hybridspec(optarg, &up, &down))
+        {
+        fprintf(stderr, "ERROR: bad fractions for the hybrid engine\n");
+        USAGE; return -1;
+        }
+      break;
+    case 'l':
+      if ((COV_MANYLAYER <= manylayer) || \
+                                   layparse(optarg, &layer[manylayer]))
+        {
+        fprintf(stderr, "ERROR: bad layer, or too many: %s\n", optarg);
+        USAGE; return -1;
+        }
+      manylayer++;
+      break;
+    case 'S': psocket = optarg; break;
+    case 'C':
+      errno = 0; manynet = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manynet))
+        {
+        fprintf(stderr, "ERROR: bad number of networks\n"); USAGE; return -1;
+        }
+      break;
+    case 's':
+      errno = 0; manyshard = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manyshard))
+        {
+        fprintf(stderr, "ERROR: bad number of shards\n"); USAGE; return -1;
+        }
+      break;
+    case 'r':
+      errno = 0; manyreplicate = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manyreplicate))
+        {
+        fprintf(stderr, "ERROR: bad number of replicates\n"); USAGE; return -1;
+        }
+      break;
+    case 'e':
+      errno = 0; width = strtod(optarg, &pend);
+      if (',' == *pend) stopday = (int)strtol(pend + 1, &pend, 10);
+      if (errno || *pend || (0. >= width) || (0 > stopday) || \
+                                                     (COV_MANYDAY < stopday))
+        {
+        fprintf(stderr, "ERROR: bad width of interval\n"); USAGE; return -1;
+        }
+      break;
+    case 'j':
+      errno = 0; manythread = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manythread))
+        {
+        fprintf(stderr, "ERROR: bad thread count\n"); USAGE; return -1;
+        }
+      break;
+    case 'a':
+      errno = 0; manysource = (int)strtol(optarg, NULL, 10);
+      if (errno || (0 > manysource))
+        {
+        fprintf(stderr, "ERROR: bad number of sources\n"); USAGE; return -1;
+        }
+      break;
+    default : USAGE; return -1;
+    }
+  }
+argc -= optind - 1; argv += optind - 1;
+if (psocket || manynet)
+  {
+  if ( ! psocket || (1 != argc))
+    {
+    fprintf(stderr, "ERROR: -S takes no arguments, and -C only with -S\n");
+    USAGE; return -1;
+    }
+  return srvrun(psocket, manythread, manynet ? manynet : COV_MANYNET, serve);
+  }
 if ((10 > argc) || (11 < argc))
   {
   fprintf(stderr, "ERROR: expected 9 or 10 argments, got %i:\n", argc-1);
   for (m = 1; m < argc; m++) { fprintf(stderr, "      >%s<\n", argv[m]); }
   USAGE; return -1;
   }
-errno = 0; seedcov = (int)strtol(argv[1], NULL, 16);
-if (errno) { fprintf(stderr, "ERROR: bad seedcov\n"); USAGE; return -1; }
-errno = 0; seedswn = (int)strtol(argv[2], NULL, 16);
-if (errno) { fprintf(stderr, "ERROR: bad seedswn\n"); USAGE; return -1; }
-errno = 0; manynode = (int)strtol(argv[3], NULL, 10);
-if (errno) { fprintf(stderr, "ERROR: bad manynode\n"); USAGE; return -1; }
-if ( ! manynode) { fprintf(stderr, "ERROR: no nodes\n"); USAGE; return -1; }
-errno = 0; halfdegree = (int)strtol(argv[4], NULL, 10);
-if (errno) { fprintf(stderr, "ERROR: bad halfdegree\n"); USAGE; return -1; }
-if (manynode < (2 * halfdegree))
-  {
-  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
-                                            2 * halfdegree); USAGE; return -1;
-  }
-errno = 0; dbeta = strtod(argv[5], NULL);
-if (errno) { fprintf(stderr, "ERROR: bad beta\n"); USAGE; return -1; }
-errno = 0; dchance = strtod(argv[6], NULL);
-if (errno) { fprintf(stderr, "ERROR: bad chance\n"); USAGE; return -1; }
-chance = (int)(nearbyint(1024. * dchance)); 
-if ((0 > chance) || (1024 < chance)) \
-         { fprintf(stderr, "ERROR: chance out of range\n"); USAGE; return -1; }
-errno = 0; dinert = strtod(argv[7], NULL);
-if (errno) { fprintf(stderr, "ERROR: bad inert\n"); USAGE; return -1; }
-inert = (int)(nearbyint(1024. * dinert)); 
-errno = 0; incubating = (int)strtol(argv[8], NULL, 10);
-if (errno) { fprintf(stderr, "ERROR: bad incubating\n"); USAGE; return -1; }
-errno = 0; recovery  = (int)strtol(argv[9], NULL, 10);
-if (errno) { fprintf(stderr, "ERROR: bad recovery\n"); USAGE; return -1; }
-if (incubating >= recovery)
-  {
-  fprintf(stderr, "ERROR: incubating must precede recovery\n");
+if (arguments(argv + 1, NULL != pgraph, &run, &mess[0], sizeof(mess)))
+  {
+  fprintf(stderr, "ERROR: %s\n", &mess[0]); USAGE; return -1;
+  }
+seedcov = run.seedcov; seedswn = run.seedswn;
+manynode = run.manynode; halfdegree = run.halfdegree; coupled = run.coupled;
+dbetamin = run.dbetamin; dbetastep = run.dbetastep; dbetamax = run.dbetamax;
+dchance = run.dchance; chance = run.chance;
+dinert = run.dinert; inert = run.inert;
+incubating = run.incubating; recovery = run.recovery;
+if (numa && ! manyshard)
+  {
+  fprintf(stderr, "ERROR: -N needs -s\n"); USAGE; return -1;
+  }
+if ((checked && (0. >= up)) || ((0. < up) && manyshard))
+  {
+  fprintf(stderr, "ERROR: -k needs -m, which cannot be used with -s\n");
+  USAGE; return -1;
+  }
+if (manylayer && (manyshard || (0. < up)))
+  {
+  fprintf(stderr, "ERROR: -l cannot be used with -s or -m\n");
+  USAGE; return -1;
+  }
+if (manyshard && (manyreplicate || (0. < width) || ptrace))
+  {
+  fprintf(stderr, "ERROR: -s cannot be used with -r, -e, -t or -H\n");
+  USAGE; return -1;
+  }
+if (ptrace && (manyreplicate || (0. < width)))
+  {
+  fprintf(stderr, "ERROR: -t and -H cannot be used with -r or -e\n");
+  USAGE; return -1;
+  }
+if (manyshard && (pgraph || pimage || slab || preport || (0 <= manysource) \
+                                                                  || coupled))
+  {
+  fprintf(stderr, "ERROR: -s builds the network in the shards, so cannot be" \
+                  " used with -g, -w, -p, -d, -a or a series of beta\n");
+  USAGE; return -1;
+  }
+if (coupled && (slab || pimage))
+  {
+  fprintf(stderr, "ERROR: a series of beta cannot be used with -g, -p or -w\n");
   USAGE; return -1;
   }
 if (11 == argc)
@@ -131,158 +1106,166 @@ if (11 == argc)
   if (outdir < p1) { p1--; if ('/' == *p1) *p1++ = 0; }
   }
 else strcpy(outdir, "OUT");
-/*-----------------------------------------------------------------------------
-CONSTRUCT THE NETWORK
------------------------------------------------------------------------------*/
-if (0 > (rc = swn(seedswn, manynode, halfdegree, dbeta, &pnode0)))
-  {
-  fprintf(stderr, "ERROR: failed to construct the network, retcode %i\n", rc);
-  return rc;
-  }
-/*-----------------------------------------------------------------------------
-ALLOCATE MEMORY FOR THE STATUS ARRAY
------------------------------------------------------------------------------*/
-if (NULL == \
-       (pstatus0 = (struct status *)malloc(manynode * sizeof(struct status))))
-  {
-  fprintf(stderr, "ERROR: memory allocation refused\n"); return -8;
-  }
-for (j = 0; j < manynode; j++)
+if (ptracefnm && (NULL == (trace.pf = fopen(ptracefnm, "w"))))
   {
-  (pstatus0 + j)->pnode = pnode0 + j;
-  (pnode0 + j)->pvoid = (void *)(pstatus0 + j); 
+  fprintf(stderr, "ERROR: cannot open trace file: %s\n", ptracefnm);
+  return -16;
   }
-/*-----------------------------------------------------------------------------
-NAME THE OUTPUT FILE AND OPEN IT
------------------------------------------------------------------------------*/
-snprintf(outfnm, 2040, "%s/%08X%08X-%i-%i-%5.3f-%4.2f-%4.2f-%i-%i", \
-                            outdir, seedcov, seedswn, manynode, halfdegree, \
-                                dbeta, dchance, dinert, incubating, recovery);
-if (NULL == (pfout = fopen(outfnm, "w")))
+pfreport = stdout;
+if (preport && strcmp(preport, "-") && (NULL == (pfreport = fopen(preport, "w"))))
   {
-  fprintf(stderr, "ERROR: cannot open output file: %s\n", outfnm); return -16;
+  fprintf(stderr, "ERROR: cannot open report file: %s\n", preport);
+  return -16;
   }
 /*-----------------------------------------------------------------------------
-INITIALISE THE STATUS ARRAY.
-PATIENT ZERO MUST HAVE AT LEAST  2*halfdegree  NEIGHBOURS.
+FOR EACH BETA OF THE SERIES (USUALLY JUST ONE) CONSTRUCT THE NETWORK, OR FOR A
+SERIES ADD THE REWIRING SINCE THE PREVIOUS BETA, AND RUN THE EPIDEMIC.
 -----------------------------------------------------------------------------*/
-seed = seedcov;
-srand(seed);
-manyedge = 0;
-while (1)
-  {
-  m = (rand_r(&seed)) % manynode; assert((0 <= m) && (manynode >m));
-  pp = (pstatus0 + m)->pnode->pp0;
-  while (NULL != *pp) { manyedge++; pp++; }
-  if (manyedge >= (2*halfdegree)) break;
-  }
-for (j = 0; j < manynode; j++)
-  {
-  (pstatus0 + j)->day = 0;
-  (pstatus0 + j)->inert = 0;
-  (pstatus0 + j)->shuffle = j;
-  if (m == j) (pstatus0 + j)->day = 1;
-  else { if (inert > (rand_r(&seed)) % 1024) (pstatus0 + j)->inert = 1; }
-  }
-/*---------------------------------------------------------------------------*/
-day = 0;
-fprintf(pfout, "Day Infected Uninfected Contacts\n");
-manycase = 0; manyedge = 0;
-for (j = 0; j < manynode; j++)
+pnode0 = NULL; dbetawas = 0.;
+for (kbeta = 0; ; kbeta++)
   {
-  if ((pstatus0 + j)->day) manycase++;
-  else
+  dbeta = dbetamin + (kbeta * dbetastep);
+  if (kbeta && ( ! coupled)) break;
+  if (dbeta > dbetamax + 1.e-9) break;
+  lap(ptrace, -1);
+  if (manyshard) rc = 0;
+  else if (coupled) rc = swncouple(seedswn, manynode, halfdegree, dbetawas, \
+                                                               dbeta, &pnode0);
+  else if (pgraph) rc = netload(pgraph, &manynode, &pnode0);
+  else if (slab) rc = swnpar(seedswn, manynode, halfdegree, dbeta, \
+                                                          manythread, &pnode0);
+  else           rc = swn(seedswn, manynode, halfdegree, dbeta, &pnode0);
+  if (0 > rc)
     {
-    pp = (pstatus0 + j)->pnode->pp0;
-    while (NULL != *pp) { manyedge++; pp++; }
+    fprintf(stderr, "ERROR: failed to construct the network, retcode %i\n", \
+                                                                           rc);
+    return rc;
     }
-  }
-fprintf(pfout, "%3i  %7.4f  %7.4f  %7.4f\n", \
-              day, ((double)manycase) / ((double)manynode), 
-                   ((double)(manynode - manycase)) / ((double)manynode), 
-                   ((double)manyedge) / ((double)(2 * manynode * halfdegree)));
-/*-----------------------------------------------------------------------------
-MAIN LOOP BEGINS
------------------------------------------------------------------------------*/
-manycasewas = 0; tick = 0;
-while (365 > day)
-  {
 /*-----------------------------------------------------------------------------
-RANDOMIZE THE ORDER IN WHICH THE NODES WILL BE UPDATED
+THE LAYERS, ONCE THE NODES ARE KNOWN, DO NOT DEPEND ON BETA
 -----------------------------------------------------------------------------*/
-  for (i = manynode - 1; i > 0; i--)
+  for (m = 0; ( ! kbeta) && (m < manylayer); m++)
     {
-    int swap;
-
-    swap = (pstatus0 + i)->shuffle;
-    j = rand_r(&seed) % (i + 1);
-    (pstatus0 + i)->shuffle = (pstatus0 + j)->shuffle;
-    (pstatus0 + j)->shuffle = swap;
+    if (0 > (rc = laybuild(&layer[m], seedswn, m + 1, manynode)))
+      {
+      fprintf(stderr, "ERROR: failed to construct layer %i, retcode %i\n", \
+                                                                   m + 1, rc);
+      return rc;
+      }
     }
-/*-----------------------------------------------------------------------------
-FOR EVERY NODE  j  WITH NON-ZERO .day, BUMP .day.
------------------------------------------------------------------------------*/
-  for (i = 0; i < manynode; i++)
+  lap(ptrace, COV_BUILD);
+  dbetawas = dbeta;
+  if (pimage && (0 > (rc = netsave(pimage, manynode, pnode0))))
     {
-    j = (pstatus0 + i)->shuffle;
-    if ((pstatus0 + j)->inert) continue;
-    if ((pstatus0 + j)->day) ((pstatus0 + j)->day)++;
+    fprintf(stderr, "ERROR: failed to save the network, retcode %i\n", rc);
+    return rc;
+    }
 /*-----------------------------------------------------------------------------
-... OTHERWISE SET .day OF NODE  j  TO  1  WITH PROBABILTY  chance  IF ANY
-NEIGHBOUR IS IN THE INFECTIOUS WINDOW  incubating < .day < recovery.
-THUS  chance  HAS UNITS: PER NEIGHBOUR PER DAY.
+OPTIONALLY REPORT ON THE NETWORK
 -----------------------------------------------------------------------------*/
-    else
+  if (preport && (0 > (rc = swnreport(pfreport, manynode, halfdegree, dbeta, \
+                                                                   pnode0))))
+    {
+    fprintf(stderr, "ERROR: failed to tabulate the degree distribution\n");
+    return rc;
+    }
+  if (0 <= manysource)
+    {
+    memset(&ana, 0, sizeof(ana));
+    if ((0 > (rc = anaclustering(manynode, pnode0, manythread, &ana))) || \
+        (manysource && (0 > (rc = anapathlength(manynode, pnode0, manysource, \
+                                         seedswn, manythread, &ana)))))
       {
-      pp = (pstatus0 + j)->pnode->pp0;
-      while (NULL != *pp)
-        {
-        pother = (struct status *)((*pp)->pvoid);
-        if ((incubating < pother->day) && (recovery > pother->day))
-          {
-          if (chance > (rand_r(&seed)) % 1024) (pstatus0 + j)->day = 1;
-          }
-        pp++;
-        }
+      return rc;
       }
+    if ( ! preport) fprintf(pfreport, "\n  beta = %5.3f\n", dbeta);
+    anareport(pfreport, manynode, halfdegree, &ana);
     }
 /*-----------------------------------------------------------------------------
-DETECT WHETHER ASYMPTOTE HAS BEEN REACHED
+NAME THE OUTPUT FILE AND RUN THE EPIDEMIC
 -----------------------------------------------------------------------------*/
-  if (manycasewas < manycase) { manycasewas = manycase; tick = 0; }
-  else tick++;
-  day++;
-/*-----------------------------------------------------------------------------
-UPDATE STATISTICS FOR THIS TIMESTEP
------------------------------------------------------------------------------*/
-  manycase = 0; manyedge = 0;
-  for (j = 0; j < manynode; j++)
+  snprintf(outfnm, 2040, "%s/%08X%08X-%i-%i-%5.3f-%4.2f-%4.2f-%i-%i", \
+                            outdir, seedcov, seedswn, manynode, halfdegree, \
+                                dbeta, dchance, dinert, incubating, recovery);
+  if (common) strncat(outfnm, "-c", sizeof(outfnm) - strlen(outfnm) - 1);
+  if (slab && ! pgraph) strncat(outfnm, "-p", \
+                                        sizeof(outfnm) - strlen(outfnm) - 1);
+  if (coupled) strncat(outfnm, "-coupled", \
+                                        sizeof(outfnm) - strlen(outfnm) - 1);
+  if (manyshard) strncat(outfnm, "-s", sizeof(outfnm) - strlen(outfnm) - 1);
+  if ((0. < width) && ( ! manyreplicate)) manyreplicate = COV_MANYREPLICATE;
+  m = strlen(outfnm);
+  if (0. < up) snprintf(outfnm + m, sizeof(outfnm) - m, "-m%g,%g", up, down);
+  for (n = 0; n < manylayer; n++)
     {
-    if ((pstatus0 + j)->day) manycase++;
-    else
+    m = strlen(outfnm);
+    strncat(outfnm, "-l", sizeof(outfnm) - m - 1); m = strlen(outfnm);
+    layname(outfnm + m, sizeof(outfnm) - m, &layer[n]);
+    }
+  m = strlen(outfnm);
+  if (manyreplicate) snprintf(outfnm + m, sizeof(outfnm) - m, "-r%i", \
+                                                              manyreplicate);
+  m = strlen(outfnm);
+  if (plabel) snprintf(outfnm + m, sizeof(outfnm) - m, "-%s", plabel);
+  if (manyshard)
+    {
+    if (NULL == (pfout = fopen(outfnm, "w")))
+      {
+      fprintf(stderr, "ERROR: cannot open output file: %s\n", outfnm);
+      return -16;
+      }
+    rc = shdrun(pfout, flush, seedswn, manynode, halfdegree, dbeta, seedcov, \
+      chance, inert, incubating, recovery, COV_MANYDAY, manyshard, numa);
+    fclose(pfout);
+    if (0 > rc) return rc;
+    fprintf(stdout, "-> %s\n", outfnm);
+    continue;
+    }
+  memset(&shape, 0, sizeof(shape));
+  if ((0. < up) && (0 > (rc = hybmeasure(&shape, manynode, pnode0, \
+                          manythread, (0 <= manysource) ? &ana : NULL))))
+    {
+    return rc;
+    }
+  if (manyreplicate)
+    {
+    if (0 > (rc = replicates(outfnm, NULL, pnode0, manynode, halfdegree, \
+                        seedcov, chance, inert, incubating, recovery, common, \
+                   &shape, up, down, manylayer, layer, manyreplicate, \
+                                             manythread, width, stopday)))
       {
-      pp = (pstatus0 + j)->pnode->pp0;
-      while (NULL != *pp) { manyedge++; pp++; }
+      return rc;
       }
     }
-  fprintf(pfout, "%3i  %7.4f  %7.4f  %7.4f\n", \
-              day, ((double)manycase) / ((double)manynode), 
-                   ((double)(manynode - manycase)) / ((double)manynode), 
-                   ((double)manyedge) / ((double)(2 * manynode * halfdegree)));
+  else
+    {
+    lap(ptrace, -1);
+    if (0 > (rc = epidemic(outfnm, NULL, pnode0, manynode, halfdegree, \
+              seedcov, chance, inert, incubating, recovery, common, flush, \
+                    &shape, up, down, manylayer, layer, dbeta, ptrace)))
+      {
+      return rc;
+      }
+    }
+  if (checked && (0 > (rc = check(pnode0, manynode, halfdegree, seedcov, \
+              chance, inert, incubating, recovery, common, &shape, up, down, \
+                              dbeta, manyreplicate ? manyreplicate : 1))))
+    {
+    return rc;
+    }
   }
-/*-----------------------------------------------------------------------------
-MAIN LOOP ENDS.  PRINT OUTPUT FILENAME ON  stdout.
------------------------------------------------------------------------------*/
-fprintf(stdout,"-> %s\n", outfnm);
 /*----------------------------------------------------------------------------
 CLEAN UP
 -----------------------------------------------------------------------------*/
-if (pfout) fclose(pfout);
-if (0 > swn(0, manynode, 0, 0., &pnode0))
+if (stdout != pfreport) fclose(pfreport);
+if (trace.pf) fclose(trace.pf);
+prfclose(&trace.prf);
+for (m = 0; m < manylayer; m++) layfree(&layer[m]);
+if (slab) netfree(manynode, &pnode0);
+else if (0 > swn(0, manynode, 0, 0., &pnode0))
   {
   fprintf(stderr, "WORRY: failed to free some memory allocated by swn()\n");
   }
-free(pstatus0);
 return 0;
 }
 /* ***************************************************************************/
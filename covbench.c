@@ -0,0 +1,286 @@
+/* ************************************************************//** @file covbench.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Benchmarks of the hot paths of cov: make bench.
+
+For each point of a grid of (manynode, halfdegree, beta) the phases below are
+timed, each in a fresh process so that its peak resident set is its own, and
+one line of JSON is written to stdout per point:
+
+  lattice   the ring lattice, built by swncouple() at beta = 0,
+  rewire    the rewiring of that lattice from beta = 0 to beta by swncouple(),
+  swn       the whole serial construction by swn(),
+  swnpar    the whole threaded construction by swnpar(),
+  shuffle   epishuffle(),  sweep  episweep(),  count  epicount(),
+            over a number of days of the epidemic of cov on the network of swn().
+
+Times are the least over the repeats.  Construction is reported in seconds
+and ring links per second; the day step in nanoseconds per node-day, and the
+sweep also in neighbour-list entries scanned per second.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "swn.h"
+#include "net.h"
+#include "epi.h"
+
+#define BENCH_MANYLIST (16)   /**< Most values in one dimension of the grid */
+
+/** Help message in response to command-line input mistakes */
+#define USAGE do { \
+   fprintf(stderr, \
+   "USAGE: ./covbench  [-n manynode,..]  [-k halfdegree,..]  [-b beta,..]\n" \
+   "                   [-d days]  [-r repeats]  [-j threads]\n"); \
+   } while(0)
+
+/** Results for one point of the grid */
+struct timing
+  {
+  double lattice, rewire, swn, swnpar;   /**< Construction, seconds          */
+  double shuffle, sweep, count;          /**< Day step, seconds over all days */
+  double scanned;                        /**< Entries scanned by the sweep    */
+  };
+
+/* ************************************************************************//**
+@brief  Seconds on the monotonic clock.
+*//* *************************************************************************/
+static double
+ now(void)
+{
+struct timespec ts;
+
+clock_gettime(CLOCK_MONOTONIC, &ts);
+return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+/* ************************************************************************//**
+@brief  Keep the lesser time, treating zero as none yet.
+*//* *************************************************************************/
+static inline void
+ least(double *pbest, double t)
+{
+if (( ! *pbest) || (t < *pbest)) *pbest = t;
+}
+/* ************************************************************************//**
+@brief  Parse a comma-separated list of numbers.
+@return The number of values, or -1 if there is a mistake.
+*//* *************************************************************************/
+static int
+ numbers(const char *pstr, double *pvalue)
+{
+char *pend;
+int n;
+
+for (n = 0; n < BENCH_MANYLIST; n++)
+  {
+  errno = 0; *(pvalue + n) = strtod(pstr, &pend);
+  if (errno || (pend == pstr)) return -1;
+  if ( ! *pend) return n + 1;
+  if (',' != *pend) return -1;
+  pstr = pend + 1;
+  }
+return -1;
+}
+/* ************************************************************************//**
+@brief  Time every phase at one point of the grid.
+@return Zero unless error.
+*//* *************************************************************************/
+static int
+ point(int manynode, int halfdegree, double dbeta, int manyday, \
+                       int manyrepeat, int manythread, struct timing *ptime)
+{
+struct node *pnode0;
+struct epidemic epi;
+double t0;
+int r, rc;
+
+memset(ptime, 0, sizeof(*ptime));
+for (r = 0; r < manyrepeat; r++)
+  {
+/*-----------------------------------------------------------------------------
+LATTICE, THEN REWIRING OF THAT LATTICE
+-----------------------------------------------------------------------------*/
+  pnode0 = NULL;
+  t0 = now();
+  if (0 > (rc = swncouple(0xDDDDDDDD, manynode, halfdegree, 0., 0., &pnode0)))
+    {
+    return rc;
+    }
+  least(&ptime->lattice, now() - t0);
+  t0 = now();
+  if (0 > (rc = swncouple(0xDDDDDDDD, manynode, halfdegree, 0., dbeta, \
+                                                                   &pnode0)))
+    {
+    return rc;
+    }
+  least(&ptime->rewire, now() - t0);
+  swn(0, manynode, 0, 0., &pnode0);
+/*-----------------------------------------------------------------------------
+THE THREADED CONSTRUCTION
+-----------------------------------------------------------------------------*/
+  pnode0 = NULL;
+  t0 = now();
+  if (0 > (rc = swnpar(0xDDDDDDDD, manynode, halfdegree, dbeta, manythread, \
+                                                                   &pnode0)))
+    {
+    return rc;
+    }
+  least(&ptime->swnpar, now() - t0);
+  netfree(manynode, &pnode0);
+/*-----------------------------------------------------------------------------
+THE SERIAL CONSTRUCTION, AND THE EPIDEMIC ON ITS NETWORK
+-----------------------------------------------------------------------------*/
+  pnode0 = NULL;
+  t0 = now();
+  if (0 > (rc = swn(0xDDDDDDDD, manynode, halfdegree, dbeta, &pnode0)))
+    {
+    return rc;
+    }
+  least(&ptime->swn, now() - t0);
+  if (0 > (rc = epiinit(&epi, pnode0, manynode, halfdegree, 0x7FFFFFFF, \
+                                                          256, 0, 2, 9, 0)))
+    {
+    return rc;
+    }
+  {
+  double shuffle, sweep, count, scanned;
+  long visitwas;
+
+  shuffle = 0.; sweep = 0.; count = 0.; scanned = 0.;
+  while (manyday > epi.day)
+    {
+    t0 = now(); epishuffle(&epi); shuffle += now() - t0;
+    visitwas = epi.manyvisit;
+    t0 = now(); episweep(&epi);   sweep   += now() - t0;
+    scanned += (double)(epi.manyvisit - visitwas);
+    t0 = now(); epicount(&epi);   count   += now() - t0;
+    }
+  least(&ptime->shuffle, shuffle);
+  least(&ptime->sweep, sweep);
+  least(&ptime->count, count);
+  ptime->scanned = scanned;
+  }
+  epifree(&epi);
+  swn(0, manynode, 0, 0., &pnode0);
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief Main program: covbench
+
+USAGE: ./covbench  [-n manynode,..]  [-k halfdegree,..]  [-b beta,..] \
+                   [-d days]  [-r repeats]  [-j threads]
+*//* *************************************************************************/
+int
+ main(int argc, char *argv[])
+{
+double node[BENCH_MANYLIST], half[BENCH_MANYLIST], beta[BENCH_MANYLIST];
+int manyn, manyk, manyb;
+int manyday, manyrepeat, manythread;
+int in, ik, ib, m, status, rc;
+struct timing t;
+struct rusage usage;
+double nodeday, link;
+pid_t pid;
+
+node[0] = 10000.; node[1] = 100000.; node[2] = 1000000.; manyn = 3;
+half[0] = 2.; half[1] = 3.; half[2] = 5.; manyk = 3;
+beta[0] = 0.; beta[1] = 0.01; beta[2] = 0.1; manyb = 3;
+manyday = 30; manyrepeat = 3; manythread = 4;
+while (-1 != (m = getopt(argc, argv, "n:k:b:d:r:j:")))
+  {
+  switch (m)
+    {
+    case 'n': manyn = numbers(optarg, node); break;
+    case 'k': manyk = numbers(optarg, half); break;
+    case 'b': manyb = numbers(optarg, beta); break;
+    case 'd': manyday = atoi(optarg); break;
+    case 'r': manyrepeat = atoi(optarg); break;
+    case 'j': manythread = atoi(optarg); break;
+    default : USAGE; return -1;
+    }
+  }
+if ((0 >= manyn) || (0 >= manyk) || (0 >= manyb) || (optind < argc) || \
+    (1 > manyday) || (1 > manyrepeat) || (1 > manythread))
+  {
+  USAGE; return -1;
+  }
+rc = 0;
+for (in = 0; in < manyn; in++)
+for (ik = 0; ik < manyk; ik++)
+for (ib = 0; ib < manyb; ib++)
+  {
+  if (node[in] <= 2. * half[ik]) continue;
+  fflush(stdout);
+  if (0 > (pid = fork()))
+    {
+    fprintf(stderr, "ERROR: cannot fork\n"); return -1;
+    }
+/*-----------------------------------------------------------------------------
+THE CHILD TIMES ONE POINT AND WRITES ONE LINE
+-----------------------------------------------------------------------------*/
+  if ( ! pid)
+    {
+    if (0 > (rc = point((int)node[in], (int)half[ik], beta[ib], manyday, \
+                                          manyrepeat, manythread, &t)))
+      {
+      fprintf(stderr, "ERROR: benchmark failed, retcode %i\n", rc);
+      _exit(1);
+      }
+    getrusage(RUSAGE_SELF, &usage);
+    nodeday = node[in] * (double)manyday;
+    link = node[in] * half[ik];
+    printf("{\"manynode\": %i, \"halfdegree\": %i, \"beta\": %g, " \
+           "\"days\": %i, \"threads\": %i, " \
+           "\"lattice_s\": %.6f, \"lattice_links_per_s\": %.4e, " \
+           "\"rewire_s\": %.6f, \"rewire_links_per_s\": %.4e, " \
+           "\"swn_s\": %.6f, \"swn_links_per_s\": %.4e, " \
+           "\"swnpar_s\": %.6f, \"swnpar_links_per_s\": %.4e, " \
+           "\"shuffle_ns_per_node_day\": %.3f, " \
+           "\"sweep_ns_per_node_day\": %.3f, " \
+           "\"sweep_entries_per_s\": %.4e, " \
+           "\"count_ns_per_node_day\": %.3f, " \
+           "\"peak_rss_kb\": %li}\n", \
+           (int)node[in], (int)half[ik], beta[ib], manyday, manythread, \
+           t.lattice, link / t.lattice, t.rewire, link / t.rewire, \
+           t.swn, link / t.swn, t.swnpar, link / t.swnpar, \
+           1.e9 * t.shuffle / nodeday, 1.e9 * t.sweep / nodeday, \
+           t.scanned / t.sweep, 1.e9 * t.count / nodeday, \
+           (long)usage.ru_maxrss);
+    fflush(stdout);
+    _exit(0);
+    }
+  if ((0 > waitpid(pid, &status, 0)) || \
+      ( ! WIFEXITED(status)) || WEXITSTATUS(status))
+    {
+    rc = -1;
+    }
+  }
+return rc;
+}
+/* ***************************************************************************/
@@ -0,0 +1,585 @@
+/* ************************************************************//** @file covdist.c
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Distances between every pair of the curves of many runs of cov.
+
+The column of each output file (Infected by default) is a curve, one value a
+row, and for every pair of curves a and b four distances are found:
+
+  l2     the Euclidean distance, the root of the sum over rows of (a - b)^2,
+  max    the largest of |a - b| over rows,
+  final  |a - b| on the last row: the difference of final sizes,
+  peak   the difference of the days (first column) on which a and b rose
+         most from one row to the next: the peaks of new infections.
+
+The curves are held as single-precision numbers with a row of all the runs
+together, so that one value of a curve is compared with a whole stretch of
+others by a loop the compiler vectorises; the pairs are taken in blocks of
+DIST_BI by DIST_BJ curves, so that the stretches in use stay in the cache,
+and the blocks of rows are shared among threads as each becomes free.  Only
+the pairs above the diagonal are found unless the matrices are to be square.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "rdr.h"
+#include "par.h"
+
+#define DIST_BI     (16)          /**< Curves of a block of rows            */
+#define DIST_BJ     (128)         /**< Curves of a block of columns         */
+#define DIST_TI     (4)           /**< Curves compared at once with these   */
+#define DIST_SKEW   (16)          /**< Padding of a row, against aliasing   */
+#define DIST_FIELD  (11)          /**< Bytes of a distance as text          */
+#define DIST_MAGIC  "COVDIST1"    /**< First bytes of a binary matrix       */
+
+/** The distances, in the order of their files */
+enum {DIST_L2, DIST_MAX, DIST_FINAL, DIST_PEAK, DIST_MANY};
+
+/** The names of the distances, which end the names of their files */
+static const char *metricname[DIST_MANY] = {"l2", "max", "final", "peak"};
+
+/** Help message in response to command-line input mistakes */
+#define USAGE do { \
+   fprintf(stderr, \
+   "USAGE: ./covdist  [-c heading]  [-m l2,max,final,peak]  [-j threads]\n" \
+   "                  [-b]  [-l list]  prefix  [file1 [file2 [...]]]\n"); \
+   } while(0)
+
+/** The curves of all the runs */
+struct curves
+  {
+  int     many;           /**< Runs                                          */
+  int     manyrow;        /**< Rows of each                                  */
+  size_t  stride;         /**< Runs rounded up to a multiple of DIST_BJ      */
+  float  *pt;             /**< Row r of run k at  pt[r*stride + k]           */
+  float  *pfinal;         /**< The value on the last row, of each run        */
+  float  *ppeak;          /**< The day of the greatest rise, of each run     */
+  char  **ppfile;         /**< The file of each run                          */
+  const char *phead;      /**< The heading of the column compared            */
+  };
+
+/** The work of one thread */
+struct work
+  {
+  struct curves *pc;      /**< The curves                                    */
+  int    *pnext;          /**< Next run to read, or block of rows to compare */
+  int    *pfailed;        /**< Count of failures                             */
+  const int *pwant;       /**< Non-zero for each distance wanted             */
+  const int *pfd;         /**< The file of each distance wanted              */
+  int     square;         /**< Non-zero for square text, else binary         */
+  float  *pbuf;           /**< DIST_BI rows of each distance wanted          */
+  char   *ptext;          /**< A row as text                                 */
+  };
+
+/* ************************************************************************//**
+@brief  Seconds on the monotonic clock.
+*//* *************************************************************************/
+static double
+ now(void)
+{
+struct timespec ts;
+
+clock_gettime(CLOCK_MONOTONIC, &ts);
+return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+/* ************************************************************************//**
+@brief   Read the curve of one run into its place among the others.
+@param   pc    The curves, with room for this one.
+@param   k     The run.
+@return        Zero unless error.
+*//***************************************************************************/
+static int
+ curve(struct curves *pc, int k)
+{
+struct rdr rdr0;
+int kolumn, row, rc;
+double rise, most, last;
+
+if (0 > rdropen(&rdr0, pc->ppfile[k])) return -16;
+if (0 > (kolumn = rdrcolumn(&rdr0, pc->phead)))
+  {
+  fprintf(stderr, "ERROR: heading not found in %s: %s\n", pc->ppfile[k], \
+                                                                  pc->phead);
+  rdrclose(&rdr0); return -1;
+  }
+rc = 0; most = 0.; last = 0.;
+for (row = 0; 0 < (rc = rdrnext(&rdr0)); row++)
+  {
+  if (row >= pc->manyrow) { row++; break; }
+  pc->pt[row*pc->stride + k] = (float)rdr0.prow[kolumn];
+  rise = rdr0.prow[kolumn] - last; last = rdr0.prow[kolumn];
+  if ( ! row || (1 == row) || (rise > most))
+    {
+    most = rise; pc->ppeak[k] = (float)rdr0.prow[0];
+    }
+  }
+pc->pfinal[k] = (float)last;
+rdrclose(&rdr0);
+if (0 > rc) return -1;
+if (row != pc->manyrow)
+  {
+  fprintf(stderr, "ERROR: %s has %s rows than %s\n", pc->ppfile[k], \
+                      (row < pc->manyrow) ? "fewer" : "more", pc->ppfile[0]);
+  return -1;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Read the curves of the runs, claiming them one at a time.
+*//***************************************************************************/
+static void *
+ readmany(void *pv)
+{
+struct work *pw;
+int k;
+
+pw = (struct work *)pv;
+while (pw->pc->many > (k = __atomic_fetch_add(pw->pnext, 1, \
+                                                         __ATOMIC_RELAXED)))
+  {
+  if (curve(pw->pc, k)) __atomic_fetch_add(pw->pfailed, 1, __ATOMIC_RELAXED);
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief   Write a row of a distance.
+@param   pw    The thread's work.
+@param   fd    The file of the distance.
+@param   pd    The distances from run  i  to every run.
+@param   i     The run of the row.
+@return        Zero unless error.
+
+A square matrix is text of fixed width, so that each row has its place in the
+file whichever thread writes it first; otherwise the pairs above the diagonal
+are written as binary floats, row after row, after a header of DIST_MAGIC and
+the number of runs.
+*//***************************************************************************/
+static int
+ rowout(struct work *pw, int fd, const float *pd, int i)
+{
+char field[32];
+size_t size;
+off_t at;
+long n, j;
+char *p;
+
+n = pw->pc->many;
+if (pw->square)
+  {
+  for (j = 0, p = pw->ptext; j < n; j++, p += DIST_FIELD)
+    {
+    snprintf(&field[0], 32, "%10.4e", (double)pd[j]);
+    memcpy(p, &field[0], DIST_FIELD - 1);
+    p[DIST_FIELD - 1] = (j + 1 < n) ? ' ' : '\n';
+    }
+  size = (size_t)n * DIST_FIELD;
+  at = (off_t)i * (off_t)size;
+  p = pw->ptext;
+  }
+else
+  {
+  size = (size_t)(n - 1 - i) * sizeof(float);
+  at = 16 + (off_t)sizeof(float) * ((off_t)i*(n - 1) - (off_t)i*(i - 1)/2);
+  p = (char *)(pd + i + 1);
+  }
+if ((ssize_t)size != pwrite(fd, p, size, at))
+  {
+  fprintf(stderr, "ERROR: cannot write output file: %s\n", strerror(errno));
+  return -16;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Compare DIST_TI curves with a stretch of others over all rows.
+@param   pc      The curves.
+@param   i       The first of the one.
+@param   j       The first of the others.
+@param   many    The number of others, no more than DIST_BJ.
+@param   sum     Set to the sums of squares of the differences.
+@param   most    Set to the greatest differences.
+
+Each value of the others is loaded once for DIST_TI curves, and the loop
+over the others is vectorised.  Curves past the last run are those of the
+padding, all zero.
+*//***************************************************************************/
+static void
+ tile(const struct curves *pc, int i, int j, int many, \
+                          float sum[DIST_TI][DIST_BJ], float most[DIST_TI][DIST_BJ])
+{
+const float *prow;
+float x[DIST_TI], y, diff;
+int row, ii, jj;
+
+memset(&sum[0][0], 0, DIST_TI*DIST_BJ*sizeof(float));
+memset(&most[0][0], 0, DIST_TI*DIST_BJ*sizeof(float));
+for (row = 0, prow = pc->pt; row < pc->manyrow; row++, prow += pc->stride)
+  {
+  for (ii = 0; ii < DIST_TI; ii++) x[ii] = prow[i + ii];
+  for (jj = 0; jj < many; jj++)
+    {
+    y = prow[j + jj];
+    for (ii = 0; ii < DIST_TI; ii++)
+      {
+      diff = fabsf(x[ii] - y);
+      sum[ii][jj] += diff*diff;
+      most[ii][jj] = (diff > most[ii][jj]) ? diff : most[ii][jj];
+      }
+    }
+  }
+}
+/* ************************************************************************//**
+@brief   Find the distances of a block of rows at a time, claiming them one
+         at a time, and write them.
+*//***************************************************************************/
+static void *
+ distmany(void *pv)
+{
+struct work *pw;
+const struct curves *pc;
+float sum[DIST_TI][DIST_BJ], most[DIST_TI][DIST_BJ];
+float *pd[DIST_MANY];
+size_t at;
+int n, i0, i1, i, j0, j1, j, ii, m, each, rc;
+
+pw = (struct work *)pv; pc = pw->pc; n = pc->many;
+each = pw->pwant[DIST_L2] || pw->pwant[DIST_MAX];
+for (m = 0, j = 0; m < DIST_MANY; m++)
+  {
+  pd[m] = pw->pwant[m] ? pw->pbuf + (size_t)(j++)*DIST_BI*n : NULL;
+  }
+while (n > (i0 = DIST_BI*__atomic_fetch_add(pw->pnext, 1, __ATOMIC_RELAXED)))
+  {
+  i1 = (i0 + DIST_BI < n) ? i0 + DIST_BI : n;
+  for (j0 = pw->square ? 0 : i0; each && (j0 < n); j0 += DIST_BJ)
+    {
+    j1 = (j0 + DIST_BJ < n) ? j0 + DIST_BJ : n;
+    for (i = i0; i < i1; i += DIST_TI)
+      {
+      if ( ! pw->square && (j1 <= i + 1)) continue;
+      tile(pc, i, j0, j1 - j0, sum, most);
+      for (ii = 0; (ii < DIST_TI) && (i + ii < i1); ii++)
+        {
+        at = (size_t)(i + ii - i0)*n;
+        for (j = j0; pd[DIST_L2] && (j < j1); j++)
+          pd[DIST_L2][at + j] = sqrtf(sum[ii][j - j0]);
+        for (j = j0; pd[DIST_MAX] && (j < j1); j++)
+          pd[DIST_MAX][at + j] = most[ii][j - j0];
+        }
+      }
+    }
+  for (i = i0; i < i1; i++)
+    {
+    if (pd[DIST_FINAL]) for (j = 0; j < n; j++)
+      pd[DIST_FINAL][(size_t)(i - i0)*n + j] = fabsf(pc->pfinal[i] - \
+                                                              pc->pfinal[j]);
+    if (pd[DIST_PEAK]) for (j = 0; j < n; j++)
+      pd[DIST_PEAK][(size_t)(i - i0)*n + j] = fabsf(pc->ppeak[i] - \
+                                                               pc->ppeak[j]);
+    for (m = 0, rc = 0; ! rc && (m < DIST_MANY); m++)
+      {
+      if (pd[m]) rc = rowout(pw, pw->pfd[m], pd[m] + (size_t)(i - i0)*n, i);
+      }
+    if (rc) { __atomic_fetch_add(pw->pfailed, 1, __ATOMIC_RELAXED); break; }
+    }
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief   Read a list of files, one or more to a line, separated by white
+         space.  Blank lines, and lines beginning with '#', are skipped.
+@param   plistfnm  The list, or - for the standard input.
+@param   ppbuf     Set to the text of the list, which the files point into.
+@param   pppfile   Set to the files.
+@param   pmany     Set to their number.
+@return            Zero unless error.
+*//* *************************************************************************/
+static int
+ listread(const char *plistfnm, char **ppbuf, char ***pppfile, int *pmany)
+{
+FILE *pf;
+char *pbuf, *p1, *pnew, **ppfile;
+size_t size, room, got;
+int many, skip;
+
+*ppbuf = NULL; *pppfile = NULL; *pmany = 0;
+pf = strcmp(plistfnm, "-") ? fopen(plistfnm, "r") : stdin;
+if (NULL == pf)
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", plistfnm);
+  return -16;
+  }
+pbuf = NULL; size = 0; room = 0;
+do
+  {
+  if (size + 1 >= room)
+    {
+    room = room ? 2*room : 65536;
+    if (NULL == (pnew = (char *)realloc(pbuf, room)))
+      {
+      free(pbuf); if (stdin != pf) fclose(pf);
+      fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+      }
+    pbuf = pnew;
+    }
+  got = fread(pbuf + size, 1, room - size - 1, pf);
+  size += got;
+  } while (got);
+pbuf[size] = 0;
+if (stdin != pf) fclose(pf);
+for (many = 1, p1 = pbuf; *p1; p1++)
+  {
+  if (isspace((unsigned char)*p1)) many++;
+  }
+if (NULL == (ppfile = (char **)malloc(many*sizeof(char *))))
+  {
+  free(pbuf); fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+*ppbuf = pbuf; *pppfile = ppfile;
+for (skip = 0, p1 = pbuf; *p1; )
+  {
+  if ('\n' == *p1) { skip = 0; *p1++ = 0; continue; }
+  if (isspace((unsigned char)*p1)) { *p1++ = 0; continue; }
+  if ('#' == *p1) skip = 1;
+  if ( ! skip) ppfile[(*pmany)++] = p1;
+  while (*p1 && ! isspace((unsigned char)*p1)) p1++;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Open the file of a distance and give it its size, so that rows may
+         be written to it in any order.
+@return  Its descriptor, or -1 if error.
+*//***************************************************************************/
+static int
+ distopen(const char *pprefix, int m, int many, int square)
+{
+char fnm[FILENAME_MAX];
+char head[16];
+uint32_t u;
+off_t size;
+int fd;
+
+if (FILENAME_MAX <= snprintf(&fnm[0], FILENAME_MAX, "%s-%s", pprefix, \
+                                                            metricname[m]))
+  {
+  fprintf(stderr, "ERROR: name too long: %s\n", pprefix); return -1;
+  }
+if (0 > (fd = open(&fnm[0], O_WRONLY | O_CREAT | O_TRUNC, 0644)))
+  {
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", &fnm[0]);
+  return -1;
+  }
+if (square) size = (off_t)many * (off_t)many * DIST_FIELD;
+else
+  {
+  size = 16 + (off_t)sizeof(float) * ((off_t)many*(many - 1)/2);
+  memcpy(&head[0], DIST_MAGIC, 8);
+  u = (uint32_t)many; memcpy(&head[8], &u, 4);
+  u = (uint32_t)m;    memcpy(&head[12], &u, 4);
+  if (16 != pwrite(fd, &head[0], 16, 0)) size = -1;
+  }
+if ((0 > size) || ftruncate(fd, size))
+  {
+  fprintf(stderr, "ERROR: cannot write output file: %s\n", &fnm[0]);
+  close(fd); return -1;
+  }
+printf("-> %s\n", &fnm[0]);
+return fd;
+}
+/**************************************************************************//**
+@brief   Find the distances between the curves of every pair of runs.
+
+USAGE:   ./covdist  [-c heading] [-m l2,max,final,peak] [-j threads] [-b]
+                    [-l list]  prefix  [file1 [file2 [...]]]             \n
+         compares the column  heading  (Infected by default) of the files,
+         which are the output of cov and must have the same number of rows,
+         as well as those of the list given by -l (or - for the standard
+         input), and writes to  prefix-l2, prefix-max, prefix-final  and
+         prefix-peak  the distances of each pair, or only those given by -m.
+         prefix-runs  lists the runs in the order of the rows of each.
+
+         Each is a square matrix as text, or with -b the pairs above the
+         diagonal as binary floats (in the byte order of the machine), row
+         after row: the distance of runs i < j of n being number
+         i*(n-1) - i*(i-1)/2 + j-i-1, after a header of 16 bytes: COVDIST1,
+         then n and the number of the distance (l2 0, max 1, final 2,
+         peak 3) as 32-bit integers.  Thousands of runs want -b.
+@return         Zero unless error.
+*//* *************************************************************************/
+int
+ main(int argc, char *argv[])
+{
+struct curves c;
+struct work *pw;
+FILE *pf;
+char fnm[FILENAME_MAX];
+char *pbuf, **pplist, *p1, *p2;
+const char *plistfnm, *pprefix;
+int want[DIST_MANY], fd[DIST_MANY];
+int manythread, manylist, manywant, square, isbad, next, failed, m, n, rc;
+double t0, t1;
+
+isbad = 0; plistfnm = NULL; manythread = 1; square = 1;
+memset(&c, 0, sizeof(c)); c.phead = "Infected";
+for (m = 0; m < DIST_MANY; m++) { want[m] = 1; fd[m] = -1; }
+while (-1 != (m = getopt(argc, argv, "c:m:j:bl:")))
+  {
+  switch (m)
+    {
+    case 'c': c.phead = optarg; break;
+    case 'm':
+      for (m = 0; m < DIST_MANY; m++) want[m] = 0;
+      for (p1 = optarg; *p1; p1 = *p2 ? p2 + 1 : p2)
+        {
+        for (p2 = p1; *p2 && (',' != *p2); p2++) {;}
+        for (m = 0; m < DIST_MANY; m++)
+          {
+          if ((strlen(metricname[m]) == (size_t)(p2 - p1)) && \
+                                 ! strncmp(p1, metricname[m], p2 - p1)) break;
+          }
+        if (DIST_MANY == m) isbad++; else want[m] = 1;
+        }
+      break;
+    case 'j':
+      errno = 0; manythread = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manythread)) isbad++;
+      break;
+    case 'b': square = 0; break;
+    case 'l': plistfnm = optarg; break;
+    default: isbad++;
+    }
+  }
+for (manywant = 0, m = 0; m < DIST_MANY; m++) manywant += want[m];
+if ((optind >= argc) || ! manywant) isbad++;
+if (isbad) { USAGE; return -1; }
+pprefix = argv[optind++];
+/*-----------------------------------------------------------------------------
+THE FILES OF THE LIST FOLLOW THOSE OF THE COMMAND LINE
+-----------------------------------------------------------------------------*/
+pbuf = NULL; pplist = NULL; manylist = 0;
+if (plistfnm && (rc = listread(plistfnm, &pbuf, &pplist, &manylist))) \
+                                                                    return rc;
+c.many = argc - optind + manylist;
+if (2 > c.many)
+  {
+  fprintf(stderr, "ERROR: two runs at least are wanted\n"); return -1;
+  }
+if (NULL == (c.ppfile = (char **)malloc(c.many*sizeof(char *))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 0; n < argc - optind; n++) c.ppfile[n] = argv[optind + n];
+for (m = 0; m < manylist; m++) c.ppfile[n + m] = pplist[m];
+t0 = now();
+{
+struct rdr rdr0;
+
+if (0 > rdropen(&rdr0, c.ppfile[0])) return -16;
+while (0 < (rc = rdrnext(&rdr0))) c.manyrow++;
+rdrclose(&rdr0);
+if ((0 > rc) || ! c.manyrow)
+  {
+  fprintf(stderr, "ERROR: no rows in %s\n", c.ppfile[0]); return -1;
+  }
+}
+c.stride = (c.many + DIST_BJ - 1)/DIST_BJ*DIST_BJ + DIST_SKEW;
+c.pt = (float *)calloc(c.stride*c.manyrow, sizeof(float));
+c.pfinal = (float *)calloc(c.many, sizeof(float));
+c.ppeak = (float *)calloc(c.many, sizeof(float));
+if (manythread > c.many/DIST_BI + 1) manythread = c.many/DIST_BI + 1;
+pw = (struct work *)calloc(manythread, sizeof(struct work));
+if ( ! c.pt || ! c.pfinal || ! c.ppeak || ! pw)
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+next = 0; failed = 0;
+for (n = 0; n < manythread; n++)
+  {
+  pw[n].pc = &c; pw[n].pnext = &next; pw[n].pfailed = &failed;
+  pw[n].pwant = &want[0]; pw[n].pfd = &fd[0]; pw[n].square = square;
+  }
+if ((rc = parallel(manythread, readmany, pw, sizeof(struct work)))) \
+                                                                    return rc;
+if (failed) return -1;
+t1 = now();
+printf("%i runs of %i rows read in %.3f seconds\n", c.many, c.manyrow, \
+                                                                     t1 - t0);
+/*-----------------------------------------------------------------------------
+THE RUNS, THEN THE DISTANCES
+-----------------------------------------------------------------------------*/
+if (FILENAME_MAX <= snprintf(&fnm[0], FILENAME_MAX, "%s-runs", pprefix))
+  {
+  fprintf(stderr, "ERROR: name too long: %s\n", pprefix); return -1;
+  }
+if (NULL == (pf = fopen(&fnm[0], "w")))
+  {
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", &fnm[0]);
+  return -16;
+  }
+for (n = 0; n < c.many; n++) fprintf(pf, "%s\n", c.ppfile[n]);
+if (fclose(pf))
+  {
+  fprintf(stderr, "ERROR: cannot write output file: %s\n", &fnm[0]);
+  return -16;
+  }
+printf("-> %s\n", &fnm[0]);
+for (m = 0; m < DIST_MANY; m++)
+  {
+  if (want[m] && (0 > (fd[m] = distopen(pprefix, m, c.many, square)))) \
+                                                                  return -16;
+  }
+for (n = 0; n < manythread; n++)
+  {
+  pw[n].pbuf = (float *)malloc((size_t)manywant*DIST_BI*c.many*sizeof(float));
+  pw[n].ptext = square ? (char *)malloc((size_t)c.many*DIST_FIELD) : NULL;
+  if ( ! pw[n].pbuf || (square && ! pw[n].ptext))
+    {
+    fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+    }
+  }
+next = 0;
+rc = parallel(manythread, distmany, pw, sizeof(struct work));
+for (m = 0; m < DIST_MANY; m++)
+  {
+  if ((0 <= fd[m]) && close(fd[m]))
+    {
+    fprintf(stderr, "ERROR: cannot write output file: %s-%s\n", pprefix, \
+                                                             metricname[m]);
+    rc = -16;
+    }
+  }
+if ( ! rc && failed) rc = -1;
+if ( ! rc) printf("%li pairs compared in %.3f seconds\n", \
+                       (long)c.many*(c.many - 1)/2, now() - t1);
+for (n = 0; n < manythread; n++) { free(pw[n].pbuf); free(pw[n].ptext); }
+free(pw); free(c.pt); free(c.pfinal); free(c.ppeak); free(c.ppfile);
+free(pplist); free(pbuf);
+return rc;
+}
+/* ***************************************************************************/
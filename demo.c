@@ -27,12 +27,31 @@ ______________________________________________________________________________
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <math.h>
+#include "par.h"
 #include <errno.h>
 
+#define DEMO_BASEBYTES (4.e6) /**< Footprint of cov before any network      */
+
+/** Help message in response to command-line input mistakes */
+#define USAGE do { \
+   fprintf(stderr, \
+   "USAGE: ./demo  [-j workers]  [-m budget]  [-t trace.json]\n" \
+   "              full_path_to_agenda_file\n" \
+   "       where  -j  runs that many copies of cov at once (default 1),\n" \
+   "              -m  keeps the estimated memory of the runs under way\n" \
+   "                  within budget bytes, which may end in K, M or G,\n" \
+   "                  or be  auto  for 80%% of physical memory,\n" \
+   "              -t  writes a timeline of the runs in Chrome trace-event\n" \
+   "                  format, for chrome://tracing or Perfetto.\n"); \
+   } while(0)
+
 /** All data contained in a single line of the input file */
 struct w
   {
@@ -40,31 +59,843 @@ struct w
   char     outdir[1024];                               /**< Output directory */
   int      j[9][3];                                    /**< Integer data     */
   double   d[9][3];                                    /**< Float data       */
+  int      coupled;       /**< Flag set by directive  @coupled: one run of cov
+                                          covers the whole range of beta     */
+  int      common;        /**< Set by  @common: cov -c                       */
+  int      replicates;    /**< Set by  @replicates=N: cov -r N               */
+  char     width[32];     /**< Set by  @width=W[,day]: cov -e W[,day]        */
+  int      search;        /**< Field searched by  @search=, or zero          */
+  double   level;         /**< Final size marking an outbreak under  @search */
+  double   top;           /**< Greatest value of the field searched          */
+  int      design;        /**< Set by  @lhs=N  (1) or  @sobol=N  (2)         */
+  int      manypoint;     /**< The N of the design                           */
+  int      logscale[9];   /**< Fields sampled on a log scale, by  @log=      */
   } w;            /**< All data contained in a single line of the input file */
 
+/** One curve of a threshold search: every field fixed but the one searched */
+struct curve
+  {
+  struct w w;             /**< The line of the agenda                       */
+  int      manynode;      /**< The fixed values of the other fields ...     */
+  int      halfdegree;
+  double   beta;
+  double   chance;
+  double   inert;
+  int      incubation;
+  int      recovery;      /**< ... to here                                  */
+  double   lo, hi;        /**< Bracket of the threshold                     */
+  int      uplo, uphi;    /**< Whether there was an outbreak at each end    */
+  double   mid;           /**< Middle of the bracket, being run             */
+  int      joblo, jobhi;  /**< Runs of the ends under way, or -1            */
+  int      jobmid;        /**< Run of the middle under way, or -1           */
+  int      probes;        /**< Points run so far                            */
+  int      done;          /**< Set once the bracket is as narrow as asked   */
+  };
+
+/** One run of cov, from the time the agenda is read to the time it ends */
+struct job
+  {
+  char    *pcmd;          /**< The arguments of cov                         */
+  char    *pname;         /**< The output file, as listed on stdout, or for
+                               @coupled the file of each beta, one a line  */
+  int      manynode;      /**< Number of nodes                              */
+  int      halfdegree;    /**< Half the degree of the ring                  */
+  int      order;         /**< Position in the agenda                       */
+  double   bytes;         /**< Estimated footprint, from footprint()        */
+  double   charge;        /**< Footprint charged to the budget while running */
+  double   peak;          /**< Measured peak resident set, in bytes          */
+  pid_t    pid;           /**< Process running the command, while it runs   */
+  int      worker;        /**< Slot of the pool in which it ran             */
+  double   tqueue;        /**< Seconds from the start when it was queued    */
+  double   tstart;        /**< ... when it was started                      */
+  double   tend;          /**< ... when it ended                            */
+  int      rc;            /**< Exit status of the command                   */
+  int      timed;         /**< Non-zero if it may be timed by cov -t        */
+  };
+
+static struct job *pjob0;      /**< All the runs of the agenda               */
+static int manyjob, roomjob;   /**< Runs in use and allocated at  pjob0      */
+static double tzero;           /**< Clock when the agenda was first read     */
+static double scale = 1.;      /**< Largest ratio of peak to estimated memory */
+static struct curve *pcurve0;  /**< All the curves of threshold searches     */
+static int manycurve;          /**< Curves in use at  pcurve0                */
+
+/* ************************************************************************//**
+@brief  Seconds since  tzero  on the monotonic clock.
+*//* *************************************************************************/
+static double
+ since(void)
+{
+struct timespec ts;
+
+clock_gettime(CLOCK_MONOTONIC, &ts);
+return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec - tzero;
+}
+/* ************************************************************************//**
+@brief  Estimate the memory a run of cov will need: the nodes, the neighbour
+        list of each (a separate allocation of  2*halfdegree + 1  pointers
+        in swn()), the status of each node, and a little more.
+@return Bytes.
+*//* *************************************************************************/
+static double
+ footprint(const struct job *pjob)
+{
+double list;
+
+list = 16. * ceil((8. * (2 * pjob->halfdegree + 1) + 8.) / 16.);
+if (32. > list) list = 32.;
+return DEMO_BASEBYTES + (double)pjob->manynode * (16. + list + 16.);
+}
+/* ************************************************************************//**
+@brief  Add a run to the queue.
+@return Zero unless error.
+*//* *************************************************************************/
+static int
+ enqueue(const char *pcmd, const char *pname, int manynode, int halfdegree)
+{
+struct job *pjob;
+void *pnew;
+int room;
+
+if (manyjob >= roomjob)
+  {
+  room = roomjob ? 2 * roomjob : 256;
+  if (NULL == (pnew = realloc(pjob0, room * sizeof(struct job))))
+    {
+    fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+    }
+  pjob0 = (struct job *)pnew; roomjob = room;
+  }
+pjob = pjob0 + manyjob;
+memset(pjob, 0, sizeof(struct job));
+if ((NULL == (pjob->pcmd = strdup(pcmd))) || \
+    (NULL == (pjob->pname = strdup(pname))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+pjob->manynode = manynode; pjob->halfdegree = halfdegree;
+pjob->order = manyjob; pjob->bytes = footprint(pjob);
+pjob->worker = -1; pjob->tqueue = since();
+manyjob++;
+return 0;
+}
+/* ************************************************************************//**
+@brief  Order of runs by estimated footprint, largest first, for qsort().
+*//* *************************************************************************/
+static int
+ bysize(const void *pa, const void *pb)
+{
+const struct job *pja = (const struct job *)pa;
+const struct job *pjb = (const struct job *)pb;
+
+if (pja->bytes != pjb->bytes) return (pja->bytes < pjb->bytes) ? 1 : -1;
+return (pja->order > pjb->order) - (pja->order < pjb->order);
+}
+/* ************************************************************************//**
+@brief  Run every job of the queue not yet run, at most  manyworker  at a
+        time.
+
+With more than one worker, or a memory budget, the runs go largest first, so
+that the longest runs do not straggle at the end of the agenda.  A run starts
+only when the estimated footprints of all the runs under way, with its own,
+fit within the budget; the largest run that fits is taken, and a run larger
+than the whole budget starts only with nothing else under way.  Each estimate
+is scaled by the largest ratio yet seen of measured peak resident set to
+estimate, so the model corrects itself as the agenda proceeds.
+
+@param  manyworker  The number of runs at once.
+@param  budget      The memory budget in bytes, or zero for none.
+@param  ptracefnm   Base of the names of the traces asked of cov, or NULL.
+@return             Zero unless error.
+*//* *************************************************************************/
+static int
+ runall(int manyworker, double budget, const char *ptracefnm)
+{
+struct job *pjob;
+struct rusage usage;
+pid_t *pbusy, pid;
+char cmd[4200];
+const char *p1;
+size_t sz;
+double inuse, need;
+int manyleft, manyrun, status, k, n, rc;
+
+if (NULL == (pbusy = (pid_t *)calloc(manyworker, sizeof(pid_t))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 0, manyleft = 0; n < manyjob; n++)
+  {
+  if (0 > (pjob0 + n)->worker) manyleft++;
+  }
+if ((1 < manyworker) || (0. < budget))
+  {
+  qsort(pjob0 + manyjob - manyleft, manyleft, sizeof(struct job), bysize);
+  }
+rc = 0; manyrun = 0; inuse = 0.;
+while (manyleft || manyrun)
+  {
+/*-----------------------------------------------------------------------------
+START THE LARGEST WAITING RUN THAT FITS, IN ANY IDLE SLOT
+-----------------------------------------------------------------------------*/
+  pjob = NULL;
+  if (manyleft && (manyrun < manyworker))
+    {
+    for (n = 0; n < manyjob; n++)
+      {
+      if ((pjob0 + n)->worker >= 0) continue;
+      need = scale * (pjob0 + n)->bytes;
+      if ((0. >= budget) || ( ! manyrun) || (inuse + need <= budget))
+        {
+        pjob = pjob0 + n; break;
+        }
+      }
+    }
+  if (pjob)
+    {
+    for (k = 0; pbusy[k]; k++) {;}
+    n = (int)(pjob - pjob0);
+    if ((0. < budget) && (scale * pjob->bytes > budget))
+      {
+      fprintf(stderr, "WORRY: %s may need %.0f MB, over the budget\n", \
+                                       pjob->pname, scale * pjob->bytes / 1.e6);
+      }
+    for (p1 = pjob->pname; *p1; p1 += ('\n' == *p1))
+      {
+      sz = strcspn(p1, "\n");
+      fprintf(stdout, "   %.*s\n", (int)sz, p1); p1 += sz;
+      }
+    fflush(stdout);
+    if (ptracefnm && pjob->timed) snprintf(cmd, sizeof(cmd), \
+                 "./cov -t %s.%i %s", ptracefnm, pjob->order, pjob->pcmd);
+    else snprintf(cmd, sizeof(cmd), "./cov %s", pjob->pcmd);
+    if (0 > (pid = fork()))
+      {
+      fprintf(stderr, "ERROR: cannot fork\n"); rc = -1; break;
+      }
+    if ( ! pid)
+      {
+      execl("/bin/sh", "sh", "-c", cmd, (char *)NULL);
+      _exit(127);
+      }
+    pjob->pid = pid; pjob->worker = k; pjob->tstart = since();
+    pjob->charge = scale * pjob->bytes; inuse += pjob->charge;
+    pbusy[k] = pid;
+    manyrun++; manyleft--;
+    continue;
+    }
+/*-----------------------------------------------------------------------------
+OTHERWISE WAIT FOR ANY RUN TO END, AND LEARN FROM ITS PEAK RESIDENT SET
+-----------------------------------------------------------------------------*/
+  if (0 > (pid = wait4(-1, &status, 0, &usage)))
+    {
+    if (EINTR == errno) continue;
+    fprintf(stderr, "ERROR: lost track of running jobs\n"); rc = -1; break;
+    }
+  for (k = 0; (k < manyworker) && (pbusy[k] != pid); k++) {;}
+  if (k == manyworker) continue;
+  pbusy[k] = 0; manyrun--;
+  for (pjob = pjob0; pjob->pid != pid; pjob++) {;}
+  pjob->tend = since(); pjob->pid = 0;
+  inuse -= pjob->charge;
+  pjob->peak = 1024. * (double)usage.ru_maxrss;
+  if (pjob->peak > scale * pjob->bytes) scale = pjob->peak / pjob->bytes;
+  pjob->rc = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  if (pjob->rc)
+    {
+    fprintf(stderr, "ERROR: run returned %i\n", pjob->rc);
+    fprintf(stderr, "       Command was:\n./cov %s\n", pjob->pcmd);
+    }
+  }
+while (0 < manyrun) { if (0 < wait(NULL)) manyrun--; else break; }
+free(pbusy);
+return rc;
+}
+/* ************************************************************************//**
+@brief  Write a string within the quotes of a JSON string.
+*//* *************************************************************************/
+static void
+ jsonstr(FILE *pf, const char *p1)
+{
+for (; *p1; p1++)
+  {
+  if (('"' == *p1) || ('\\' == *p1)) fputc('\\', pf);
+  if ('\n' == *p1) fputs("\\n", pf);
+  else if (' ' <= *p1) fputc(*p1, pf);
+  }
+}
+/* ************************************************************************//**
+@brief  Write the timeline of the runs in Chrome trace-event format.
+
+Each worker is a thread of the trace, and each run a complete event on it,
+divided into the construction of the network and the epidemic as timed by
+cov -t; the wait of each run in the queue is an asynchronous event.  The
+traces written by cov are read, then removed.
+
+@param  ptracefnm   The file to write, also the base of the names of the
+                    traces written by cov.
+@param  manyworker  The number of workers.
+@return             Zero unless error.
+*//* *************************************************************************/
+static int
+ writetrace(const char *ptracefnm, int manyworker)
+{
+FILE *pf, *pfcov;
+struct job *pjob;
+char fnm[1100], bf[1024], *p1;
+double t, build, other, value;
+int n, k;
+
+if (NULL == (pf = fopen(ptracefnm, "w")))
+  {
+  fprintf(stderr, "ERROR: cannot open trace file: %s\n", ptracefnm);
+  return -16;
+  }
+fprintf(pf, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+fprintf(pf, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, " \
+            "\"args\": {\"name\": \"demo\"}}");
+for (k = 0; k < manyworker; k++)
+  {
+  fprintf(pf, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, " \
+              "\"tid\": %i, \"args\": {\"name\": \"worker %i\"}}", k, k);
+  }
+for (n = 0; n < manyjob; n++)
+  {
+  pjob = pjob0 + n;
+  if (0 > pjob->worker) continue;
+  fprintf(pf, ",\n{\"name\": \"queued\", \"cat\": \"queue\", \"ph\": \"b\", " \
+              "\"id\": %i, \"pid\": 1, \"tid\": %i, \"ts\": %.0f}", \
+                               pjob->order, pjob->worker, 1.e6 * pjob->tqueue);
+  fprintf(pf, ",\n{\"name\": \"queued\", \"cat\": \"queue\", \"ph\": \"e\", " \
+              "\"id\": %i, \"pid\": 1, \"tid\": %i, \"ts\": %.0f}", \
+                               pjob->order, pjob->worker, 1.e6 * pjob->tstart);
+  fprintf(pf, ",\n{\"name\": \"");
+  jsonstr(pf, pjob->pname);
+  fprintf(pf, "\", \"cat\": \"run\", \"ph\": \"X\", " \
+              "\"pid\": 1, \"tid\": %i, \"ts\": %.0f, \"dur\": %.0f, " \
+              "\"args\": {\"command\": \"./cov ", pjob->worker, \
+              1.e6 * pjob->tstart, 1.e6 * (pjob->tend - pjob->tstart));
+  jsonstr(pf, pjob->pcmd);
+  fprintf(pf, "\", \"exit\": %i, \"queue_wait_us\": %.0f, " \
+              "\"manynode\": %i, \"estimate_mb\": %.1f, " \
+              "\"peak_rss_mb\": %.1f}}", pjob->rc, \
+              1.e6 * (pjob->tstart - pjob->tqueue), pjob->manynode, \
+              pjob->bytes / 1.e6, pjob->peak / 1.e6);
+/*-----------------------------------------------------------------------------
+THE PHASES OF EACH NETWORK OF THE RUN, LAID END TO END FROM ITS START
+-----------------------------------------------------------------------------*/
+  snprintf(fnm, sizeof(fnm), "%s.%i", ptracefnm, pjob->order);
+  if (NULL == (pfcov = fopen(fnm, "r"))) continue;
+  t = pjob->tstart;
+  while (NULL != fgets(bf, sizeof(bf), pfcov))
+    {
+    if (memcmp(bf, "# seconds", 9)) continue;
+    build = 0.; other = 0.; p1 = bf + 9;
+    while (1)
+      {
+      while (' ' == *p1) { p1++; }
+      if (( ! *p1) || ('\n' == *p1)) break;
+      k = ! memcmp(p1, "build ", 6);
+      while (*p1 && (' ' != *p1)) { p1++; }
+      value = strtod(p1, &p1);
+      if (k) build += value; else other += value;
+      }
+    fprintf(pf, ",\n{\"name\": \"build\", \"cat\": \"phase\", \"ph\": \"X\", " \
+                "\"pid\": 1, \"tid\": %i, \"ts\": %.0f, \"dur\": %.0f}", \
+                                  pjob->worker, 1.e6 * t, 1.e6 * build);
+    t += build;
+    fprintf(pf, ",\n{\"name\": \"simulate\", \"cat\": \"phase\", " \
+                "\"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": %.0f, " \
+                "\"dur\": %.0f}", pjob->worker, 1.e6 * t, 1.e6 * other);
+    t += other;
+    }
+  fclose(pfcov);
+  remove(fnm);
+  }
+fprintf(pf, "\n]}\n");
+fclose(pf);
+fprintf(stdout, "Trace of %i runs on %i workers in %s\n", manyjob, \
+                                                      manyworker, ptracefnm);
+return 0;
+}
+
+/** Names of the fields of an agenda line, as directives give them */
+static const char *fieldname[9] = {"seedcov", "seedswn", "manynode", \
+                "halfdegree", "beta", "chance", "inert", "incubation", \
+                                                                 "recovery"};
+
+/** Steps in which cov names beta, chance and inert in its file names */
+static const double namestep[3] = {0.001, 0.01, 0.01};
+
+/* ************************************************************************//**
+@brief  A seed of an agenda line without any leading 0x, as in file names.
+*//* *************************************************************************/
+static const char *
+ bare(const char *p1)
+{
+if (( ! memcmp("0x",p1,2)) || ( ! memcmp("0X",p1,2))) p1 += 2;
+return p1;
+}
+/* ************************************************************************//**
+@brief  Name and queue one run of cov for a line of the agenda.
+@param  pw      The line of the agenda.
+@param  plabel  Label of the run, for cov -n, or NULL.
+@return         The position of the run in the agenda (its .order), or
+                negative if error.
+@note   The other parameters are the values of the fields for this run.
+*//* *************************************************************************/
+static int
+ plan(const struct w *pw, int manynode, int halfdegree, double beta, \
+                double chance, double inert, int incubation, int recovery, \
+                                                          const char *plabel)
+{
+char cmd[4096], tail[1100], betacmd[100], opts[140], *pname;
+const char *p1, *p2;
+double step, b;
+size_t sz, room;
+int k, many, rc;
+
+p1 = bare(pw->a[0][0]); p2 = bare(pw->a[1][0]);
+if (pw->coupled) snprintf(betacmd, 100, "%s:%s:%s", \
+                             pw->a[4][0], pw->a[4][1], pw->a[4][2]);
+else             snprintf(betacmd, 100, "%.6g", beta);
+snprintf(opts, 100, "%s", pw->common ? "-c " : "");
+sz = strlen(opts);
+if (pw->replicates) snprintf(opts + sz, 100 - sz, "-r %i %s%s ", \
+                 pw->replicates, pw->width[0] ? "-e " : "", pw->width);
+sz = strlen(opts);
+if (plabel) snprintf(opts + sz, 140 - sz, "-n %s ", plabel);
+/*-----------------------------------------------------------------------------
+NAME THE OUTPUT AS COV DOES: EVERYTHING AFTER BETA IS THE SAME FOR EACH BETA
+OF A COUPLED SERIES, WHOSE FILES ARE LISTED ONE A LINE
+-----------------------------------------------------------------------------*/
+snprintf(tail, sizeof(tail), "-%4.2f-%4.2f-%i-%i%s%s", chance, inert, \
+                 incubation, recovery, pw->common ? "-c" : "", \
+                                           pw->coupled ? "-coupled" : "");
+if (pw->replicates)
+  {
+  sz = strlen(tail);
+  snprintf(tail + sz, sizeof(tail) - sz, "-r%i", pw->replicates);
+  }
+sz = strlen(tail);
+if (plabel) snprintf(tail + sz, sizeof(tail) - sz, "-%s", plabel);
+step = pw->d[4][1];
+if (0.0000001 > fabs(step)) step = 1.e8;
+for (many = 1; pw->coupled && \
+               (pw->d[4][0] + many * step <= pw->d[4][2] + 1.e-9); many++) {;}
+room = many * (strlen(pw->outdir) + strlen(p1) + strlen(p2) + \
+                                                      strlen(tail) + 64);
+if (NULL == (pname = (char *)malloc(room)))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (k = 0, sz = 0; k < many; k++)
+  {
+  b = pw->coupled ? pw->d[4][0] + k * step : beta;
+  sz += snprintf(pname + sz, room - sz, "%s%s/%s%s-%i-%i-%5.3f%s", \
+                   k ? "\n" : "", pw->outdir, p1, p2, manynode, halfdegree, \
+                                                                   b, tail);
+  }
+snprintf(cmd, 4090, "%s%s %s %i %i %s %.6g %.6g %i %i %s", \
+                      opts, pw->a[0][0], pw->a[1][0], manynode, halfdegree, \
+              betacmd, chance, inert, incubation, recovery, pw->outdir);
+rc = enqueue(cmd, pname, manynode, halfdegree);
+free(pname);
+if (0 > rc) return rc;
+(pjob0 + manyjob - 1)->timed = ! pw->replicates;
+return manyjob - 1;
+}
+/* ************************************************************************//**
+@brief  Find a run by its position in the agenda.
+*//* *************************************************************************/
+static struct job *
+ jobof(int order)
+{
+int n;
+
+for (n = 0; n < manyjob; n++)
+  {
+  if (order == (pjob0 + n)->order) return pjob0 + n;
+  }
+return NULL;
+}
+/* ************************************************************************//**
+@brief  Decide whether a finished run was an outbreak: whether the infected
+        fraction on its last day, the median over the replicates if it has
+        them, reached a level.
+@param  pjob    The run.
+@param  level   The level.
+@param  pup     Set non-zero if it was an outbreak.
+@return         Zero unless error.
+*//* *************************************************************************/
+static int
+ outbreak(const struct job *pjob, double level, int *pup)
+{
+FILE *pf;
+char bf[1024], last[1024], *p1;
+int column, k;
+
+if (pjob->rc || (NULL == (pf = fopen(pjob->pname, "r"))))
+  {
+  fprintf(stderr, "ERROR: no output from run: %s\n", pjob->pname); return -16;
+  }
+column = -1; last[0] = 0;
+if (NULL != fgets(bf, sizeof(bf), pf))
+  {
+  for (k = 0, p1 = strtok(bf, " \t\n"); p1; k++, p1 = strtok(NULL, " \t\n"))
+    {
+    if ( ! strcmp("Median", p1)) column = k;
+    if (( ! strcmp("Infected", p1)) && (0 > column)) column = k;
+    }
+  }
+while (NULL != fgets(bf, sizeof(bf), pf)) { strcpy(last, bf); }
+fclose(pf);
+for (k = 0, p1 = strtok(last, " \t\n"); p1 && (k < column); k++)
+  {
+  p1 = strtok(NULL, " \t\n");
+  }
+if ((0 > column) || (NULL == p1))
+  {
+  fprintf(stderr, "ERROR: cannot read final size from %s\n", pjob->pname);
+  return -1;
+  }
+*pup = (level <= strtod(p1, NULL));
+return 0;
+}
+/* ************************************************************************//**
+@brief  Add a curve of a threshold search, its searched field ranging over
+        min:increment:max of the line, and its other fields given.
+@return Zero unless error.
+*//* *************************************************************************/
+static int
+ addcurve(const struct w *pw, int manynode, int halfdegree, double beta, \
+                double chance, double inert, int incubation, int recovery)
+{
+struct curve *pc;
+void *pnew;
+
+if (NULL == (pnew = realloc(pcurve0, (manycurve + 1) * sizeof(struct curve))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+pcurve0 = (struct curve *)pnew;
+pc = pcurve0 + manycurve++;
+memset(pc, 0, sizeof(struct curve));
+pc->w = *pw;
+pc->manynode = manynode; pc->halfdegree = halfdegree; pc->beta = beta;
+pc->chance = chance; pc->inert = inert;
+pc->incubation = incubation; pc->recovery = recovery;
+pc->lo = pw->d[pw->search][0]; pc->hi = pw->top;
+pc->joblo = -1; pc->jobhi = -1; pc->jobmid = -1;
+return 0;
+}
+/* ************************************************************************//**
+@brief  Queue a run of a curve with its searched field set to a value.
+@return The position of the run in the agenda, or negative if error.
+*//* *************************************************************************/
+static int
+ probe(struct curve *pc, double value)
+{
+double v[9];
+
+v[4] = pc->beta; v[5] = pc->chance; v[6] = pc->inert;
+v[pc->w.search] = value;
+pc->probes++;
+return plan(&pc->w, pc->manynode, pc->halfdegree, v[4], v[5], v[6], \
+                                         pc->incubation, pc->recovery, NULL);
+}
+/* ************************************************************************//**
+@brief  Report the bracket of the threshold of a finished curve on stdout
+        and in a file named as its runs are, with the searched field shown
+        as T and ending in -threshold.
+*//* *************************************************************************/
+static void
+ report(const struct curve *pc)
+{
+FILE *pf;
+char name[2048], field[3][100];
+const char *p1, *p2;
+int k;
+
+p1 = bare(pc->w.a[0][0]); p2 = bare(pc->w.a[1][0]);
+snprintf(field[0], 100, "%5.3f", pc->beta);
+snprintf(field[1], 100, "%4.2f", pc->chance);
+snprintf(field[2], 100, "%4.2f", pc->inert);
+strcpy(field[pc->w.search - 4], "T");
+snprintf(name, sizeof(name), "%s/%s%s-%i-%i-%s-%s-%s-%i-%i%s-threshold", \
+       pc->w.outdir, p1, p2, pc->manynode, pc->halfdegree, field[0], \
+       field[1], field[2], pc->incubation, pc->recovery, \
+       pc->w.common ? "-c" : "");
+k = (pc->uplo != pc->uphi);
+fprintf(stdout, "=> %s: %s %s %.6g to %.6g, %i runs\n", name, \
+        fieldname[pc->w.search], k ? "threshold" : "no threshold within", \
+                                                pc->lo, pc->hi, pc->probes);
+if (NULL == (pf = fopen(name, "w")))
+  {
+  fprintf(stderr, "WORRY: cannot open output file: %s\n", name); return;
+  }
+fprintf(pf, "Field     Low      High  Level  Runs  Outbreak at low, high\n");
+fprintf(pf, "%-6s  %.6g  %.6g  %4.2f  %4i  %i %i\n", fieldname[pc->w.search], \
+               pc->lo, pc->hi, pc->w.level, pc->probes, pc->uplo, pc->uphi);
+fclose(pf);
+}
+/* ************************************************************************//**
+@brief  Carry out every threshold search, by bisection.
+
+Each curve first runs both ends of its range; if one is an outbreak and the
+other not, the middle of the bracket is run and replaces the end which it
+matches, until the bracket is no wider than the increment of the line.  It
+stops too at two steps of the name cov gives the field (0.001 for beta, 0.01
+for chance and inert), as any narrower and the middle might share its name,
+and so its output file, with an end.  The runs of all the curves still
+searching go to the pool together, so each round costs about as long as its
+longest run.
+
+@return Zero unless error.
+*//* *************************************************************************/
+static int
+ search(int manyworker, double budget, const char *ptracefnm)
+{
+struct curve *pc;
+int n, up, left, rc;
+
+for (n = 0; n < manycurve; n++)
+  {
+  pc = pcurve0 + n;
+  if ((0 > (pc->joblo = probe(pc, pc->lo))) || \
+      (0 > (pc->jobhi = probe(pc, pc->hi)))) return -8;
+  }
+left = manycurve;
+while (left)
+  {
+  if (0 > (rc = runall(manyworker, budget, ptracefnm))) return rc;
+  for (n = 0, left = 0; n < manycurve; n++)
+    {
+    pc = pcurve0 + n;
+    if (pc->done) continue;
+    if (0 <= pc->joblo)
+      {
+      if ((0 > (rc = outbreak(jobof(pc->joblo), pc->w.level, &pc->uplo))) || \
+          (0 > (rc = outbreak(jobof(pc->jobhi), pc->w.level, &pc->uphi))))
+        {
+        return rc;
+        }
+      pc->joblo = -1; pc->jobhi = -1;
+      }
+    if (0 <= pc->jobmid)
+      {
+      if (0 > (rc = outbreak(jobof(pc->jobmid), pc->w.level, &up))) return rc;
+      if (up == pc->uplo) pc->lo = pc->mid; else pc->hi = pc->mid;
+      pc->jobmid = -1;
+      }
+    if ((pc->uplo == pc->uphi) || \
+        (pc->hi - pc->lo <= pc->w.d[pc->w.search][1] * (1. + 1.e-9)) || \
+        (pc->hi - pc->lo <= 2. * namestep[pc->w.search - 4] * (1. + 1.e-9)))
+      {
+      pc->done = 1; report(pc); continue;
+      }
+    pc->mid = 0.5 * (pc->lo + pc->hi);
+    if (0 > (pc->jobmid = probe(pc, pc->mid))) return -8;
+    left++;
+    }
+  }
+return 0;
+}
+/** Primitive polynomials (degree, coefficients) and initial direction
+    numbers of Sobol dimensions 2 to 7, from Joe and Kuo (2008) */
+static const int sobolpoly[6][2] = {{1, 0}, {2, 1}, {3, 1}, {3, 2}, \
+                                                            {4, 1}, {4, 4}};
+static const unsigned int sobolm[6][4] = {{1}, {1, 3}, {1, 3, 1}, \
+                                      {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}};
+
+/* ************************************************************************//**
+@brief  Fill the 32 direction numbers of one dimension of the Sobol sequence,
+        counting the first dimension (the van der Corput sequence) as 0.
+*//* *************************************************************************/
+static void
+ sobolinit(int dim, uint32_t *pv)
+{
+int b, k, deg, a;
+
+if ( ! dim)
+  {
+  for (b = 0; b < 32; b++) { pv[b] = 1U << (31 - b); }
+  return;
+  }
+deg = sobolpoly[dim - 1][0]; a = sobolpoly[dim - 1][1];
+for (b = 0; b < 32; b++)
+  {
+  if (b < deg) { pv[b] = sobolm[dim - 1][b] << (31 - b); continue; }
+  pv[b] = pv[b - deg] ^ (pv[b - deg] >> deg);
+  for (k = 1; k < deg; k++)
+    {
+    if ((a >> (deg - 1 - k)) & 1) pv[b] ^= pv[b - k];
+    }
+  }
+}
+/* ************************************************************************//**
+@brief  Queue the runs of a space-filling design over the ranges of a line:
+        manypoint points of a Latin hypercube or of the Sobol sequence, each
+        field whose min is below its max being one dimension.
+
+Each point of a Latin hypercube falls in its own stratum of each field, the
+strata being paired at random (from the seeds of the line) and the point
+placed at random within them; the Sobol points are the first manypoint of the
+sequence, in Gray-code order.  A field under  @log=  is spread evenly in its
+logarithm, and integer fields are rounded down, each integer having an equal
+share of the range.  Should recovery fall at or below incubation, it is
+raised to one more.  The runs are labelled lhsL-N or sobolL-N (cov -n), L
+being the line of the agenda and N the point, and the points listed in a
+file named as the runs are, up to the seeds, ending in -lhsL or -sobolL; so
+lines with the same seeds do not overwrite each other.
+
+@param  pw    The line of the agenda.
+@param  line  Its number.
+@return Zero unless error.
+*//* *************************************************************************/
+static int
+ design(const struct w *pw, int line)
+{
+FILE *pf;
+char name[2048], label[32];
+const char *pkind;
+uint32_t direction[7][32], x[7];
+uint64_t state;
+double u, lo, hi, v[9];
+int *pperm, dim[7], manydim, isint, i, k, n, swap, rc;
+
+pkind = (1 == pw->design) ? "lhs" : "sobol";
+for (k = 2, manydim = 0; k < 9; k++)
+  {
+  isint = (2 == k) || (3 == k) || (7 <= k);
+  if (isint ? (pw->j[k][0] < pw->j[k][2]) : (pw->d[k][0] < pw->d[k][2]))
+    {
+    dim[manydim++] = k;
+    }
+  }
+if (NULL == (pperm = (int *)malloc((manydim + 1) * pw->manypoint * \
+                                                               sizeof(int))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+/*-----------------------------------------------------------------------------
+THE PAIRING OF THE STRATA OF A LATIN HYPERCUBE, ONE PERMUTATION PER DIMENSION
+-----------------------------------------------------------------------------*/
+state = rngstream(strtoull(pw->a[0][0], NULL, 16), \
+                                         strtoull(pw->a[1][0], NULL, 16));
+for (k = 0; k < manydim; k++)
+  {
+  for (i = 0; i < pw->manypoint; i++) { pperm[k * pw->manypoint + i] = i; }
+  for (i = pw->manypoint - 1; i > 0; i--)
+    {
+    n = (int)rngbelow(&state, i + 1);
+    swap = pperm[k * pw->manypoint + i];
+    pperm[k * pw->manypoint + i] = pperm[k * pw->manypoint + n];
+    pperm[k * pw->manypoint + n] = swap;
+    }
+  sobolinit(k, direction[k]); x[k] = 0;
+  }
+snprintf(name, sizeof(name), "%s/%s%s-%s%i", pw->outdir, bare(pw->a[0][0]), \
+                                             bare(pw->a[1][0]), pkind, line);
+if (NULL == (pf = fopen(name, "w")))
+  {
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", name);
+  free(pperm); return -16;
+  }
+fprintf(pf, "Point  manynode halfdegree     beta   chance    inert " \
+                                                  "incubation recovery\n");
+rc = 0;
+for (i = 0; i < pw->manypoint; i++)
+  {
+  for (k = 2; k < 9; k++) { v[k] = pw->j[k][0]; }
+  v[4] = pw->d[4][0]; v[5] = pw->d[5][0]; v[6] = pw->d[6][0];
+  for (k = 0; k < manydim; k++)
+    {
+/*-----------------------------------------------------------------------------
+A POINT OF THE UNIT CUBE, MAPPED ONTO THE RANGE OF EACH FIELD
+-----------------------------------------------------------------------------*/
+    if (1 == pw->design)
+      {
+      u = (pperm[k * pw->manypoint + i] + \
+           (double)(rngnext(&state) >> 11) / 9007199254740992.) / pw->manypoint;
+      }
+    else
+      {
+      if (i) x[k] ^= direction[k][__builtin_ctz((unsigned int)i)];
+      u = (double)x[k] / 4294967296.;
+      }
+    n = dim[k];
+    isint = (2 == n) || (3 == n) || (7 <= n);
+    lo = isint ? pw->j[n][0] : pw->d[n][0];
+    hi = isint ? pw->j[n][2] + 1. : pw->d[n][2];
+    if (pw->logscale[n]) v[n] = exp(log(lo) + u * (log(hi) - log(lo)));
+    else                 v[n] = lo + u * (hi - lo);
+    if (isint) v[n] = floor(v[n]);
+    if (isint && (v[n] > pw->j[n][2])) v[n] = pw->j[n][2];
+    }
+  if (v[8] <= v[7]) v[8] = v[7] + 1.;
+  fprintf(pf, "%5i %9.0f %10.0f %8.6f %8.6f %8.6f %10.0f %8.0f\n", i, \
+                              v[2], v[3], v[4], v[5], v[6], v[7], v[8]);
+  snprintf(label, sizeof(label), "%s%i-%i", pkind, line, i);
+  if (0 > (rc = plan(pw, (int)v[2], (int)v[3], v[4], v[5], v[6], \
+                                           (int)v[7], (int)v[8], label))) break;
+  }
+fclose(pf);
+free(pperm);
+fprintf(stdout, "Design of %i points in %s\n", pw->manypoint, name);
+return (0 > rc) ? rc : 0;
+}
 /* ************************************************************************//**
 @brief Main program: demo
 
-USAGE: ./demo full_path_to_agenda_file
+USAGE: ./demo  [-j workers]  [-m budget]  [-t trace.json] \
+              full_path_to_agenda_file
 *//* *************************************************************************/
 int
  main(int argc, char *argv[])
 {
 FILE *pFILE;
 struct stat stat0;
-char infnm[1024], cmd[4096], bf[1024], *p1, *p2;
+char infnm[1024], bf[1024], *p1, *p2;
+char *ptracefnm, *pend, hold;
 size_t sz;
 int jack, line, kase, katch, latch[3], n, rc;
 int manynode, halfdegree, incubation, recovery;
-double beta, chance, inert;
+int manyworker;
+double beta, chance, inert, budget;
 
+manyworker = 1; ptracefnm = NULL; budget = 0.;
+while (-1 != (n = getopt(argc, argv, "+j:m:t:")))
+  {
+  switch (n)
+    {
+    case 'j':
+      errno = 0; manyworker = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manyworker)) { USAGE; return -1; }
+      break;
+    case 'm':
+      if ( ! strcmp("auto", optarg))
+        {
+        budget = 0.8 * (double)sysconf(_SC_PHYS_PAGES) * \
+                                              (double)sysconf(_SC_PAGESIZE);
+        break;
+        }
+      errno = 0; budget = strtod(optarg, &p1);
+      if      (('K' == *p1) || ('k' == *p1)) { budget *= 1.e3; p1++; }
+      else if (('M' == *p1) || ('m' == *p1)) { budget *= 1.e6; p1++; }
+      else if (('G' == *p1) || ('g' == *p1)) { budget *= 1.e9; p1++; }
+      if (errno || *p1 || (0. >= budget)) { USAGE; return -1; }
+      break;
+    case 't': ptracefnm = optarg; break;
+    default : USAGE; return -1;
+    }
+  }
+argc -= optind - 1; argv += optind - 1;
 katch = 0; if (2 != argc) katch = 1;
 if ( ! katch) { if (NULL == argv[1]) katch = 1; }
 if ( ! katch) { if (stat(argv[1], &stat0)) katch = 1; }
-if (katch)
-  {
-  fprintf(stderr, "USAGE: ./demo full_path_to_agenda_file\n"); return -1;
-  }
+if (katch) { USAGE; return -1; }
+tzero = since();
 katch = 0;
 if ('/' != *(argv[1]))
   {
@@ -104,6 +935,87 @@ while (NULL != fgets(bf, 1020, pFILE))
   while ((bf < p1) && (isspace(*(p1 - 1)))) { p1--; } *p1 = 0;
   memset(&w, 0, sizeof(struct w));
   p1 = bf; kase = 0; katch = 0; jack = 0;
+/*-----------------------------------------------------------------------------
+DIRECTIVES, EACH BEGINNING WITH  @, MAY PRECEDE THE FIELDS OF A LINE
+-----------------------------------------------------------------------------*/
+  while (1)
+    {
+    while (isspace(*p1)) { p1++; }
+    if ('@' != *p1) break;
+    p2 = p1; while (*p2 && ( ! isspace(*p2))) { p2++; }
+    hold = *p2; *p2 = 0;
+    if ( ! strcmp("@coupled", p1)) w.coupled = 1;
+    else if ( ! strcmp("@common", p1)) w.common = 1;
+    else if ( ! memcmp("@replicates=", p1, 12))
+      {
+      errno = 0; w.replicates = (int)strtol(p1 + 12, &pend, 10);
+      if (errno || *pend || (1 > w.replicates))
+        {
+        fprintf(stderr, "ERROR: at line %i, bad %s\n", line, p1); return -1;
+        }
+      }
+    else if ( ! memcmp("@search=", p1, 8))
+      {
+      for (n = 4; n < 7; n++)
+        {
+        sz = strlen(fieldname[n]);
+        if (( ! memcmp(fieldname[n], p1 + 8, sz)) && \
+            (( ! p1[8 + sz]) || (',' == p1[8 + sz]))) break;
+        }
+      w.search = n; w.level = 0.1; pend = p1 + 8 + sz;
+      if ((7 > n) && (',' == *pend))
+        {
+        errno = 0; w.level = strtod(pend + 1, &pend);
+        if (errno || (0. >= w.level) || (1. < w.level)) n = 7;
+        }
+      if ((7 <= n) || *pend)
+        {
+        fprintf(stderr, "ERROR: at line %i, bad %s\n", line, p1); return -1;
+        }
+      }
+    else if (( ! memcmp("@lhs=", p1, 5)) || ( ! memcmp("@sobol=", p1, 7)))
+      {
+      w.design = ('l' == p1[1]) ? 1 : 2;
+      errno = 0; w.manypoint = (int)strtol(strchr(p1, '=') + 1, &pend, 10);
+      if (errno || *pend || (1 > w.manypoint))
+        {
+        fprintf(stderr, "ERROR: at line %i, bad %s\n", line, p1); return -1;
+        }
+      }
+    else if ( ! memcmp("@log=", p1, 5))
+      {
+      for (pend = p1 + 5; *pend; pend += sz + (',' == pend[sz]))
+        {
+        for (n = 2, sz = 0; n < 9; n++)
+          {
+          sz = strlen(fieldname[n]);
+          if (( ! memcmp(fieldname[n], pend, sz)) && \
+              (( ! pend[sz]) || (',' == pend[sz]))) break;
+          }
+        if (9 == n)
+          {
+          fprintf(stderr, "ERROR: at line %i, bad %s\n", line, p1); return -1;
+          }
+        w.logscale[n] = 1;
+        }
+      }
+    else if (( ! memcmp("@width=", p1, 7)) && (32 > strlen(p1 + 7)) && \
+                                      (0. < strtod(p1 + 7, NULL)))
+      {
+      strcpy(w.width, p1 + 7);
+      }
+    else
+      {
+      fprintf(stderr, "ERROR: at line %i, unknown directive %s\n", line, p1);
+      return -1;
+      }
+    *p2 = hold; p1 = p2;
+    }
+  if (w.width[0] && ( ! w.replicates))
+    {
+    fprintf(stderr, "ERROR: at line %i, @width needs @replicates\n", line);
+    return -1;
+    }
   while (*p1)
     {
     while (isspace(*p1)) { p1++; }
@@ -273,6 +1185,41 @@ while (NULL != fgets(bf, 1020, pFILE))
     fprintf(stderr, "ERROR: line %i has too few fields: ignored\n",line);
     continue;
     }
+  if (w.search)
+    {
+    if (1.e7 < w.d[w.search][1])
+      {
+      fprintf(stderr, "ERROR: at line %i, @search needs an increment\n", line);
+      return -1;
+      }
+    if (w.coupled && (4 == w.search))
+      {
+      fprintf(stderr, "ERROR: at line %i, @search=beta with @coupled\n", line);
+      return -1;
+      }
+    w.top = w.d[w.search][2]; w.d[w.search][2] = w.d[w.search][0];
+    }
+  if (w.design)
+    {
+    if (w.coupled || w.search)
+      {
+      fprintf(stderr, "ERROR: at line %i, @lhs or @sobol with @coupled or " \
+                                                     "@search\n", line);
+      return -1;
+      }
+    for (n = 2; n < 9; n++)
+      {
+      if (w.logscale[n] && (((2 == n) || (3 == n) || (7 <= n)) ? \
+                              (1 > w.j[n][0]) : (0. >= w.d[n][0])))
+        {
+        fprintf(stderr, "ERROR: at line %i, @log=%s needs min > 0\n", \
+                                                       line, fieldname[n]);
+        return -1;
+        }
+      }
+    if (0 > (rc = design(&w, line))) return rc;
+    continue;
+    }
 /*-----------------------------------------------------------------------------
 RUN THE PROGRAM REPEATEDLY
 -----------------------------------------------------------------------------*/
@@ -285,7 +1232,7 @@ RUN THE PROGRAM REPEATEDLY
          halfdegree += w.j[3][1])
       {
       for (beta =  w.d[4][0]; \
-           beta <= w.d[4][2]; \
+           beta <= (w.coupled ? w.d[4][0] : w.d[4][2]); \
            beta += w.d[4][1])
         {
         for (chance =  w.d[5][0]; \
@@ -304,25 +1251,11 @@ RUN THE PROGRAM REPEATEDLY
                    recovery <= w.j[8][2]; \
                    recovery += w.j[8][1])
                 {
-                p1 = w.a[0][0];
-                if (( ! memcmp("0x",p1,2)) || ( ! memcmp("0X",p1,2))) p1 += 2;
-                p2 = w.a[1][0];
-                if (( ! memcmp("0x",p2,2)) || ( ! memcmp("0X",p2,2))) p2 += 2;
-                fprintf(stdout,"   %s/%s%s-%i-%i-%5.3f-%4.2f-%4.2f-%i-%i\n", \
-                                w.outdir, p1, p2, \
-                                manynode, halfdegree, beta, \
-                                chance, inert, incubation, recovery);
-                snprintf(cmd, 4090, \
-                         "./cov %s %s %i %i %5.3f %4.2f %4.2f %i %i %s", \
-                                w.a[0][0], w.a[1][0], \
-                                manynode, halfdegree, beta, \
-                                chance, inert, incubation, recovery, \
-                                w.outdir);
-                if (0 != (rc = system(cmd)))
-                  {
-                  fprintf(stderr, "ERROR: system() returned %i\n",rc);
-                  fprintf(stderr, "       Command was:\n%s\n", cmd);
-                  }
+                if (w.search) rc = addcurve(&w, manynode, halfdegree, \
+                           beta, chance, inert, incubation, recovery);
+                else          rc = plan(&w, manynode, halfdegree, \
+                           beta, chance, inert, incubation, recovery, NULL);
+                if (0 > rc) return rc;
                 }
               }
             }
@@ -334,5 +1267,17 @@ RUN THE PROGRAM REPEATEDLY
   }
 if (ferror(pFILE)) { fprintf(stderr, "ERROR: failed to read entire file\n"); }
 if (pFILE) fclose(pFILE); 
+/*-----------------------------------------------------------------------------
+RUN THE AGENDA, WITH ANY THRESHOLD SEARCHES, THEN WRITE ITS TIMELINE
+-----------------------------------------------------------------------------*/
+if (manycurve) rc = search(manyworker, budget, ptracefnm);
+else           rc = runall(manyworker, budget, ptracefnm);
+if (0 > rc) return rc;
+if (ptracefnm && (0 > (rc = writetrace(ptracefnm, manyworker)))) return rc;
+for (n = 0; n < manyjob; n++)
+  {
+  free((pjob0 + n)->pcmd); free((pjob0 + n)->pname);
+  }
+free(pjob0); free(pcurve0);
 return 0;
 }
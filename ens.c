@@ -0,0 +1,221 @@
+/* ************************************************************//** @file ens.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Streaming statistics of an ensemble of epidemics, day by day.
+
+Each day keeps the sums of the numbers infected, of their squares and of the
+contacts, and a fixed histogram of the infected fraction on [0,1], from which
+quantiles are read to within one bin (and never outside the least and
+greatest values seen).  The sums are of whole numbers, held exactly: the
+numbers and contacts while below 2^53, some 10^15, and the squares, which
+pass that at a million nodes and ten thousand replicates, in two 64-bit
+words.  They merge in any order to the same result, so each thread may
+keep its own ensemble, merged once all the replicates are done, no
+trajectory need be kept, and the output does not depend on the number of
+threads.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ens.h"
+
+/* ************************************************************************//**
+@brief   Add to the sum of squares of a day a number of two 64-bit words.
+*//***************************************************************************/
+static void
+ square(struct ensday *pday, uint64_t lo, uint64_t hi)
+{
+pday->sqlo += lo;
+pday->sqhi += hi + (pday->sqlo < lo);
+}
+/* ************************************************************************//**
+@brief   Prepare an empty ensemble.
+@param   pens      The ensemble.
+@param   manyday   The number of days, counting day zero.
+@param   manynode  The number of nodes of the network.
+@param   manystub  The total length of its neighbour lists.
+@return            Zero unless error.
+*//***************************************************************************/
+int
+ ensinit(struct ensemble *pens, int manyday, int manynode, long manystub)
+{
+pens->manyday = manyday;
+pens->manynode = manynode; pens->manystub = manystub;
+if (NULL == \
+    (pens->pday0 = (struct ensday *)calloc(manyday, sizeof(struct ensday))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Add one replicate's counts for one day.
+@param   pens      The ensemble.
+@param   day       The day.
+@param   manycase  The number of nodes ever infected.
+@param   manyedge  The number of links of uninfected nodes.
+*//***************************************************************************/
+void
+ ensadd(struct ensemble *pens, int day, int manycase, long manyedge)
+{
+struct ensday *pday;
+double x;
+int b;
+
+if ((0 > day) || (day >= pens->manyday)) return;
+pday = pens->pday0 + day;
+x = manycase;
+if (( ! pday->many) || (x < pday->lo)) pday->lo = x;
+if (( ! pday->many) || (x > pday->hi)) pday->hi = x;
+pday->many += 1.;
+pday->sum += x;
+square(pday, (uint64_t)manycase * (uint64_t)manycase, 0);
+pday->contacts += (double)manyedge;
+b = (int)(x / pens->manynode * ENS_MANYBIN);
+if (0 > b) b = 0;
+if (ENS_MANYBIN <= b) b = ENS_MANYBIN - 1;
+pday->bin[b]++;
+}
+/* ************************************************************************//**
+@brief   Add the replicates of one ensemble to another.
+@param   pens    The ensemble receiving.
+@param   pother  The ensemble added, of the same network.
+*//***************************************************************************/
+void
+ ensmerge(struct ensemble *pens, const struct ensemble *pother)
+{
+struct ensday *pday;
+const struct ensday *pwas;
+int day, b;
+
+for (day = 0; (day < pens->manyday) && (day < pother->manyday); day++)
+  {
+  pday = pens->pday0 + day; pwas = pother->pday0 + day;
+  if ( ! pwas->many) continue;
+  if (( ! pday->many) || (pwas->lo < pday->lo)) pday->lo = pwas->lo;
+  if (( ! pday->many) || (pwas->hi > pday->hi)) pday->hi = pwas->hi;
+  pday->many += pwas->many;
+  pday->sum += pwas->sum;
+  square(pday, pwas->sqlo, pwas->sqhi);
+  pday->contacts += pwas->contacts;
+  for (b = 0; b < ENS_MANYBIN; b++) { pday->bin[b] += pwas->bin[b]; }
+  }
+}
+/* ************************************************************************//**
+@brief   Empty an ensemble, keeping its memory.
+*//***************************************************************************/
+void
+ ensclear(struct ensemble *pens)
+{
+memset(pens->pday0, 0, pens->manyday * sizeof(struct ensday));
+}
+/* ************************************************************************//**
+@brief   The mean infected fraction on one day.
+*//***************************************************************************/
+double
+ ensmean(const struct ensemble *pens, int day)
+{
+const struct ensday *pday;
+
+pday = pens->pday0 + day;
+return pday->many ? pday->sum / pday->many / pens->manynode : 0.;
+}
+/* ************************************************************************//**
+@brief   The standard deviation over the replicates of the infected fraction
+         on one day.
+*//***************************************************************************/
+double
+ enssd(const struct ensemble *pens, int day)
+{
+const struct ensday *pday;
+double var;
+
+pday = pens->pday0 + day;
+if (2. > pday->many) return 0.;
+var = (ldexp((double)pday->sqhi, 64) + (double)pday->sqlo - \
+                      pday->sum * pday->sum / pday->many) / (pday->many - 1.);
+return (0. < var) ? sqrt(var) / pens->manynode : 0.;
+}
+/* ************************************************************************//**
+@brief   A quantile of the infected fraction on one day, interpolating
+         linearly within the bin in which it falls.
+@param   pens  The ensemble.
+@param   day   The day.
+@param   q     The probability, 0 <= q <= 1.
+@return        The quantile.
+*//***************************************************************************/
+double
+ ensquantile(const struct ensemble *pens, int day, double q)
+{
+const struct ensday *pday;
+double want, below, x;
+int b;
+
+pday = pens->pday0 + day;
+if ( ! pday->many) return 0.;
+want = q * pday->many; below = 0.;
+for (b = 0; b < ENS_MANYBIN - 1; b++)
+  {
+  if (below + pday->bin[b] >= want) break;
+  below += pday->bin[b];
+  }
+x = pday->bin[b] ? (b + (want - below) / pday->bin[b]) / ENS_MANYBIN \
+                 : (double)b / ENS_MANYBIN;
+if (x < pday->lo / pens->manynode) x = pday->lo / pens->manynode;
+if (x > pday->hi / pens->manynode) x = pday->hi / pens->manynode;
+return x;
+}
+/* ************************************************************************//**
+@brief   Write one line per day: the mean infected fraction in the column
+         Infected (as in the output of a single run), its standard deviation
+         and quantiles, and the mean contact fraction.
+*//***************************************************************************/
+void
+ enswrite(FILE *pf, const struct ensemble *pens)
+{
+const struct ensday *pday;
+int day;
+
+fprintf(pf, "Day Infected      SD     Q05     Q25  Median     Q75     Q95" \
+                                                           "  Contacts  Runs\n");
+for (day = 0; day < pens->manyday; day++)
+  {
+  pday = pens->pday0 + day;
+  fprintf(pf, "%3i  %7.4f %7.4f %7.4f %7.4f %7.4f %7.4f %7.4f   %7.4f %5.0f\n", \
+          day, ensmean(pens, day), enssd(pens, day), \
+          ensquantile(pens, day, 0.05), ensquantile(pens, day, 0.25), \
+          ensquantile(pens, day, 0.50), ensquantile(pens, day, 0.75), \
+          ensquantile(pens, day, 0.95), \
+          pday->many ? pday->contacts / pday->many / pens->manystub : 0., \
+          pday->many);
+  }
+}
+/* ************************************************************************//**
+@brief   Release the memory of an ensemble.
+*//***************************************************************************/
+void
+ ensfree(struct ensemble *pens)
+{
+free(pens->pday0); pens->pday0 = NULL; pens->manyday = 0;
+}
+/* ***************************************************************************/
@@ -0,0 +1,66 @@
+/* ************************************************************//** @file ens.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the ensemble statistics functions.
+*//* *************************************************************************/
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define ENS_MANYBIN (1024)    /**< Bins of the histogram of each day on [0,1] */
+
+/** Statistics of one day over the replicates seen so far */
+struct ensday
+  {
+  double        many;         /**< Number of replicates                      */
+  double        sum;          /**< Sum of the numbers infected               */
+  uint64_t      sqlo;         /**< Sum of their squares, low 64 bits         */
+  uint64_t      sqhi;         /**< The same, high 64 bits                    */
+  double        contacts;     /**< Sum of the numbers of contacts            */
+  double        lo;           /**< Least number infected                     */
+  double        hi;           /**< Greatest number infected                  */
+  unsigned int  bin[ENS_MANYBIN]; /**< Histogram of the infected fraction    */
+  };
+
+/** Statistics of every day of an ensemble of epidemics */
+struct ensemble
+  {
+  int            manyday;     /**< Days, counting day zero                   */
+  double         manynode;    /**< Nodes, by which infections are divided    */
+  double         manystub;    /**< Stubs, by which contacts are divided      */
+  struct ensday *pday0;       /**< One entry per day                         */
+  };
+
+int    ensinit(struct ensemble *, int, int, long);
+void   ensadd(struct ensemble *, int, int, long);
+void   ensmerge(struct ensemble *, const struct ensemble *);
+void   ensclear(struct ensemble *);
+double ensmean(const struct ensemble *, int);
+double enssd(const struct ensemble *, int);
+double ensquantile(const struct ensemble *, int, double);
+void   enswrite(FILE *, const struct ensemble *);
+void   ensfree(struct ensemble *);
+
+#endif /*ENSEMBLE_H*/
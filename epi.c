@@ -0,0 +1,383 @@
+/* ************************************************************//** @file epi.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief The epidemic run by cov on a network, one day at a time.
+
+The status of a node is found from its place in the array of nodes, and the
+network is only read, so several epidemics may run on one network at once.
+
+With common random numbers, every draw is a function of seedcov and of where
+it is used alone: patient zero, whether each node is inert, the order of each
+day, and whether node  j  on day  d  is infected by its  m-th neighbour.  Runs
+differing only in chance or inert then share all their draws, a node infected
+at a lower chance is infected at a higher one too (given the same infectious
+neighbours), and the inert nodes at a lower inert are among those at a higher,
+so differences between such runs are not swamped by noise.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "epi.h"
+#include "par.h"
+
+/** Streams of the common random numbers, each derived from .common */
+enum { EPI_ZERO, EPI_INERT, EPI_SHUFFLE, EPI_INFECT };
+
+/* ************************************************************************//**
+@brief  Prepare an epidemic on a network: allocate the status array, choose
+        patient zero and the inert nodes, and count day zero.
+@param  pepi        The epidemic.
+@param  pnode0      The base of the array of nodes.
+@param  manynode    The number of nodes.
+@param  halfdegree  Half the degree of nodes in the first-stage ring.
+@param  seedcov     Seed for the random numbers used by the epidemic.
+@param  chance      Probability of infection per neighbour per day, in 1024ths.
+@param  inert       Fraction of inert nodes, in 1024ths.
+@param  incubating  Days after infection that a node becomes infectious.
+@param  recovery    Days after infection that a node ceases to be infectious.
+@param  common      Non-zero for common random numbers (see above).
+@return             Zero unless error.
+*//* *************************************************************************/
+int
+ epiinit(struct epidemic *pepi, struct node *pnode0, int manynode, \
+                  int halfdegree, unsigned int seedcov, int chance, \
+                       int inert, int incubating, int recovery, int common)
+{
+struct node **pp;
+struct status *pstatus0;
+uint64_t state;
+int j, m, manyedge;
+
+pepi->pnode0 = pnode0; pepi->manynode = manynode;
+pepi->chance = chance; pepi->manylayer = 0; pepi->player = NULL;
+pepi->incubating = incubating; pepi->recovery = recovery;
+/*-----------------------------------------------------------------------------
+COUNT THE LINKS, TO NORMALISE THE CONTACTS REPORTED EACH DAY
+-----------------------------------------------------------------------------*/
+for (j = 0, pepi->manystub = 0; j < manynode; j++)
+  {
+  pp = (pnode0 + j)->pp0;
+  while (NULL != *pp) { pepi->manystub++; pp++; }
+  }
+if ( ! pepi->manystub)
+  {
+  fprintf(stderr, "ERROR: network has no links\n"); return -1;
+  }
+/*-----------------------------------------------------------------------------
+ALLOCATE MEMORY FOR THE STATUS ARRAY
+-----------------------------------------------------------------------------*/
+if (NULL == \
+       (pstatus0 = (struct status *)malloc(manynode * sizeof(struct status))))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n"); return -8;
+  }
+pepi->pstatus0 = pstatus0;
+for (j = 0; j < manynode; j++) { (pstatus0 + j)->pnode = pnode0 + j; }
+/*-----------------------------------------------------------------------------
+INITIALISE THE STATUS ARRAY.
+PATIENT ZERO MUST HAVE AT LEAST  2*halfdegree  NEIGHBOURS.
+-----------------------------------------------------------------------------*/
+pepi->seed = seedcov;
+srand(pepi->seed);
+pepi->common = common ? epicommon(seedcov) : 0;
+state = rngstream(pepi->common, EPI_ZERO);
+pepi->manydraw = 0; pepi->manyvisit = 0; pepi->manynew = 0;
+manyedge = 0;
+while (1)
+  {
+  if (pepi->common) m = (int)rngbelow(&state, manynode);
+  else m = (rand_r(&pepi->seed)) % manynode;
+  assert((0 <= m) && (manynode >m));
+  pepi->manydraw++;
+  pp = (pstatus0 + m)->pnode->pp0;
+  while (NULL != *pp) { manyedge++; pp++; }
+  if (manyedge >= (2*halfdegree)) break;
+  }
+for (j = 0; j < manynode; j++)
+  {
+  (pstatus0 + j)->day = 0;
+  (pstatus0 + j)->inert = 0;
+  (pstatus0 + j)->shuffle = j;
+  if (m == j) (pstatus0 + j)->day = 1;
+  else if (pepi->common)
+    {
+    (pstatus0 + j)->inert = epiinert(pepi->common, inert, j);
+    }
+  else { if (inert > (rand_r(&pepi->seed)) % 1024) (pstatus0 + j)->inert = 1; }
+  }
+pepi->manydraw += manynode - 1;
+pepi->day = 0; pepi->manycasewas = 0; pepi->tick = 0;
+epicount(pepi);
+return 0;
+}
+/* ************************************************************************//**
+@brief  Add layers of contacts to an epidemic just prepared by epiinit(), and
+        count day zero again.  A susceptible node then also meets each
+        neighbour in each layer, with the chance of that layer, the draws
+        following on from those of the network, so that with common random
+        numbers the layers leave the draws of the network as they were.
+@param  pepi       The epidemic.
+@param  manylayer  The number of layers.
+@param  player     The layers, built on the nodes of the network, which must
+                   outlive the epidemic.
+*//* *************************************************************************/
+void
+ epilayers(struct epidemic *pepi, int manylayer, const struct layer *player)
+{
+int l;
+
+pepi->manylayer = manylayer; pepi->player = player;
+for (l = 0; l < manylayer; l++) pepi->manystub += (player + l)->manystub;
+epicount(pepi);
+}
+/* ************************************************************************//**
+@brief  Whether an infectious neighbour infects node  j, the  m-th neighbour
+        counting those in the network and then in each layer in turn.
+*//* *************************************************************************/
+static int
+ draw(struct epidemic *pepi, uint64_t today, int chance, int j, int m)
+{
+if (pepi->common) return epicatch(today, chance, j, m);
+return chance > (rand_r(&pepi->seed)) % 1024;
+}
+/* ************************************************************************//**
+@brief  Randomize the order in which the nodes will be updated.
+*//* *************************************************************************/
+void
+ epishuffle(struct epidemic *pepi)
+{
+struct status *pstatus0;
+uint64_t state;
+int i, j, swap;
+
+pstatus0 = pepi->pstatus0;
+state = rngstream(rngstream(pepi->common, EPI_SHUFFLE), pepi->day);
+for (i = pepi->manynode - 1; i > 0; i--)
+  {
+  swap = (pstatus0 + i)->shuffle;
+  if (pepi->common) j = (int)rngbelow(&state, i + 1);
+  else j = rand_r(&pepi->seed) % (i + 1);
+  (pstatus0 + i)->shuffle = (pstatus0 + j)->shuffle;
+  (pstatus0 + j)->shuffle = swap;
+  }
+if (1 < pepi->manynode) pepi->manydraw += pepi->manynode - 1;
+}
+/* ************************************************************************//**
+@brief  Advance the epidemic by one day, in the order set by epishuffle().
+*//* *************************************************************************/
+void
+ episweep(struct epidemic *pepi)
+{
+struct node **pp;
+struct status *pstatus0, *pother;
+const struct layer *pl;
+const int *pnbr, *pend;
+uint64_t today;
+long manydraw, manyvisit, manynew;
+int i, j, l, m;
+
+pstatus0 = pepi->pstatus0;
+manydraw = 0; manyvisit = 0; manynew = 0;
+today = rngstream(rngstream(pepi->common, EPI_INFECT), pepi->day);
+for (i = 0; i < pepi->manynode; i++)
+  {
+  j = (pstatus0 + i)->shuffle;
+  if ((pstatus0 + j)->inert) continue;
+/*-----------------------------------------------------------------------------
+FOR EVERY NODE  j  WITH NON-ZERO .day, BUMP .day.
+-----------------------------------------------------------------------------*/
+  if ((pstatus0 + j)->day) ((pstatus0 + j)->day)++;
+/*-----------------------------------------------------------------------------
+... OTHERWISE SET .day OF NODE  j  TO  1  WITH PROBABILTY  chance  IF ANY
+NEIGHBOUR IS IN THE INFECTIOUS WINDOW  incubating < .day < recovery.
+THUS  chance  HAS UNITS: PER NEIGHBOUR PER DAY.
+-----------------------------------------------------------------------------*/
+  else
+    {
+    pp = (pstatus0 + j)->pnode->pp0;
+    while (NULL != *pp)
+      {
+      pother = pstatus0 + (*pp - pepi->pnode0);
+      if ((pepi->incubating < pother->day) && (pepi->recovery > pother->day))
+        {
+        if (draw(pepi, today, pepi->chance, j, \
+                              (int)(pp - (pstatus0 + j)->pnode->pp0)))
+          {
+          (pstatus0 + j)->day = 1;
+          }
+        manydraw++;
+        }
+      pp++;
+      }
+    m = pp - (pstatus0 + j)->pnode->pp0;
+/*-----------------------------------------------------------------------------
+THEN THE NEIGHBOURS IN EACH LAYER, EACH AT ITS OWN CHANCE.  ALL THE LAYERS OF
+NODE  j  ARE TAKEN WHILE ITS STATUS IS AT HAND, EACH A RUN OF ITS BLOCK.
+-----------------------------------------------------------------------------*/
+    for (l = 0, pl = pepi->player; l < pepi->manylayer; l++, pl++)
+      {
+      pnbr = pl->pnbr + pl->pfirst[j]; pend = pl->pnbr + pl->pfirst[j + 1];
+      for ( ; pnbr < pend; pnbr++, m++)
+        {
+        pother = pstatus0 + *pnbr;
+        if ((pepi->incubating < pother->day) && \
+                                           (pepi->recovery > pother->day))
+          {
+          if (draw(pepi, today, pl->chance, j, m)) (pstatus0 + j)->day = 1;
+          manydraw++;
+          }
+        }
+      }
+    manyvisit += m;
+    if ((pstatus0 + j)->day) manynew++;
+    }
+  }
+pepi->manydraw += manydraw; pepi->manyvisit += manyvisit;
+pepi->manynew += manynew;
+/*-----------------------------------------------------------------------------
+DETECT WHETHER ASYMPTOTE HAS BEEN REACHED
+-----------------------------------------------------------------------------*/
+if (pepi->manycasewas < pepi->manycase)
+  {
+  pepi->manycasewas = pepi->manycase; pepi->tick = 0;
+  }
+else pepi->tick++;
+pepi->day++;
+}
+/* ************************************************************************//**
+@brief  The key of the common random numbers of an epidemic, its .common.
+@param  seedcov  Seed for the random numbers used by the epidemic.
+*//* *************************************************************************/
+uint64_t
+ epicommon(unsigned int seedcov)
+{
+return rngstream(seedcov, 0xC0C0C0C0) | 1;
+}
+/* ************************************************************************//**
+@brief  The nodes drawn in turn by epiinit() with common random numbers, the
+        first of which, or the first to have  2*halfdegree  neighbours with
+        those before it, is patient zero.
+@param  common    The key of the epidemic, from epicommon().
+@param  manynode  The number of nodes.
+@param  many      How many to draw.
+@param  pm        Where to put them.
+*//* *************************************************************************/
+void
+ epizero(uint64_t common, int manynode, int many, int *pm)
+{
+uint64_t state;
+int n;
+
+state = rngstream(common, EPI_ZERO);
+for (n = 0; n < many; n++) { pm[n] = (int)rngbelow(&state, manynode); }
+}
+/* ************************************************************************//**
+@brief  Whether a node is inert, drawn as epiinit() draws it with common
+        random numbers.
+@param  common  The key of the epidemic, from epicommon().
+@param  inert   Fraction of inert nodes, in 1024ths.
+@param  j       The node.
+@return         Non-zero if  j  is inert.
+*//* *************************************************************************/
+int
+ epiinert(uint64_t common, int inert, int j)
+{
+uint64_t state;
+
+state = rngstream(rngstream(common, EPI_INERT), j);
+return inert > (int)(state >> 54);
+}
+/* ************************************************************************//**
+@brief  The key of the common random numbers of one day's infections.
+@param  common  The key of the epidemic, its .common.
+@param  day     The day, as .day when episweep() is called.
+@return         The key, for epicatch().
+*//* *************************************************************************/
+uint64_t
+ epitoday(uint64_t common, int day)
+{
+return rngstream(rngstream(common, EPI_INFECT), day);
+}
+/* ************************************************************************//**
+@brief  Whether an infectious neighbour infects a node, drawn as episweep()
+        draws it with common random numbers.
+@param  today   The key of the day, from epitoday().
+@param  chance  Probability of infection per neighbour per day, in 1024ths.
+@param  j       The node.
+@param  m       The place of the neighbour in the list of  j, from zero.
+@return         Non-zero if  j  is infected.
+*//* *************************************************************************/
+int
+ epicatch(uint64_t today, int chance, int j, int m)
+{
+uint64_t key;
+
+key = rngstream(today, j) + (uint64_t)(m + 1) * 0x9E3779B97F4A7C15ULL;
+return chance > (int)(rngmix(key) >> 54);
+}
+/* ************************************************************************//**
+@brief  Update the statistics for the day just ended.
+*//* *************************************************************************/
+void
+ epicount(struct epidemic *pepi)
+{
+struct node **pp;
+struct status *pstatus0;
+int j, l;
+
+pstatus0 = pepi->pstatus0;
+pepi->manycase = 0; pepi->manyedge = 0;
+for (j = 0; j < pepi->manynode; j++)
+  {
+  if ((pstatus0 + j)->day) pepi->manycase++;
+  else
+    {
+    pp = (pstatus0 + j)->pnode->pp0;
+    while (NULL != *pp) { pepi->manyedge++; pp++; }
+    for (l = 0; l < pepi->manylayer; l++)
+      {
+      pepi->manyedge += (pepi->player + l)->pfirst[j + 1] - \
+                                             (pepi->player + l)->pfirst[j];
+      }
+    }
+  }
+}
+/* ************************************************************************//**
+@brief  Write the statistics of the day just counted as one line of output.
+*//* *************************************************************************/
+void
+ epiline(FILE *pfout, const struct epidemic *pepi)
+{
+fprintf(pfout, "%3i  %7.4f  %7.4f  %7.4f\n", \
+        pepi->day, ((double)pepi->manycase) / ((double)pepi->manynode), 
+          ((double)(pepi->manynode - pepi->manycase)) / ((double)pepi->manynode), 
+                      ((double)pepi->manyedge) / ((double)pepi->manystub));
+}
+/* ************************************************************************//**
+@brief  Release the memory of an epidemic.
+*//* *************************************************************************/
+void
+ epifree(struct epidemic *pepi)
+{
+free(pepi->pstatus0); pepi->pstatus0 = NULL;
+}
+/* ***************************************************************************/
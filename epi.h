@@ -0,0 +1,89 @@
+/* ************************************************************//** @file epi.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the epidemic functions.
+
+The epidemic of cov is run one day at a time by calling, in turn,
+epishuffle(), episweep() and epicount(), so that each phase may also be timed
+or instrumented on its own.  Layers of contacts besides the network, each
+with its own chance, are added by epilayers() after epiinit().
+*//* *************************************************************************/
+
+#ifndef EPIDEMIC_H
+#define EPIDEMIC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "swn.h"
+#include "lay.h"
+
+/** Information residing on a single node */
+struct status
+  {
+  struct node *pnode;   /**< Pointer to the connectivity information provided
+                                                    by the small-world model */
+  int   day;            /**< Count of days since infection                   */
+  int   inert;          /**< Flag set if this node is inert                  */
+  int   shuffle;        /**< Position of this node in the queue for updating */
+  };
+
+/** State of an epidemic in progress */
+struct epidemic
+  {
+  struct node   *pnode0;      /**< The base of the array of nodes            */
+  struct status *pstatus0;    /**< The base of the array of status           */
+  int            manynode;    /**< The number of nodes                       */
+  int            chance;      /**< Chance of infection per neighbour per day,
+                                   in 1024ths                                */
+  int            incubating;  /**< Days after infection before infectious    */
+  int            recovery;    /**< Days after infection before recovered     */
+  unsigned int   seed;        /**< State of the random numbers               */
+  uint64_t       common;      /**< Key of the common random numbers, or zero */
+  int            manylayer;   /**< Layers of contacts besides the network    */
+  const struct layer *player; /**< The layers, or NULL                       */
+  long           manystub;    /**< Total length of the neighbour lists, of
+                                   the network and the layers                */
+  int            day;         /**< Days elapsed                              */
+  int            manycase;    /**< Nodes ever infected, as at epicount()     */
+  int            manycasewas; /**< Greatest .manycase so far                 */
+  int            tick;        /**< Days since .manycasewas last grew         */
+  long           manyedge;    /**< Links of uninfected nodes, at epicount()  */
+  long           manydraw;    /**< Random numbers drawn so far               */
+  long           manyvisit;   /**< Neighbours visited by episweep() so far   */
+  long           manynew;     /**< Infections by episweep() so far           */
+  };
+
+int  epiinit(struct epidemic *, struct node *, int, int, unsigned int, int, \
+                                                          int, int, int, int);
+void epilayers(struct epidemic *, int, const struct layer *);
+void epishuffle(struct epidemic *);
+void episweep(struct epidemic *);
+void epicount(struct epidemic *);
+uint64_t epicommon(unsigned int);
+void epizero(uint64_t, int, int, int *);
+int  epiinert(uint64_t, int, int);
+uint64_t epitoday(uint64_t, int);
+int  epicatch(uint64_t, int, int, int);
+void epiline(FILE *, const struct epidemic *);
+void epifree(struct epidemic *);
+
+#endif /*EPIDEMIC_H*/
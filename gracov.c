@@ -21,6 +21,10 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ______________________________________________________________________________
 @brief Utility for creating SVG graphs from files created by program cov.
+
+Given -o, or a list of graphs by -b, gracov draws each graph itself (see
+plt.c) and writes it as SVG or PNG; otherwise it writes gracov.out and
+gnuplot.cmd and calls upon gnuplot and ristretto, as it always has.
 *//* *************************************************************************/
 
 #include <stddef.h>
@@ -33,6 +37,15 @@ ______________________________________________________________________________
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include "rdr.h"
+#include "plt.h"
+#include "qnt.h"
+#include "par.h"
 
 #ifndef MESS
 /** Diagnostic trap: immediate termination */
@@ -42,15 +55,49 @@ ______________________________________________________________________________
                 } while (0)
 #endif /*MESS*/
 
-#define MANYIN         (4)  /**< Maximum number of input files               */
-#define MANYCOLUMN   (128)  /**< Maximum number of columns in any input file */
-#define BFSZ        (8192)  /**< Maximum number of chars in any line
-                                                           of any input file */
-#define BFSZHDR     (1024)  /**< Maximum number of chars in a column header  */
 #define ORDINATE_MAX (128)  /**< Maximum number of chars in a Y label        */
+#define GRACOV_WIDTH (640)  /**< Default width of a graph drawn by gracov    */
+#define GRACOV_HEIGHT (400) /**< Default height of a graph drawn by gracov   */
+#define GRACOV_LAPSE (250)  /**< Least milliseconds between graphs with -f   */
+#define GRACOV_MANYQ (16)   /**< Most edges of bands given by -q           */
+
+/** One graph of a list given by -b: the output, then file-heading pairs */
+struct graph
+  {
+  char      **parg;           /**< The words of its line                     */
+  int         manyarg;        /**< Their number                              */
+  int         line;           /**< The line                                  */
+  };
+
+/** A file being followed, and its series */
+struct tail
+  {
+  struct rdr  rdr;            /**< The reader                                */
+  int         wd;             /**< Its inotify watch                         */
+  int         kolumn;         /**< The column wanted, or -1 until its
+                                   headings have been written                */
+  int         done;           /**< Non-zero once its writer has closed it    */
+  int         many;           /**< Rows read                                 */
+  int         room;           /**< Rows for which there is room              */
+  double     *px;             /**< The first column of each row              */
+  double     *py;             /**< The column wanted of each row             */
+  };
+
+/** The work of a thread drawing the graphs of a list */
+struct batch
+  {
+  const struct graph *pgraph0; /**< The graphs                               */
+  int         manygraph;      /**< Their number                              */
+  int         width;          /**< Size of each graph                        */
+  int         height;
+  const char *phead;          /**< Heading of the column whose quantiles are
+                                   drawn, or NULL if the graphs are of pairs */
+  int         manyband;       /**< Bands of quantiles                        */
+  const double *pq;           /**< Probabilities of their edges              */
+  int        *pnext;          /**< Next graph to be claimed by any thread    */
+  int        *pfailed;        /**< Number of graphs which could not be drawn */
+  };
 
-char outdir[FILENAME_MAX];         /**< Path to output directory             */
-char infnm[MANYIN][FILENAME_MAX];  /**< Path to input files                  */
 char outfnm[FILENAME_MAX];         /**< Path to the file  gracov.out         */
 char cmdfnm[FILENAME_MAX];         /**< Path to the file  gnuplot.cmd        */
 
@@ -59,11 +106,583 @@ char ylabel[ORDINATE_MAX];         /**< Y label to be displayed              */
 
 FILE *pfcmd;                       /**< Pointer for gnuplot command file     */
 
-char   wantkolumn[MANYIN];                  /**< Column number  of interest  */
-char   want[MANYIN][BFSZ];                  /**< Column heading of interest  */
-char   head[MANYIN][MANYCOLUMN][BFSZ];      /**< Column headings             */
-double data[MANYIN][MANYCOLUMN];            /**< Column content              */
+/**************************************************************************//**
+@brief   The name of a file without its directory.
+*//* *************************************************************************/
+static const char *
+ natname(const char *pfnm)
+{
+const char *p1;
+
+return (NULL == (p1 = strrchr(pfnm, '/'))) ? pfnm : p1 + 1;
+}
+/**************************************************************************//**
+@brief   Label the Y axis with the headings wanted, each once.
+@param   ppair   The files and headings, alternately.
+@param   manyin  Number of pairs.
+@param   plabel  The label, of  ORDINATE_MAX  chars.
+*//* *************************************************************************/
+static void
+ ylabelof(char **ppair, int manyin, char *plabel)
+{
+int m, n, jack;
+
+plabel[0] = 0;
+for (n = 0; n < manyin; n++)
+  {
+  jack = 0;
+  for (m = 0; m < n; m++)
+    {
+    if ( ! strcmp(ppair[2*m + 1], ppair[2*n + 1])) { jack = 1; break; }
+    }
+  if ( ! jack)
+    {
+    if (n) strcat(plabel, ", ");
+    if ((ORDINATE_MAX - 8) > (strlen(plabel) + strlen(ppair[2*n + 1])))
+      {
+      strcat(plabel, ppair[2*n + 1]);
+      }
+    else { strcat(plabel, "..."); break; }
+    }
+  }
+}
+/**************************************************************************//**
+@brief   Draw one graph of a column of each of several files, against the
+         first column, without gnuplot.
+@param   poutfnm  The graph, named *.svg or *.png.
+@param   manyin   Number of files.
+@param   ppair    The files and headings, alternately.
+@param   width    Width of the graph in pixels.
+@param   height   Height of the graph in pixels.
+@return           Zero unless error.
+*//* *************************************************************************/
+static int
+ chart(const char *poutfnm, int manyin, char **ppair, int width, int height)
+{
+struct rdr rdr0;
+struct pltseries *ps0, *ps;
+struct plt plt0;
+double *px, *py;
+char label[ORDINATE_MAX], name[FILENAME_MAX], *p1;
+int n, room, kolumn, rc;
+
+if (NULL == (ps0 = (struct pltseries *)calloc(manyin, \
+                                                  sizeof(struct pltseries))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+rc = 0;
+for (n = 0; (n < manyin) && ! rc; n++)
+  {
+  ps = ps0 + n;
+  ps->pname = natname(ppair[2*n]);
+  if (0 > (rc = rdropen(&rdr0, ppair[2*n]))) break;
+  if (0 > (kolumn = rdrcolumn(&rdr0, ppair[2*n + 1])))
+    {
+    fprintf(stderr, "ERROR: heading not found: %s in %s\n", \
+                                                ppair[2*n + 1], ppair[2*n]);
+    rc = -1;
+    }
+  room = 0; px = py = NULL;
+  while ( ! rc && (0 < (rc = rdrnext(&rdr0))))
+    {
+    rc = 0;
+    if (ps->many == room)
+      {
+      room = room ? 2*room : 512;
+      px = (double *)realloc((double *)ps->px, room*sizeof(double));
+      if (px) ps->px = px;
+      py = (double *)realloc((double *)ps->py, room*sizeof(double));
+      if (py) ps->py = py;
+      if ((NULL == px) || (NULL == py))
+        {
+        fprintf(stderr, "ERROR: memory request refused\n"); rc = -8; break;
+        }
+      }
+    px[ps->many] = rdr0.prow[0];
+    py[ps->many] = rdr0.prow[kolumn];
+    ps->many++;
+    }
+  rdrclose(&rdr0);
+  }
+if ( ! rc)
+  {
+  snprintf(name, FILENAME_MAX, "%s", natname(poutfnm));
+  if (NULL != (p1 = strrchr(name, '.'))) *p1 = 0;
+  ylabelof(ppair, manyin, &label[0]);
+  memset(&plt0, 0, sizeof(plt0));
+  plt0.ptitle = name; plt0.pxlabel = "DAYS"; plt0.pylabel = label;
+  plt0.width = width; plt0.height = height;
+  plt0.manyseries = manyin; plt0.pseries = ps0;
+  rc = pltwrite(poutfnm, &plt0);
+  }
+for (n = 0; n < manyin; n++)
+  {
+  free((double *)ps0[n].px); free((double *)ps0[n].py);
+  }
+free(ps0);
+return rc;
+}
+/**************************************************************************//**
+@brief   Add to a series the rows newly written to a file being followed.
+@return  The number of rows added, or negative if error.
+*//* *************************************************************************/
+static int
+ tailmore(struct tail *pt, const char *phead)
+{
+double *pnew;
+int many, rc;
 
+if (0 > (rc = rdrmore(&pt->rdr))) return rc;
+if (0 > pt->kolumn)
+  {
+  if (NULL == pt->rdr.phead) return 0;
+  if (0 > (pt->kolumn = rdrcolumn(&pt->rdr, phead)))
+    {
+    fprintf(stderr, "ERROR: heading not found: %s in %s\n", phead, \
+                                                            pt->rdr.pname);
+    return -1;
+    }
+  }
+for (many = 0; 0 < (rc = rdrnext(&pt->rdr)); many++)
+  {
+  if (pt->many == pt->room)
+    {
+    pt->room = pt->room ? 2*pt->room : 512;
+    if (NULL != (pnew = (double *)realloc(pt->px, pt->room*sizeof(double))))
+      {
+      pt->px = pnew;
+      }
+    if (pnew && (NULL != (pnew = (double *)realloc(pt->py, \
+                                                pt->room*sizeof(double)))))
+      {
+      pt->py = pnew;
+      }
+    if (NULL == pnew)
+      {
+      fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+      }
+    }
+  pt->px[pt->many] = pt->rdr.prow[0];
+  pt->py[pt->many] = pt->rdr.prow[pt->kolumn];
+  pt->many++;
+  }
+return (0 > rc) ? rc : many;
+}
+/**************************************************************************//**
+@brief   Whether any process has a file open for writing, as far as /proc
+         shows: only the processes of the same user are seen.
+@param   path  The file.
+@return        Non-zero if so, or if /proc cannot be read.
+*//* *************************************************************************/
+static int
+ writing(const char *path)
+{
+struct stat st, sf;
+struct dirent *pproc, *pfd;
+DIR *pdproc, *pdfd;
+FILE *pf;
+char fnm[600], bf[256];
+unsigned long flags;
+int found;
+
+if (stat(path, &st)) return 0;
+if (NULL == (pdproc = opendir("/proc"))) return 1;
+found = 0;
+while (( ! found) && (NULL != (pproc = readdir(pdproc))))
+  {
+  if ( ! isdigit((unsigned char)pproc->d_name[0])) continue;
+  snprintf(fnm, sizeof(fnm), "/proc/%s/fd", pproc->d_name);
+  if (NULL == (pdfd = opendir(fnm))) continue;
+  while (( ! found) && (NULL != (pfd = readdir(pdfd))))
+    {
+    if ( ! isdigit((unsigned char)pfd->d_name[0])) continue;
+    snprintf(fnm, sizeof(fnm), "/proc/%s/fd/%s", pproc->d_name, pfd->d_name);
+    if (stat(fnm, &sf) || (sf.st_dev != st.st_dev) || \
+                                       (sf.st_ino != st.st_ino)) continue;
+    snprintf(fnm, sizeof(fnm), "/proc/%s/fdinfo/%s", pproc->d_name, \
+                                                               pfd->d_name);
+    flags = O_RDWR;
+    if (NULL != (pf = fopen(fnm, "r")))
+      {
+      while (NULL != fgets(bf, sizeof(bf), pf))
+        {
+        if (1 == sscanf(bf, "flags: %lo", &flags)) break;
+        }
+      fclose(pf);
+      }
+    found = (O_RDONLY != (flags & O_ACCMODE));
+    }
+  closedir(pdfd);
+  }
+closedir(pdproc);
+return found;
+}
+/**************************************************************************//**
+@brief   Follow files still being written, by runs of cov given -f, drawing
+         the graph again whenever rows have been added, but no more than
+         once in GRACOV_LAPSE milliseconds.  The files are watched by
+         inotify, and only their new rows are read.  Each graph is drawn to
+         a hidden file which then replaces the graph, so a viewer never sees
+         one half written.  Following ends once each file has been closed by
+         its writer, or at once for a file no process has open for writing
+         when it is first read, such as the output of a run already done.
+@param   poutfnm  The graph, named *.svg or *.png.
+@param   manyin   Number of files.
+@param   ppair    The files and headings, alternately.
+@param   width    Width of the graph in pixels.
+@param   height   Height of the graph in pixels.
+@return           Zero unless error.
+*//* *************************************************************************/
+static int
+ follow(const char *poutfnm, int manyin, char **ppair, int width, int height)
+{
+struct tail *pt0, *pt;
+struct pltseries *ps0;
+struct plt plt0;
+struct pollfd pfd;
+struct timespec ts0, ts1;
+const struct inotify_event *pev;
+char label[ORDINATE_MAX], name[FILENAME_MAX], temp[2*FILENAME_MAX], *p1;
+char bf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+ssize_t got;
+long lapse;
+int n, open, pending, rc;
+
+pt0 = (struct tail *)calloc(manyin, sizeof(struct tail));
+ps0 = (struct pltseries *)calloc(manyin, sizeof(struct pltseries));
+if ((NULL == pt0) || (NULL == ps0))
+  {
+  free(pt0); free(ps0);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+snprintf(name, FILENAME_MAX, "%s", natname(poutfnm));
+snprintf(temp, sizeof(temp), "%.*s.%s", (int)(natname(poutfnm) - poutfnm), \
+                                                          poutfnm, name);
+if (NULL != (p1 = strrchr(name, '.'))) *p1 = 0;
+ylabelof(ppair, manyin, &label[0]);
+memset(&plt0, 0, sizeof(plt0));
+plt0.ptitle = name; plt0.pxlabel = "DAYS"; plt0.pylabel = label;
+plt0.width = width; plt0.height = height;
+plt0.manyseries = manyin; plt0.pseries = ps0;
+/*-----------------------------------------------------------------------------
+WATCH EACH FILE, THEN READ WHAT IT ALREADY HAS
+-----------------------------------------------------------------------------*/
+rc = 0;
+for (n = 0; n < manyin; n++) { pt0[n].rdr.fd = -1; pt0[n].kolumn = -1; }
+if (0 > (pfd.fd = inotify_init1(IN_CLOEXEC)))
+  {
+  fprintf(stderr, "ERROR: inotify is not available\n"); rc = -1;
+  }
+pfd.events = POLLIN;
+for (n = 0; ( ! rc) && (n < manyin); n++)
+  {
+  pt = pt0 + n;
+  ps0[n].pname = natname(ppair[2*n]);
+  if (0 > (rc = rdrfollow(&pt->rdr, ppair[2*n]))) break;
+  if (0 > (pt->wd = inotify_add_watch(pfd.fd, ppair[2*n], \
+                                                 IN_MODIFY | IN_CLOSE_WRITE)))
+    {
+    fprintf(stderr, "ERROR: cannot watch input file: %s\n", ppair[2*n]);
+    rc = -16;
+    }
+  }
+open = manyin;
+for (n = 0; ( ! rc) && (n < manyin); n++)
+  {
+  pt = pt0 + n;
+  if ( ! writing(ppair[2*n]))
+    {
+    pt->done = 1; pt->rdr.follow = 0; open--;
+    }
+  if (0 < (rc = tailmore(pt, ppair[2*n + 1]))) rc = 0;
+  }
+/*-----------------------------------------------------------------------------
+DRAW, THEN WAIT FOR MORE
+-----------------------------------------------------------------------------*/
+pending = 1;
+clock_gettime(CLOCK_MONOTONIC, &ts0); ts0.tv_sec--;
+while ( ! rc)
+  {
+  clock_gettime(CLOCK_MONOTONIC, &ts1);
+  lapse = 1000*(ts1.tv_sec - ts0.tv_sec) + (ts1.tv_nsec - ts0.tv_nsec)/1000000;
+  if (pending && ((GRACOV_LAPSE <= lapse) || ! open))
+    {
+    for (n = 0; n < manyin; n++)
+      {
+      ps0[n].many = pt0[n].many; ps0[n].px = pt0[n].px; ps0[n].py = pt0[n].py;
+      }
+    if (0 > (rc = pltwrite(temp, &plt0))) break;
+    if (rename(temp, poutfnm))
+      {
+      fprintf(stderr, "ERROR: cannot rename %s to %s\n", temp, poutfnm);
+      rc = -16; break;
+      }
+    ts0 = ts1; pending = 0; lapse = 0;
+    }
+  if ( ! open) break;
+  if (0 > poll(&pfd, 1, pending ? GRACOV_LAPSE - lapse : -1))
+    {
+    if (EINTR == errno) continue;
+    fprintf(stderr, "ERROR: cannot wait for input files\n"); rc = -1; break;
+    }
+  if ( ! (pfd.revents & POLLIN)) continue;
+  if (0 >= (got = read(pfd.fd, bf, sizeof(bf)))) continue;
+  for (p1 = bf; p1 < bf + got; p1 += sizeof(struct inotify_event) + pev->len)
+    {
+    pev = (const struct inotify_event *)p1;
+    for (n = 0; n < manyin; n++)
+      {
+      pt = pt0 + n;
+      if ((pt->wd != pev->wd) || pt->done) continue;
+      if (pev->mask & (IN_CLOSE_WRITE | IN_IGNORED))
+        {
+        pt->done = 1; pt->rdr.follow = 0; open--;
+        }
+      if (0 > (rc = tailmore(pt, ppair[2*n + 1]))) break;
+      if (rc) pending = 1;
+      rc = 0;
+      }
+    if (rc) break;
+    }
+  }
+if ( ! rc) fprintf(stdout, "-> %s\n", poutfnm);
+if (0 <= pfd.fd) close(pfd.fd);
+for (n = 0; n < manyin; n++)
+  {
+  rdrclose(&pt0[n].rdr); free(pt0[n].px); free(pt0[n].py);
+  }
+free(pt0); free(ps0);
+return rc;
+}
+/**************************************************************************//**
+@brief   Draw the median of a column over many files, and bands between
+         pairs of its quantiles, against the first column.  The files are
+         read once each and in turn, each row of each being added to a
+         histogram of that row (see qnt.c), so the memory needed depends on
+         the number of rows but not on the number of files.
+@param   poutfnm   The graph, named *.svg or *.png.
+@param   phead     The heading of the column.
+@param   manyfile  Number of files.
+@param   ppfile    The files.
+@param   manyband  Number of bands.
+@param   pq        The probabilities of their edges in ascending order, the
+                   outermost band being  pq[0]  to  pq[2*manyband - 1] .
+@param   width     Width of the graph in pixels.
+@param   height    Height of the graph in pixels.
+@return            Zero unless error.
+*//* *************************************************************************/
+static int
+ envelope(const char *poutfnm, const char *phead, int manyfile, \
+          char **ppfile, int manyband, const double *pq, int width, int height)
+{
+struct rdr rdr0;
+struct qnt *pqnt0, *pqnt;
+struct pltseries s0;
+struct plt plt0;
+double *px, *py, *pline, **ppedge;
+char name[FILENAME_MAX], legend[128], *p1;
+int n, b, row, room, manyrow, kolumn, rc;
+
+pqnt0 = NULL; px = NULL; room = 0; manyrow = 0;
+for (n = 0, rc = 0; (n < manyfile) && ! rc; n++)
+  {
+  if (0 > (rc = rdropen(&rdr0, ppfile[n]))) break;
+  if (0 > (kolumn = rdrcolumn(&rdr0, phead)))
+    {
+    fprintf(stderr, "ERROR: heading not found: %s in %s\n", phead, ppfile[n]);
+    rc = -1;
+    }
+  for (row = 0; ! rc && (0 < (rc = rdrnext(&rdr0))); row++)
+    {
+    rc = 0;
+    if (row == room)
+      {
+      room = room ? 2*room : 512;
+      if (NULL != (pqnt = (struct qnt *)realloc(pqnt0, \
+                                                room*sizeof(struct qnt))))
+        {
+        pqnt0 = pqnt;
+        }
+      if (NULL != (py = (double *)realloc(px, room*sizeof(double)))) px = py;
+      if ((NULL == pqnt) || (NULL == py))
+        {
+        fprintf(stderr, "ERROR: memory request refused\n"); rc = -8; break;
+        }
+      }
+    if (row == manyrow) { qntinit(pqnt0 + row); px[row] = rdr0.prow[0]; }
+    if (row >= manyrow) manyrow = row + 1;
+    qntadd(pqnt0 + row, rdr0.prow[kolumn]);
+    }
+  rdrclose(&rdr0);
+  }
+/*-----------------------------------------------------------------------------
+THE MEDIAN, THEN THE LOWER AND UPPER EDGES OF EACH BAND, OF EACH ROW
+-----------------------------------------------------------------------------*/
+pline = NULL; ppedge = NULL;
+if ( ! rc)
+  {
+  pline = (double *)malloc((2*manyband + 1)*(manyrow + 1)*sizeof(double));
+  ppedge = (double **)malloc((2*manyband + 1)*sizeof(double *));
+  if ((NULL == pline) || (NULL == ppedge))
+    {
+    fprintf(stderr, "ERROR: memory request refused\n"); rc = -8;
+    }
+  }
+if ( ! rc)
+  {
+  for (b = 0; b <= 2*manyband; b++) ppedge[b] = pline + b*manyrow;
+  for (row = 0; row < manyrow; row++)
+    {
+    ppedge[2*manyband][row] = qntvalue(pqnt0 + row, 0.5);
+    for (b = 0; b < manyband; b++)
+      {
+      ppedge[b][row] = qntvalue(pqnt0 + row, pq[b]);
+      ppedge[manyband + b][row] = qntvalue(pqnt0 + row, \
+                                                     pq[2*manyband - 1 - b]);
+      }
+    }
+  n = snprintf(legend, sizeof(legend), "%s: median", phead);
+  for (b = 0; (b < manyband) && (n < (int)sizeof(legend)); b++)
+    {
+    n += snprintf(legend + n, sizeof(legend) - n, ", %g-%g%%", \
+                              100.*pq[b], 100.*pq[2*manyband - 1 - b]);
+    }
+  if (n < (int)sizeof(legend)) snprintf(legend + n, sizeof(legend) - n, \
+                                                    " of %i files", manyfile);
+  memset(&s0, 0, sizeof(s0));
+  s0.pname = legend; s0.many = manyrow; s0.px = px;
+  s0.py = ppedge[2*manyband]; s0.manyband = manyband;
+  s0.pplo = (const double *const *)ppedge;
+  s0.pphi = (const double *const *)ppedge + manyband;
+  snprintf(name, FILENAME_MAX, "%s", natname(poutfnm));
+  if (NULL != (p1 = strrchr(name, '.'))) *p1 = 0;
+  memset(&plt0, 0, sizeof(plt0));
+  plt0.ptitle = name; plt0.pxlabel = "DAYS"; plt0.pylabel = phead;
+  plt0.width = width; plt0.height = height;
+  plt0.manyseries = 1; plt0.pseries = &s0;
+  rc = pltwrite(poutfnm, &plt0);
+  }
+free(ppedge); free(pline); free(px); free(pqnt0);
+return rc;
+}
+/**************************************************************************//**
+@brief   Draw the graphs of a list, claiming them one at a time, on one of
+         the threads given by -j.
+*//* *************************************************************************/
+static void *
+ batchdraw(void *pv)
+{
+struct batch *pw;
+const struct graph *pg;
+int j;
+
+pw = (struct batch *)pv;
+while (pw->manygraph > (j = __atomic_fetch_add(pw->pnext, 1, \
+                                                          __ATOMIC_RELAXED)))
+  {
+  pg = pw->pgraph0 + j;
+  if (pw->phead ? envelope(pg->parg[0], pw->phead, pg->manyarg - 1, \
+                   pg->parg + 1, pw->manyband, pw->pq, pw->width, pw->height)
+                : chart(pg->parg[0], (pg->manyarg - 1)/2, pg->parg + 1, \
+                                                    pw->width, pw->height))
+    {
+    fprintf(stderr, "ERROR: graph on line %i not drawn: %s\n", \
+                                                     pg->line, pg->parg[0]);
+    __atomic_fetch_add(pw->pfailed, 1, __ATOMIC_RELAXED);
+    }
+  }
+return NULL;
+}
+/**************************************************************************//**
+@brief   Read a list of graphs, one to a line: the graph, then file-heading
+         pairs (or files alone), separated by white space.  Blank lines, and
+         lines beginning with '#', are skipped.
+@param   plistfnm  The list, or - for the standard input.
+@param   pairs     Non-zero if the files are paired with headings.
+@param   ppbuf     Set to the text of the list, which the graphs point into.
+@param   ppgraph   Set to the graphs.
+@param   pmany     Set to their number.
+@return            Zero unless error.
+*//* *************************************************************************/
+static int
+ batchread(const char *plistfnm, int pairs, char **ppbuf, \
+                                          struct graph **ppgraph, int *pmany)
+{
+FILE *pf;
+struct graph *pg;
+char *pbuf, *p1, *p2, *pnew;
+size_t size, room, got;
+int many, line, k, isbad;
+
+*ppbuf = NULL; *ppgraph = NULL; *pmany = 0;
+pf = strcmp(plistfnm, "-") ? fopen(plistfnm, "r") : stdin;
+if (NULL == pf)
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", plistfnm);
+  return -16;
+  }
+pbuf = NULL; size = 0; room = 0;
+do
+  {
+  if (size + 1 >= room)
+    {
+    room = room ? 2*room : 65536;
+    if (NULL == (pnew = (char *)realloc(pbuf, room)))
+      {
+      free(pbuf); if (stdin != pf) fclose(pf);
+      fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+      }
+    pbuf = pnew;
+    }
+  got = fread(pbuf + size, 1, room - size - 1, pf);
+  size += got;
+  } while (got);
+pbuf[size] = 0;
+if (stdin != pf) fclose(pf);
+for (many = 1, p1 = pbuf; *p1; p1++) { if ('\n' == *p1) many++; }
+if (NULL == (pg = (struct graph *)calloc(many, sizeof(struct graph))))
+  {
+  free(pbuf); fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+*ppbuf = pbuf; *ppgraph = pg;
+/*-----------------------------------------------------------------------------
+EACH LINE IS CUT INTO WORDS WHERE IT LIES
+-----------------------------------------------------------------------------*/
+isbad = 0;
+for (line = 1, p1 = pbuf; *p1; line++, p1 = p2)
+  {
+  for (p2 = p1; *p2 && ('\n' != *p2); p2++) {;}
+  if (*p2) *p2++ = 0;
+  for (k = 0, pnew = p1; *pnew; k++)
+    {
+    while (isspace((unsigned char)*pnew)) pnew++;
+    if ( ! *pnew || ('#' == *pnew)) break;
+    while (*pnew && ! isspace((unsigned char)*pnew)) pnew++;
+    }
+  if ( ! k) continue;
+  if (pairs ? ((3 > k) || ! (k % 2)) : (2 > k))
+    {
+    fprintf(stderr, "ERROR: line %i of %s: a graph, then %s, are wanted\n", \
+                      line, plistfnm, pairs ? "file-heading pairs" : "files");
+    isbad++; continue;
+    }
+  if (NULL == (pg->parg = (char **)malloc(k*sizeof(char *))))
+    {
+    fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+    }
+  pg->manyarg = k; pg->line = line;
+  for (k = 0, pnew = p1; k < pg->manyarg; k++)
+    {
+    while (isspace((unsigned char)*pnew)) pnew++;
+    pg->parg[k] = pnew;
+    while (*pnew && ! isspace((unsigned char)*pnew)) pnew++;
+    if (*pnew) *pnew++ = 0;
+    }
+  pg++; (*pmany)++;
+  }
+return isbad ? -1 : 0;
+}
 /**************************************************************************//**
 @brief   Create a gnuplot command file from plain-text files comprising
          columns of numerical data.  The output file is always ./gnuplot.cmd.
@@ -73,10 +692,27 @@ USAGE:   ./gracov  filename1  headname1 [filename2  headname2 [...]]         \n
          is a column of data indentified by string  headname1  on the very
          first line of said file.
 
-         The permitted number of filename-headname pairs is determined at
-         compile-time by the paramater MANYIN.  The size of records in the
-         file are determined at compile-time by the parameters
-         MANYCOLUMN, BFSZ and BFSZHDR.
+         Any number of filename-headname pairs may be given, and the files
+         may have any number of columns and lines of any length: each is
+         mapped into memory and read one row at a time (see rdr.c).
+
+         ./gracov  -o graph.svg  filename1  headname1 [...]              \n
+         draws the graph itself instead, as SVG, or as PNG if it is named
+         *.png, and neither gnuplot nor ristretto is called.  With -f too,
+         the files are followed as runs of cov -f write them, the graph
+         being drawn again as they grow, until each has been closed; a file
+         nobody has open for writing is drawn once, as it is.
+
+         ./gracov  -b list [-j threads]                                   \n
+         draws every graph of a list, each line of which is a graph and its
+         filename-headname pairs, on the number of threads given by -j.
+         -s WxH  sets the size of the graphs in pixels (640x400 by default).
+
+         ./gracov  -e headname  -o graph.svg  filename1 [filename2 [...]]  \n
+         draws instead the median of the column  headname  over all the
+         files, which may be thousands, and bands between its quantiles:
+         -q 5,25,75,95  (the default) gives the percentages of their edges,
+         outermost first.  With -b each line is then a graph and its files.
   
 @return         Zero unless error.
 *//* *************************************************************************/
@@ -84,14 +720,19 @@ int
  main(int argc, char *argv[])
 {
 struct tm tm0, *ptm0; time_t t0;
-FILE *pfin[MANYIN], *pfout;
-struct stat stat0;
-int manyin, manykolumn[MANYIN], blank[MANYIN];
-int isbad, m, n, kolumn, kolout, lineout, line[MANYIN];
-int latch;
-char bf[MANYIN][BFSZ], natname[MANYIN][BFSZHDR];
+FILE *pfout;
+struct rdr *prdr;
+int manyin, *pwantkolumn, *pblank;
+int isbad, m, n, kolout, lineout;
+char **pwant, **pnatname;
 char datetimestr[32];
-char c, *p1, *p2;
+char *p1, *p2, *pprog;
+const char *poutfnm, *plistfnm, *phead;
+int following;
+struct graph *pgraph0;
+struct batch *pw;
+double pq[GRACOV_MANYQ];
+int manythread, width, height, manygraph, next, failed, manyq;
 int rc;
 
 rc = 0;
@@ -101,39 +742,121 @@ if ( ! strftime(&datetimestr[0], 32, "%Y-%m-%d-%H%M", &tm0)) MESS;
 /*-----------------------------------------------------------------------------
 PROCESS THE COMMAND LINE
 -----------------------------------------------------------------------------*/
-isbad = 0;
-if ((argc - 1) % 2) isbad++;
-manyin = (argc - 1)/2;
-if (0 >= manyin) isbad++;
-if (( ! isbad) && (MANYIN < manyin))
+isbad = 0; pprog = argv[0];
+poutfnm = NULL; plistfnm = NULL; manythread = 1;
+width = GRACOV_WIDTH; height = GRACOV_HEIGHT;
+phead = NULL; manyq = 4; following = 0;
+pq[0] = 0.05; pq[1] = 0.25; pq[2] = 0.75; pq[3] = 0.95;
+while (-1 != (m = getopt(argc, argv, "+o:b:j:s:e:q:f")))
   {
-  fprintf(stderr,"ERROR: too many input files\n"); isbad++;
+  switch (m)
+    {
+    case 'o': poutfnm = optarg; break;
+    case 'f': following = 1; break;
+    case 'e': phead = optarg; break;
+    case 'q':
+      for (manyq = 0, p1 = optarg; *p1 && (GRACOV_MANYQ > manyq); manyq++)
+        {
+        errno = 0; pq[manyq] = 0.01*strtod(p1, &p2);
+        if (errno || (p2 == p1) || (0. >= pq[manyq]) || (1. <= pq[manyq]) || \
+                                  (manyq && (pq[manyq - 1] >= pq[manyq])))
+          {
+          isbad++; break;
+          }
+        p1 = p2; if (',' == *p1) p1++;
+        }
+      if (*p1 || (manyq % 2)) isbad++;
+      break;
+    case 'b': plistfnm = optarg; break;
+    case 'j':
+      errno = 0; manythread = (int)strtol(optarg, NULL, 10);
+      if (errno || (1 > manythread)) isbad++;
+      break;
+    case 's':
+      errno = 0; width = (int)strtol(optarg, &p1, 10);
+      if ('x' == *p1) height = (int)strtol(p1 + 1, &p1, 10); else isbad++;
+      if (errno || *p1) isbad++;
+      break;
+    default: isbad++;
+    }
+  }
+argc -= optind - 1; argv += optind - 1;
+if (phead)
+  {
+  manyin = argc - 1;
+  if ( ! poutfnm && ! plistfnm) isbad++;
+  }
+else
+  {
+  if ((argc - 1) % 2) isbad++;
+  manyin = (argc - 1)/2;
   }
+if (plistfnm ? (poutfnm || manyin) : (0 >= manyin)) isbad++;
+if (following && ( ! poutfnm || phead)) isbad++;
 if (isbad)
   {
-  fprintf(stderr,"USAGE: ./gracov  file1  hdr1 [file2  hdr2 [...]]\n");
-  fprintf(stderr,"       for 1, 2, 3 or 4 filename-headername pairs\n");
+  fprintf(stderr,"USAGE: ./gracov [-o graph [-f]] [-s WxH] file1 hdr1 "
+                 "[file2 hdr2 [...]]\n");
+  fprintf(stderr,"       for any number of filename-headername pairs,\n");
+  fprintf(stderr,"       drawn as graph.svg or graph.png if -o is given,\n");
+  fprintf(stderr,"       and again as they grow if -f is given too, until\n");
+  fprintf(stderr,"       no process has them open for writing;\n");
+  fprintf(stderr,"   or: ./gracov -e hdr [-q 5,25,75,95] -o graph [-s WxH] "
+                 "file1 [file2 [...]]\n");
+  fprintf(stderr,"       for the median and quantiles of hdr over files;\n");
+  fprintf(stderr,"   or: ./gracov [-e hdr [-q ...]] -b list [-j threads] "
+                 "[-s WxH]\n");
+  fprintf(stderr,"       for a list of lines:  graph file1 hdr1 [...]\n");
+  fprintf(stderr,"       (or, given -e,  graph file1 [file2 [...]])\n");
   return -1;
   }
-isbad = 0;
-for (n = 1; n < argc; n += 2)
+if (poutfnm && phead) return envelope(poutfnm, phead, manyin, argv + 1, \
+                                               manyq/2, pq, width, height);
+if (poutfnm && following) return follow(poutfnm, manyin, argv + 1, \
+                                                            width, height);
+if (poutfnm) return chart(poutfnm, manyin, argv + 1, width, height);
+if (plistfnm)
   {
-  strncpy(&infnm[n/2][0], argv[n], FILENAME_MAX-2);
-  if (strcmp(&infnm[n/2][0], argv[n]))
-    {
-    fprintf(stderr,"ERROR: bad command-line token: %s\n", argv[n]); isbad++;
-    }
-  if (stat(&infnm[n/2][0], &stat0))
-    {
-    fprintf(stderr,"ERROR: missing input file: %s\n", &infnm[n/2][0]); isbad++;
-    }
-  strncpy(&want[n/2][0], argv[n+1], BFSZ-2);
-  if (strcmp(&want[n/2][0], argv[n+1]))
+  struct timespec ts0, ts1;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts0);
+  if ( ! (rc = batchread(plistfnm, ! phead, &p1, &pgraph0, &manygraph)))
     {
-    fprintf(stderr,"ERROR: bad command-line token: %s\n", argv[n+1]); isbad++;
+    next = 0; failed = 0;
+    if (manythread > manygraph) manythread = manygraph;
+    if (NULL == (pw = (struct batch *)calloc(manythread ? manythread : 1, \
+                                                       sizeof(struct batch))))
+      {
+      fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+      }
+    for (n = 0; n < manythread; n++)
+      {
+      pw[n].pgraph0 = pgraph0; pw[n].manygraph = manygraph;
+      pw[n].width = width; pw[n].height = height;
+      pw[n].phead = phead; pw[n].manyband = manyq/2; pw[n].pq = pq;
+      pw[n].pnext = &next; pw[n].pfailed = &failed;
+      }
+    rc = parallel(manythread, batchdraw, pw, sizeof(struct batch));
+    free(pw);
+    clock_gettime(CLOCK_MONOTONIC, &ts1);
+    if ( ! rc) printf("%i graphs in %.3f seconds\n", manygraph - failed, \
+           (ts1.tv_sec - ts0.tv_sec) + 1e-9*(ts1.tv_nsec - ts0.tv_nsec));
+    if (failed) rc = -1;
     }
+  for (n = 0; n < manygraph; n++) free(pgraph0[n].parg);
+  free(pgraph0); free(p1);
+  return rc;
+  }
+prdr = (struct rdr *)calloc(manyin, sizeof(struct rdr));
+pwantkolumn = (int *)calloc(manyin, sizeof(int));
+pblank = (int *)calloc(manyin, sizeof(int));
+pwant = (char **)calloc(manyin, sizeof(char *));
+pnatname = (char **)calloc(manyin, sizeof(char *));
+if ((NULL == prdr) || (NULL == pwantkolumn) || (NULL == pblank) || \
+                               (NULL == pwant) || (NULL == pnatname))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
   }
-if (isbad) return -1;
 p1 = strncpy(&outfnm[0], "gracov.out", FILENAME_MAX-2);
 if (strcmp(p1, &outfnm[0])) MESS;
 p1 = strncpy(&cmdfnm[0], "gnuplot.cmd", FILENAME_MAX-2);
@@ -142,10 +865,11 @@ if (strcmp(p1, &cmdfnm[0])) MESS;
 isbad = 0;
 for (n = 0; n < manyin; n++)
   {
-  if ( ! (pfin[n] = fopen(&infnm[n][0], "r")))
+  pwant[n] = argv[2*n + 2];
+  if (0 > rdropen(prdr + n, argv[2*n + 1])) { isbad++; continue; }
+  if (0 > (pwantkolumn[n] = rdrcolumn(prdr + n, pwant[n])))
     {
-    fprintf(stderr, "ERROR: cannot open input file: %s\n", &infnm[n][0]);
-    isbad++;
+    fprintf(stderr, "ERROR: heading not found: %s\n", pwant[n]); isbad++;
     }
   }
 if (isbad) return -1;
@@ -154,132 +878,52 @@ if ( ! (pfout = fopen(&outfnm[0], "w")))
   fprintf(stderr, "ERROR: cannot open output file: %s\n", &outfnm[0]);
   return -1;
   }
-
-for (n = 0; n < manyin; n++)
-  {
-  manykolumn[n] = 0; bf[n][BFSZ-4] = 0; line[n] = 0; blank[n] = 0; 
-  wantkolumn[n] = -1;
-  }
+/*-----------------------------------------------------------------------------
+ONE ROW OF EACH FILE AT A TIME: ITS FIRST COLUMN AND ITS COLUMN OF INTEREST,
+OR BLANKS ONCE THE FILE IS USED UP
+-----------------------------------------------------------------------------*/
 lineout = 0;
 while (1)
   {
-  kolout = 0;
-  for (n = 0; n < manyin; n++)
+  for (n = 0, m = 0; n < manyin; n++)
     {
-    if ( ! blank[n])
+    if ( ! pblank[n])
       {
-      if (NULL == (p1 = fgets(&bf[n][0], BFSZ-2, pfin[n]))) blank[n] = 1;
-      else
-        {
-        (line[n])++;
-        if (bf[n][BFSZ-4])
-          {
-          fprintf(stderr, "ERROR: line %i too long in file %s\n", \
-                                            line[n], &infnm[n][0]); return -1;
-          }
-        p1 = &bf[n][0]; while ( *p1 && ('\r' != *p1) && ('\n' != *p1)) {p1++; }
-        *p1 = 0;
-        }
+      if (0 > (rc = rdrnext(prdr + n))) return -1;
+      if ( ! rc) pblank[n] = 1; else m++;
       }
     }
-  for (n = 0; n < manyin; n++) { if ( ! blank[n]) break; }
-  if (n >= manyin) break;
+  if ( ! m) break;
+  kolout = 0;
   for (n = 0; n < manyin; n++)
     {
-    latch = 0;
-    if (blank[n])
+    if (pblank[n])
       {
       if ( ! kolout) fprintf(pfout,"        ");
       else           fprintf(pfout,",       ");
-      latch++; kolout++;
       fprintf(pfout, ",          ");
-      latch++; kolout++;
+      kolout += 2;
       continue;
       }
-    p1 = &bf[n][0]; kolumn = 0;
-    while (*p1)
-      {
-      while (isspace((int) *p1 )) { p1++; }
-      if ( ! *p1) break;
-      p2 = p1;
-
-      while (*p2 && ( ! isspace((int)*p2))) { p2++; }
-      c = *p2; *p2 = 0;
-/*-----------------------------------------------------------------------------
-CAPTURE THE COLUMN HEADINGS APPEARING ON THE FIRST LINE OF THE INPUT FILES, ...
------------------------------------------------------------------------------*/
-      if (1 == line[n])
-        {
-        strcpy(&head[n][manykolumn[n]][0], p1); (manykolumn[n])++;
-        if ( ! strcmp(&want[n][0], p1)) wantkolumn[n] = kolumn;
-        }
-/*-----------------------------------------------------------------------------
-... AND CAPTURE THE DATA FROM THE REMAINING LINES.
------------------------------------------------------------------------------*/
-      else
-        {
-        char *pend;
-
-        if (2 > line[n]) MESS;
-        if (MANYCOLUMN <= kolumn) MESS;
-        if (manykolumn[n] <= kolumn) MESS;
-        if (0 > wantkolumn[n])
-          {
-          fprintf(stderr, "ERROR: heading not found: %s\n", &want[n][0]);
-          return -1;
-          }
-        data[n][kolumn] = strtod(p1, &pend);
-        if ((ERANGE == errno) || ((0. == data[n][kolumn]) && (p1 == pend)))
-          {
-          fprintf(stderr, "ERROR: cannot understand data at column %i, " \
-             "line %i in file %s\n", kolumn, line[n], &infnm[n][0]); return -1;
-          }
-        if ( ! kolumn)
-          {
-          if ( ! kolout) fprintf(pfout, " %7.0f", data[0][0]);
-          else           fprintf(pfout, ",%7.0f", data[n][0]);
-          latch++; kolout++;
-          }
-        if (wantkolumn[n] == kolumn)
-          {
-          fprintf(pfout, ",%10.2e", data[n][kolumn]);
-          latch++; kolout++;
-          }
-        }
-      *p2 = c; p1 = p2; if (*p1) p1++;
-/*---------------------------------------------------------------------------*/
-      kolumn++;
-      }
-    if ((1 != line[n]) && (2 != latch))
-      {
-      fprintf(stderr, "ERROR: insufficient data at line %i in file %s\n", \
-                                             line[n], &infnm[n][0]); return -1;
-      }
-    }
-  if (1 == line[0])
-    {
-    for (n = 1; n < manyin; n++) { if (1 != line[n]) break; }
-    if (n < manyin)
-      {
-      fprintf(stderr, "ERROR: at least one input file has no first line\n");
-      return -1;
-      }
+    if ( ! kolout) fprintf(pfout, " %7.0f", prdr[n].prow[0]);
+    else           fprintf(pfout, ",%7.0f", prdr[n].prow[0]);
+    fprintf(pfout, ",%10.2e", prdr[n].prow[pwantkolumn[n]]);
+    kolout += 2;
     }
-  else fprintf(pfout, "\n");
+  fprintf(pfout, "\n");
   lineout++;
   }
+rc = 0;
 /*-----------------------------------------------------------------------------
 WRITE THE OUTPUT FILE  ./gnuplot.cmd
 -----------------------------------------------------------------------------*/
-snprintf(&natname[0][0], BFSZHDR-2, "%s", "BaseCase");
-snprintf(&natname[0][0], BFSZHDR-2, "%s", "BaseCase");
 for (n = 0; n < manyin; n++)
   {
-  p1 = &infnm[n][0];
+  p1 = argv[2*n + 1];
   p2 = p1;
   while (*p2) { if ('/' == *p2) p1 = p2; p2++; }
   if ('/' == *p1) p1++;
-  sprintf(&natname[n][0], "%s", p1);
+  pnatname[n] = p1;
   }
 if ( ! (pfcmd = fopen(&cmdfnm[0], "w")))
   {
@@ -294,7 +938,7 @@ fprintf(pfcmd,
     "#\n"
     "#\n"
     "# WRITTEN BY: %s\n"
-    "#-------------------------------------------------------\n", argv[0]);
+    "#-------------------------------------------------------\n", pprog);
 
 if (1)
   {
@@ -304,14 +948,14 @@ if (1)
 #if defined(TITLE)
   for (n = 1; n < manyin; n++)
     {
-    if (strcmp(&infnm[0][0], &infnm[n][0]))
+    if (strcmp(argv[1], argv[2*n + 1]))
       {
       strcpy(&title[0], &datetimestr[0]); break;
       }
     }
   if ( ! title[0])
     {
-    p1 = &infnm[0][0];
+    p1 = argv[1];
     p2 = p1; while (*p2) { if ('/' == *p2) p1 = p2; p2++; }
     p2 = &title[0]; if ( '/' == *p1) p1++;
     strcpy(&title[0], p1);
@@ -333,38 +977,19 @@ if (1)
     "set terminal svg dashed font \\\n"
 */
 
-  ylabel[0] = 0;
-  for (n = 0; n < manyin; n++)
-    {
-    int jack;
-
-    jack = 0;
-    for (m = 0; m < n; n++)
-      {
-      if (strcmp(&want[m][0], &want[n][0])) { jack = 1; break; }
-      }
-    if ( ! jack)
-      {
-      if (n) strcat(&ylabel[0], ", ");
-      if ((ORDINATE_MAX - 8) > (strlen(&ylabel[0]) + strlen(&want[n][0])))
-        {
-        strcat(&ylabel[0], &want[n][0]);
-        }
-      else { strcat(&ylabel[0], "..."); break; }
-      }
-    }
+  ylabelof(argv + 1, manyin, &ylabel[0]);
   fprintf(pfcmd,
     "set ylabel \"%s\"\n", &ylabel[0]);
 
   fprintf(pfcmd,
     "set output \"%s.svg\"\n"
-    "plot \'./gracov.out\' \\\n", &want[0][0]);
+    "plot \'./gracov.out\' \\\n", pwant[0]);
   for (n = 0; n < manyin; n++)
     {
     if (n) fprintf(pfcmd, "'' ");
     else   fprintf(pfcmd, "   ");
     fprintf(pfcmd, "  using %i:%i title \"%s\" with points",
-                              (2*n)+1, (2*n)+2, &natname[n][0]);
+                              (2*n)+1, (2*n)+2, pnatname[n]);
     if ( (manyin - 1) != n ) fprintf(pfcmd, ", \\");
     fprintf(pfcmd, "\n");
     }
@@ -374,20 +999,8 @@ if ( 0 != fclose(pfcmd) )
   {
   fprintf(stderr, "ERROR: cannot close file %s\n", &cmdfnm[0]); return -1;
   }
-isbad = 0;
-for (n = 0; n < manyin; n++)
-  {
-  if (ferror(pfin[n]))
-    {
-    fprintf(stderr, "ERROR: cannot  read input file: %s\n", &infnm[n][0]);
-    isbad++;
-    }
-  if (0 != fclose(pfin[n]))
-    {
-    fprintf(stderr, "ERROR: cannot close file %s\n", &infnm[n][0]); isbad++;
-    }
-  }
-if (isbad) return -1;
+for (n = 0; n < manyin; n++) { rdrclose(prdr + n); }
+free(prdr); free(pwantkolumn); free(pblank); free(pwant); free(pnatname);
 
 if ( 0 != fclose(pfout) )
   {
@@ -0,0 +1,76 @@
+/* ************************************************************//** @file hyb.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the hybrid engine, which hands the
+       bulk of an epidemic to a pair approximation.
+*//* *************************************************************************/
+
+#ifndef COV_HYBRID_H
+#define COV_HYBRID_H
+
+#include "epi.h"
+#include "ana.h"
+
+#define HYB_CLUSTERED (0.25)  /**< Clustering coefficient above which the
+                                   approximation never takes over           */
+
+/** What the approximation needs to know of a network, from hybmeasure() */
+struct hybnet
+  {
+  int      manydegree;  /**< One more than the greatest degree               */
+  double   clustering;  /**< Clustering coefficient, as anaclustering()      */
+  };
+
+/** A run that leaves the simulation while many nodes are infected */
+struct hybrid
+  {
+  double   up;          /**< Fraction of nodes infected, not yet recovered,
+                             at which the approximation takes over           */
+  double   down;        /**< Fraction below which the simulation resumes     */
+  int      on;          /**< Non-zero while the approximation runs           */
+  int      manyswitch;  /**< Times it has taken over                         */
+  int      over;        /**< Set once no node is left infectious or latent   */
+  int      declined;    /**< Set if too clustered ever to take over          */
+  double   clustering;  /**< Clustering coefficient of the network           */
+  int      manydegree;  /**< One more than the greatest degree               */
+  int      manyday;     /**< Days of history room is made for                */
+  int      day0;        /**< Day on which it last took over                  */
+  double  *ps;          /**< Fraction of nodes susceptible, by degree        */
+  double  *ps0;         /**< The same, when it took over                     */
+  double  *pinert;      /**< Fraction of nodes inert, by degree              */
+  double  *pc;          /**< Fraction of nodes by days since infection, from
+                             1 to recovery-1, then recovered at [recovery]   */
+  double  *ppi;         /**< Fraction of the links of susceptible nodes to
+                             susceptible nodes at [0], then by days since
+                             infection as .pc                                */
+  double  *pnew;        /**< Infections, [day since .day0][degree]           */
+  double  *pwork;       /**< Room for one more of .ppi                       */
+  };
+
+int  hybmeasure(struct hybnet *, int, struct node *, int, \
+                                                    const struct analytics *);
+int  hybinit(struct hybrid *, const struct epidemic *, const struct hybnet *, \
+                                                       double, double, int);
+void hybday(struct hybrid *, struct epidemic *);
+void hybfree(struct hybrid *);
+
+#endif /*COV_HYBRID_H*/
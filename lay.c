@@ -0,0 +1,279 @@
+/* ************************************************************//** @file hyb.c
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief The layers of contacts: further networks on the nodes of the first,
+       each built by its own generator and kept as a compact block.
+
+A layer is given to cov as  kind,parameters,chance:
+
+  swn,halfdegree,beta,chance   a network of swn(), seeded from seedswn and
+                               the number of the layer;
+  clique,size,chance           the nodes dealt at random into cliques of
+                               size nodes, such as households;
+  file,path,chance             an edge list or image, as for netload().
+
+Whatever the generator, the layer is copied into one block of node numbers,
+four bytes a link rather than the eight of a pointer, each list sorted so
+that the sweep reads the states of the neighbours in the order they lie in
+memory, and the network of the generator released.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "swn.h"
+#include "net.h"
+#include "par.h"
+#include "lay.h"
+
+/* ************************************************************************//**
+@brief   Order of node numbers, for qsort().
+*//***************************************************************************/
+static int
+ ascending(const void *pa, const void *pb)
+{
+return (*(const int *)pa > *(const int *)pb) - \
+                                       (*(const int *)pa < *(const int *)pb);
+}
+/* ************************************************************************//**
+@brief   Allocate the block of a layer, given the degree of each node at
+         .pfirst[1..manynode], and set .pfirst to where each list begins.
+*//***************************************************************************/
+static int
+ room(struct layer *pl, int manynode)
+{
+int j;
+
+pl->pfirst[0] = 0;
+for (j = 0; j < manynode; j++) pl->pfirst[j + 1] += pl->pfirst[j];
+pl->manynode = manynode; pl->manystub = pl->pfirst[manynode];
+if (NULL == (pl->pnbr = (int *)malloc((pl->manystub + 1) * sizeof(int))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Copy a network of swn() or netload() into the block of a layer.
+*//***************************************************************************/
+static int
+ compact(struct layer *pl, int manynode, struct node *pnode0)
+{
+struct node **pp;
+long k;
+int j, rc;
+
+for (j = 0; j < manynode; j++)
+  {
+  for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++) { pl->pfirst[j + 1]++; }
+  }
+if (0 > (rc = room(pl, manynode))) return rc;
+for (j = 0, k = 0; j < manynode; j++)
+  {
+  for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+    {
+    *(pl->pnbr + k++) = (int)(*pp - pnode0);
+    }
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Deal the nodes at random into cliques, the last maybe smaller.
+*//***************************************************************************/
+static int
+ clique(struct layer *pl, int manynode, uint64_t state)
+{
+int *pdeal, *pnbr;
+int i, j, m, swap, first, last;
+
+if (NULL == (pdeal = (int *)malloc(manynode * sizeof(int))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (i = 0; i < manynode; i++) *(pdeal + i) = i;
+for (i = manynode - 1; i > 0; i--)
+  {
+  j = (int)rngbelow(&state, i + 1);
+  swap = *(pdeal + i); *(pdeal + i) = *(pdeal + j); *(pdeal + j) = swap;
+  }
+for (first = 0; first < manynode; first += pl->size)
+  {
+  last = (first + pl->size < manynode) ? first + pl->size : manynode;
+  for (i = first; i < last; i++) pl->pfirst[*(pdeal + i) + 1] = last-first-1;
+  }
+if (0 > room(pl, manynode)) { free(pdeal); return -8; }
+for (first = 0; first < manynode; first += pl->size)
+  {
+  last = (first + pl->size < manynode) ? first + pl->size : manynode;
+  for (i = first; i < last; i++)
+    {
+    pnbr = pl->pnbr + pl->pfirst[*(pdeal + i)];
+    for (m = first; m < last; m++)
+      {
+      if (m != i) *pnbr++ = *(pdeal + m);
+      }
+    }
+  }
+free(pdeal);
+return 0;
+}
+/* ************************************************************************//**
+@brief   Parse the description of a layer, as given to cov.
+@param   pspec  The description, which for a file is cut at its last comma
+                and must outlive the layer, as .path points into it.
+@param   pl     Set to the layer, not yet built.
+@return         Zero unless error.
+*//***************************************************************************/
+int
+ layparse(char *pspec, struct layer *pl)
+{
+char *pend, *pcomma;
+
+memset(pl, 0, sizeof(struct layer));
+errno = 0;
+if (NULL == (pcomma = strrchr(pspec, ','))) return -1;
+if ( ! strncmp(pspec, "swn,", 4))
+  {
+  pl->kind = LAY_SWN;
+  pl->halfdegree = (int)strtol(pspec + 4, &pend, 10);
+  if ((',' != *pend) || (0 >= pl->halfdegree)) return -1;
+  pl->dbeta = strtod(pend + 1, &pend);
+  if ((pcomma != pend) || (0. > pl->dbeta) || (1. <= pl->dbeta)) return -1;
+  }
+else if ( ! strncmp(pspec, "clique,", 7))
+  {
+  pl->kind = LAY_CLIQUE;
+  pl->size = (int)strtol(pspec + 7, &pend, 10);
+  if ((pcomma != pend) || (2 > pl->size)) return -1;
+  }
+else if ( ! strncmp(pspec, "file,", 5) && (pspec + 5 < pcomma))
+  {
+  pl->kind = LAY_FILE;
+  pl->path = pspec + 5;
+  }
+else return -1;
+pl->dchance = strtod(pcomma + 1, &pend);
+if (errno || *pend) return -1;
+pl->chance = (int)(nearbyint(1024. * pl->dchance));
+if ((0 > pl->chance) || (1024 < pl->chance)) return -1;
+if (LAY_FILE == pl->kind) *pcomma = 0;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Build a layer by its generator.
+@param   pl        The layer, as parsed by layparse().
+@param   seedswn   Seed of the network of cov, from which that of the layer
+                   is drawn.
+@param   index     The number of the layer, from 1.
+@param   manynode  The number of nodes.
+@return            Zero unless error.
+*//***************************************************************************/
+int
+ laybuild(struct layer *pl, unsigned int seedswn, int index, int manynode)
+{
+struct node *pnode0;
+uint64_t state;
+long j;
+int many, rc;
+
+pl->pnbr = NULL;
+if (NULL == (pl->pfirst = (long *)calloc(manynode + 1, sizeof(long))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+state = rngstream(seedswn, 0x4C415900 + index);
+pnode0 = NULL; many = manynode; rc = 0;
+switch (pl->kind)
+  {
+  case LAY_SWN:
+    if (manynode < 1 + 2 * pl->halfdegree)
+      {
+      fprintf(stderr, "ERROR: too few nodes for layer %i\n", index);
+      rc = -1; break;
+      }
+    if (0 > (rc = swn((unsigned int)(state >> 32), manynode, pl->halfdegree, \
+                                                      pl->dbeta, &pnode0)))
+      {
+      break;
+      }
+    rc = compact(pl, manynode, pnode0);
+    if (0 > swn(0, manynode, 0, 0., &pnode0))
+      {
+      fprintf(stderr, "WORRY: failed to free memory allocated by swn()\n");
+      }
+    break;
+  case LAY_CLIQUE:
+    rc = clique(pl, manynode, state);
+    break;
+  case LAY_FILE:
+    if (0 > (rc = netload(pl->path, &many, &pnode0))) break;
+    if (many != manynode)
+      {
+      fprintf(stderr, "ERROR: layer %i has %i nodes, not %i\n", index, \
+                                                            many, manynode);
+      rc = -1;
+      }
+    else rc = compact(pl, manynode, pnode0);
+    netfree(many, &pnode0);
+    break;
+  }
+if (0 > rc) { layfree(pl); return rc; }
+/*-----------------------------------------------------------------------------
+SORT EACH LIST, SO THAT THE SWEEP READS THE STATES IN ORDER
+-----------------------------------------------------------------------------*/
+for (j = 0; j < manynode; j++)
+  {
+  qsort(pl->pnbr + pl->pfirst[j], pl->pfirst[j + 1] - pl->pfirst[j], \
+                                                    sizeof(int), ascending);
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Describe a layer for the name of an output file.
+*//***************************************************************************/
+void
+ layname(char *pname, size_t room, const struct layer *pl)
+{
+const char *pbase;
+
+if (LAY_SWN == pl->kind) snprintf(pname, room, "swn%i,%5.3f,%4.2f", \
+                                    pl->halfdegree, pl->dbeta, pl->dchance);
+else if (LAY_CLIQUE == pl->kind) snprintf(pname, room, "clique%i,%4.2f", \
+                                                      pl->size, pl->dchance);
+else
+  {
+  pbase = strrchr(pl->path, '/');
+  snprintf(pname, room, "file%s,%4.2f", pbase ? pbase + 1 : pl->path, \
+                                                              pl->dchance);
+  }
+}
+/* ************************************************************************//**
+@brief   Release the block of a layer.
+*//***************************************************************************/
+void
+ layfree(struct layer *pl)
+{
+free(pl->pnbr); pl->pnbr = NULL;
+free(pl->pfirst); pl->pfirst = NULL;
+}
+/* ***************************************************************************/
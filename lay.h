@@ -0,0 +1,61 @@
+/* ************************************************************//** @file hyb.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the layers of contacts, which add to the
+       network of swn() others on the same nodes, each with its own chance.
+
+Each layer is built by a generator of its own and kept as a compact block:
+the neighbours of all the nodes as node numbers end to end, each list in
+ascending order, and where each list begins.
+*//* *************************************************************************/
+
+#ifndef COV_LAYER_H
+#define COV_LAYER_H
+
+#include <stdio.h>
+
+/** Generators of a layer */
+enum { LAY_SWN, LAY_CLIQUE, LAY_FILE };
+
+/** A further network of contacts on the nodes of the first */
+struct layer
+  {
+  int          kind;        /**< Its generator, LAY_SWN and so on            */
+  int          halfdegree;  /**< For LAY_SWN, half the degree of the ring    */
+  double       dbeta;       /**< For LAY_SWN, the rewiring fraction          */
+  int          size;        /**< For LAY_CLIQUE, the nodes of each clique    */
+  const char  *path;        /**< For LAY_FILE, the edge list or image        */
+  double       dchance;     /**< Chance of infection per neighbour per day   */
+  int          chance;      /**< The same, in 1024ths                        */
+  int          manynode;    /**< The number of nodes, once built             */
+  long         manystub;    /**< Total length of the neighbour lists         */
+  long        *pfirst;      /**< Where the list of each node begins, and at
+                                 [manynode] where the last ends              */
+  int         *pnbr;        /**< The lists, end to end                       */
+  };
+
+int  layparse(char *, struct layer *);
+int  laybuild(struct layer *, unsigned int, int, int);
+void layname(char *, size_t, const struct layer *);
+void layfree(struct layer *);
+
+#endif /*COV_LAYER_H*/
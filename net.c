@@ -0,0 +1,531 @@
+/* ************************************************************//** @file net.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Functions for compact ("slab") networks: import, save and release.
+
+Three input formats are accepted by netload(), distinguished by their leading
+bytes:                                                                      \n
+(a) a network image written by netsave(), beginning with NET_MAGIC_IMAGE;   \n
+(b) a binary edge list, beginning with NET_MAGIC_EDGES and followed by pairs
+    of native-endian 32-bit node numbers;                                   \n
+(c) anything else is read as a text edge list: whitespace-separated pairs of
+    non-negative node numbers, with '#' or '%' starting a comment which runs
+    to the end of the line.                                                 \n
+Edge lists are read twice: once to count the degree of every node, and once
+to fill the neighbour lists.  No memory is requested per edge.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <assert.h>
+#include "net.h"
+
+#define NET_BFSZ   (1 << 20)  /**< Bytes read from an input file at a time   */
+#define NET_MANYID (1 << 16)  /**< Node numbers written to an image at a time */
+
+/** State of the reader of an edge list */
+struct scan
+  {
+  FILE     *pf;               /**< The input file                            */
+  int       binary;           /**< Flag set if the edge list is binary       */
+  long      line;             /**< Line number, for text diagnostics         */
+  size_t    at;               /**< Next unread byte in .bf                   */
+  size_t    end;              /**< Count of valid bytes in .bf               */
+  char     *bf;               /**< Buffer of NET_BFSZ bytes                  */
+  };
+
+/* ************************************************************************//**
+@brief   Refill the buffer of an edge-list reader.
+@return  Count of bytes now available; zero at end of file.
+*//***************************************************************************/
+static size_t
+ refill(struct scan *ps)
+{
+size_t keep;
+
+keep = ps->end - ps->at;
+if (keep) memmove(ps->bf, ps->bf + ps->at, keep);
+ps->at = 0;
+ps->end = keep + fread(ps->bf + keep, 1, NET_BFSZ - keep, ps->pf);
+return ps->end;
+}
+/* ************************************************************************//**
+@brief   Read the next node number from a text edge list.
+@return  1 => value delivered; 0 => end of file; <0 => error.
+*//***************************************************************************/
+static inline int
+ scantext(struct scan *ps, int *pid)
+{
+long val;
+char c;
+
+while (1)
+  {
+  if ((ps->at >= ps->end) && ( ! refill(ps))) return 0;
+  c = ps->bf[ps->at];
+  if (('#' == c) || ('%' == c))
+    {
+    while (1)
+      {
+      if ((ps->at >= ps->end) && ( ! refill(ps))) return 0;
+      if ('\n' == ps->bf[ps->at]) break;
+      ps->at++;
+      }
+    continue;
+    }
+  if ('\n' == c) ps->line++;
+  if ((' ' == c) || ('\t' == c) || ('\n' == c) || ('\r' == c) || (',' == c))
+    {
+    ps->at++; continue;
+    }
+  break;
+  }
+if (('0' > c) || ('9' < c))
+  {
+  fprintf(stderr, "ERROR: not a node number at line %li\n", ps->line + 1);
+  return -1;
+  }
+val = 0;
+while (1)
+  {
+  if ((ps->at >= ps->end) && ( ! refill(ps))) break;
+  c = ps->bf[ps->at];
+  if (('0' > c) || ('9' < c)) break;
+  val = (10 * val) + (c - '0');
+  if (INT_MAX <= val)
+    {
+    fprintf(stderr, "ERROR: node number too large at line %li\n", \
+                                                      ps->line + 1); return -1;
+    }
+  ps->at++;
+  }
+*pid = (int)val;
+return 1;
+}
+/* ************************************************************************//**
+@brief   Read the next edge from an edge list of either kind.
+@return  1 => edge delivered; 0 => end of file; <0 => error.
+*//***************************************************************************/
+static inline int
+ scanedge(struct scan *ps, int *pu, int *pv)
+{
+uint32_t pair[2];
+int rc;
+
+if (ps->binary)
+  {
+  if ((ps->end - ps->at) < sizeof(pair))
+    {
+    if ((refill(ps) - ps->at) < sizeof(pair))
+      {
+      if (ps->end == ps->at) return 0;
+      fprintf(stderr, "ERROR: binary edge list has a truncated edge\n");
+      return -1;
+      }
+    }
+  memcpy(pair, ps->bf + ps->at, sizeof(pair)); ps->at += sizeof(pair);
+  if ((INT_MAX <= pair[0]) || (INT_MAX <= pair[1]))
+    {
+    fprintf(stderr, "ERROR: node number too large in binary edge list\n");
+    return -1;
+    }
+  *pu = (int)pair[0]; *pv = (int)pair[1];
+  return 1;
+  }
+if (0 >= (rc = scantext(ps, pu))) return rc;
+if (0 >= (rc = scantext(ps, pv)))
+  {
+  if (0 == rc) fprintf(stderr, "ERROR: odd count of node numbers\n");
+  return -1;
+  }
+return 1;
+}
+/* ************************************************************************//**
+@brief   Allocate a slab network with prescribed degrees.
+@param   manynode    The number of nodes.
+@param   pdegree     The number of neighbours each node is to have.
+@param   ppnode0     Location to receive the base of the array of nodes.
+@return              Zero unless error.
+@note    Every neighbour list is returned filled with NULL, i.e. empty, and
+         may be filled by the caller in any order without overrunning its
+         terminator provided no node receives more than its .pdegree entries.
+*//***************************************************************************/
+int
+ netslab(int manynode, const int *pdegree, struct node **ppnode0)
+{
+struct node *pnode0, **pp;
+size_t total;
+int j;
+
+*ppnode0 = NULL;
+for (j = 0, total = 0; j < manynode; j++)
+  {
+  if (0 > *(pdegree + j)) return -1;
+  total += (size_t)(*(pdegree + j)) + 1;
+  }
+if (NULL == (pnode0 = (struct node *)calloc(manynode, sizeof(struct node))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+if (NULL == (pp = (struct node **)calloc(total, sizeof(struct node *))))
+  {
+  free(pnode0);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (j = 0; j < manynode; j++)
+  {
+  (pnode0 + j)->pp0 = pp;
+  pp += *(pdegree + j) + 1;
+  }
+*ppnode0 = pnode0;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Release a slab network.
+@param   manynode    The number of nodes.
+@param   ppnode0     Location of the base of the array of nodes; on return
+                     it holds NULL.
+*//***************************************************************************/
+void
+ netfree(int manynode, struct node **ppnode0)
+{
+(void)manynode;
+if (NULL == *ppnode0) return;
+free((*ppnode0)->pp0);
+free(*ppnode0); *ppnode0 = NULL;
+}
+/* ************************************************************************//**
+@brief   Order of neighbours within a list, for qsort().
+*//***************************************************************************/
+static int
+ byaddress(const void *pa, const void *pb)
+{
+const struct node *a = *(struct node *const *)pa;
+const struct node *b = *(struct node *const *)pb;
+
+return (a > b) - (a < b);
+}
+/* ************************************************************************//**
+@brief   Put a list of neighbours in order of address.
+@param   pp0         The list.
+@param   sz          The number of neighbours in the list.
+*//***************************************************************************/
+void
+ netsort(struct node **pp0, size_t sz)
+{
+struct node *pnode, **pp, **ppto;
+
+if (32 < sz) { qsort(pp0, sz, sizeof(struct node *), byaddress); return; }
+for (pp = pp0 + 1; pp < pp0 + sz; pp++)
+  {
+  pnode = *pp;
+  for (ppto = pp; (pp0 < ppto) && (pnode < *(ppto - 1)); ppto--)
+    {
+    *ppto = *(ppto - 1);
+    }
+  *ppto = pnode;
+  }
+}
+/* ************************************************************************//**
+@brief   Sort every neighbour list and remove duplicate neighbours.
+@param   manynode    The number of nodes.
+@param   pnode0      The base of the array of nodes.
+@return              The number of list entries removed.
+*//***************************************************************************/
+size_t
+ netsimplify(int manynode, struct node *pnode0)
+{
+struct node **pp, **ppto;
+size_t sz, gone;
+int j;
+
+gone = 0;
+for (j = 0; j < manynode; j++)
+  {
+  pp = (pnode0 + j)->pp0;
+  while (NULL != *pp) { pp++; }
+  sz = (size_t)(pp - (pnode0 + j)->pp0);
+  if (2 > sz) continue;
+  netsort((pnode0 + j)->pp0, sz);
+  pp = (pnode0 + j)->pp0; ppto = pp;
+  while (NULL != *(++pp)) { if (*pp != *ppto) *(++ppto) = *pp; }
+  while (++ppto < pp) { *ppto = NULL; gone++; }
+  }
+return gone;
+}
+/* ************************************************************************//**
+@brief   Read the remainder of a network image written by netsave().
+@return  Zero unless error.
+*//***************************************************************************/
+static int
+ loadimage(FILE *pf, const char *path, int *pmanynode, struct node **ppnode0)
+{
+struct node *pnode0, **pp;
+int64_t hdr[2];
+int32_t *pid;
+int *pdegree;
+size_t want, got, n;
+int j, left, rc;
+
+if (1 != fread(hdr, sizeof(hdr), 1, pf))
+  {
+  fprintf(stderr, "ERROR: truncated network image: %s\n", path); return -1;
+  }
+if ((0 >= hdr[0]) || (INT_MAX <= hdr[0]) || (0 > hdr[1]))
+  {
+  fprintf(stderr, "ERROR: corrupt network image: %s\n", path); return -1;
+  }
+assert(sizeof(int32_t) == sizeof(int));
+if (NULL == (pdegree = (int *)malloc(hdr[0] * sizeof(int))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+if ((size_t)hdr[0] != fread(pdegree, sizeof(int), hdr[0], pf))
+  {
+  fprintf(stderr, "ERROR: truncated network image: %s\n", path);
+  free(pdegree); return -1;
+  }
+for (j = 0, want = 0; j < hdr[0]; j++) { want += *(pdegree + j); }
+if ((size_t)hdr[1] != want)
+  {
+  fprintf(stderr, "ERROR: corrupt network image: %s\n", path);
+  free(pdegree); return -1;
+  }
+if (0 > (rc = netslab((int)hdr[0], pdegree, &pnode0)))
+  {
+  free(pdegree); return rc;
+  }
+if (NULL == (pid = (int32_t *)malloc(NET_MANYID * sizeof(int32_t))))
+  {
+  free(pdegree); netfree((int)hdr[0], &pnode0);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+/*-----------------------------------------------------------------------------
+THE NEIGHBOUR LISTS ARE STORED END-TO-END IN NODE ORDER, WITHOUT TERMINATORS
+-----------------------------------------------------------------------------*/
+j = 0; left = *pdegree; pp = pnode0->pp0;
+while (want && ( ! rc))
+  {
+  got = fread(pid, sizeof(int32_t), (NET_MANYID < want) ? NET_MANYID : want, \
+                                                                           pf);
+  if ( ! got) { rc = -1; break; }
+  for (n = 0; n < got; n++)
+    {
+    if ((0 > *(pid + n)) || (hdr[0] <= *(pid + n))) { rc = -1; break; }
+    while ( ! left) { j++; left = *(pdegree + j); pp = (pnode0 + j)->pp0; }
+    *pp++ = pnode0 + *(pid + n); left--;
+    }
+  want -= got;
+  }
+free(pid); free(pdegree);
+if (rc)
+  {
+  fprintf(stderr, "ERROR: corrupt network image: %s\n", path);
+  netfree((int)hdr[0], &pnode0); return rc;
+  }
+*pmanynode = (int)hdr[0];
+*ppnode0 = pnode0;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Construct a slab network from an edge list or a network image.
+@param   path        The input file.
+@param   pmanynode   Location to receive the number of nodes, which is one
+                     more than the largest node number found in the file.
+@param   ppnode0     Location to receive the base of the array of nodes.
+@return              Zero unless error.
+@note    Self-links are discarded, and an edge listed more than once (in
+         either direction) is linked only once.  Release with netfree().
+*//***************************************************************************/
+int
+ netload(const char *path, int *pmanynode, struct node **ppnode0)
+{
+struct scan scan0;
+struct node *pnode0;
+char magic[8];
+void *pvoid;
+int *pdegree;
+int manynode, room, was, m, u, v, pass, rc;
+size_t got, gone;
+long skip;
+
+*ppnode0 = NULL;
+if (NULL == (scan0.pf = fopen(path, "rb")))
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", path); return -16;
+  }
+got = fread(magic, 1, sizeof(magic), scan0.pf);
+if ((sizeof(magic) == got) && ( ! memcmp(magic, NET_MAGIC_IMAGE, \
+                                                            sizeof(magic))))
+  {
+  rc = loadimage(scan0.pf, path, pmanynode, ppnode0);
+  fclose(scan0.pf); return rc;
+  }
+scan0.binary = (sizeof(magic) == got) && \
+                               ! memcmp(magic, NET_MAGIC_EDGES, sizeof(magic));
+skip = scan0.binary ? (long)sizeof(magic) : 0L;
+if (NULL == (scan0.bf = (char *)malloc(NET_BFSZ)))
+  {
+  fclose(scan0.pf);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+/*-----------------------------------------------------------------------------
+PASS 0 COUNTS THE DEGREE OF EVERY NODE, GROWING THE COUNTS GEOMETRICALLY.
+PASS 1 FILLS THE NEIGHBOUR LISTS, USING THE COUNTS AS CURSORS.
+-----------------------------------------------------------------------------*/
+pdegree = NULL; pnode0 = NULL; manynode = 0; room = 0; rc = 0;
+for (pass = 0; (pass < 2) && ( ! rc); pass++)
+  {
+  if (fseek(scan0.pf, skip, SEEK_SET))
+    {
+    fprintf(stderr, "ERROR: cannot rewind input file: %s\n", path);
+    rc = -16; break;
+    }
+  scan0.at = 0; scan0.end = 0; scan0.line = 0;
+  while (0 < (rc = scanedge(&scan0, &u, &v)))
+    {
+    if (u == v) continue;
+    if (pass)
+      {
+      if ((manynode <= u) || (manynode <= v))
+        {
+        fprintf(stderr, "ERROR: input file changed while reading: %s\n", \
+                                                         path); rc = -1; break;
+        }
+      *((pnode0 + u)->pp0 + (*(pdegree + u))++) = pnode0 + v;
+      *((pnode0 + v)->pp0 + (*(pdegree + v))++) = pnode0 + u;
+      continue;
+      }
+    if (room <= ((u > v) ? u : v))
+      {
+      was = room; m = (u > v) ? u : v;
+      room = (INT_MAX / 2 > m) ? (2 * m) + 1 : INT_MAX;
+      if (NULL == (pvoid = realloc(pdegree, (size_t)room * sizeof(int))))
+        {
+        fprintf(stderr, "ERROR: memory request refused\n"); rc = -8; break;
+        }
+      pdegree = (int *)pvoid;
+      memset(pdegree + was, 0, (size_t)(room - was) * sizeof(int));
+      }
+    (*(pdegree + u))++; (*(pdegree + v))++;
+    if (manynode <= u) manynode = u + 1;
+    if (manynode <= v) manynode = v + 1;
+    }
+  if (rc) break;
+  if (pass) break;
+  if (ferror(scan0.pf) || ( ! manynode))
+    {
+    fprintf(stderr, "ERROR: no edges read from input file: %s\n", path);
+    rc = -1; break;
+    }
+  if (0 > (rc = netslab(manynode, pdegree, &pnode0))) break;
+  memset(pdegree, 0, (size_t)manynode * sizeof(int));
+  }
+free(scan0.bf); free(pdegree);
+fclose(scan0.pf);
+if (rc)
+  {
+  netfree(manynode, &pnode0); return (0 > rc) ? rc : -1;
+  }
+if (0 < (gone = netsimplify(manynode, pnode0)))
+  {
+  fprintf(stderr, "WORRY: %zu duplicate edges ignored in %s\n", gone/2, path);
+  }
+*pmanynode = manynode;
+*ppnode0 = pnode0;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Write a network image, for later use by netload().
+@param   path        The output file.
+@param   manynode    The number of nodes.
+@param   pnode0      The base of the array of nodes, which may have been
+                     constructed by swn() or by netload().
+@return              Zero unless error.
+@note    The image holds NET_MAGIC_IMAGE, the number of nodes and the total
+         length of the neighbour lists as two 64-bit integers, the degree of
+         every node, then the neighbour lists end-to-end, all as native-endian
+         32-bit integers.
+*//***************************************************************************/
+int
+ netsave(const char *path, int manynode, struct node *pnode0)
+{
+FILE *pf;
+struct node **pp;
+int64_t hdr[2];
+int32_t *pid;
+size_t n;
+int j, pass, rc;
+
+if (NULL == (pid = (int32_t *)malloc(NET_MANYID * sizeof(int32_t))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+if (NULL == (pf = fopen(path, "wb")))
+  {
+  free(pid);
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", path); return -16;
+  }
+hdr[0] = manynode; hdr[1] = 0;
+for (j = 0; j < manynode; j++)
+  {
+  pp = (pnode0 + j)->pp0;
+  while (NULL != *pp) { pp++; }
+  hdr[1] += pp - (pnode0 + j)->pp0;
+  }
+rc = 0;
+if (1 != fwrite(NET_MAGIC_IMAGE, 8, 1, pf)) rc = -16;
+if (1 != fwrite(hdr, sizeof(hdr), 1, pf))   rc = -16;
+/*-----------------------------------------------------------------------------
+PASS 0 WRITES THE DEGREES, PASS 1 THE NEIGHBOUR LISTS
+-----------------------------------------------------------------------------*/
+for (pass = 0; (pass < 2) && ( ! rc); pass++)
+  {
+  for (j = 0, n = 0; (j < manynode) && ( ! rc); j++)
+    {
+    for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+      {
+      if (pass) *(pid + n++) = (int32_t)(*pp - pnode0);
+      if (NET_MANYID == n)
+        {
+        if (n != fwrite(pid, sizeof(int32_t), n, pf)) rc = -16;
+        n = 0;
+        }
+      }
+    if ( ! pass) *(pid + n++) = (int32_t)(pp - (pnode0 + j)->pp0);
+    if (NET_MANYID == n)
+      {
+      if (n != fwrite(pid, sizeof(int32_t), n, pf)) rc = -16;
+      n = 0;
+      }
+    }
+  if (n && (n != fwrite(pid, sizeof(int32_t), n, pf))) rc = -16;
+  }
+free(pid);
+if (fclose(pf)) rc = -16;
+if (rc) fprintf(stderr, "ERROR: failed to write network image: %s\n", path);
+return rc;
+}
+/* ***************************************************************************/
@@ -0,0 +1,48 @@
+/* ************************************************************//** @file net.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the compact ("slab") network functions.
+
+A slab network uses the same  struct node  as swn(), but all the neighbour
+lists live end-to-end in a single allocation whose base is the  .pp0  of the
+first node.  Such a network must be released with netfree(), never with swn().
+*//* *************************************************************************/
+
+#ifndef NETWORK_SLAB_H
+#define NETWORK_SLAB_H
+
+#include <stddef.h>
+#include "swn.h"
+
+/** Leading bytes of a binary network image written by netsave() */
+#define NET_MAGIC_IMAGE "COVSWNI1"
+/** Leading bytes of a binary edge list: pairs of 32-bit node numbers follow */
+#define NET_MAGIC_EDGES "COVSWNE1"
+
+int    netslab(int, const int *, struct node **);
+int    netload(const char *, int *, struct node **);
+int    netsave(const char *, int, struct node *);
+void   netsort(struct node **, size_t);
+size_t netsimplify(int, struct node *);
+void   netfree(int, struct node **);
+
+#endif /*NETWORK_SLAB_H*/
@@ -0,0 +1,75 @@
+/* ************************************************************//** @file par.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Function for running a function on several threads.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "par.h"
+
+/* ************************************************************************//**
+@brief   Call a function once for each of several arguments, concurrently.
+@param   manythread  The number of calls, each on its own thread.
+@param   pfn         The function.
+@param   parg0       The first argument: an array of  manythread  elements.
+@param   szarg       The size of each element of the array at  parg0.
+@return              Zero unless error.
+@note    The calling thread makes the first call itself.  Should a thread be
+         refused, its call is made by the calling thread instead, so every
+         call is made exactly once whatever happens.
+*//***************************************************************************/
+int
+ parallel(int manythread, void *(*pfn)(void *), void *parg0, size_t szarg)
+{
+pthread_t *ptid;
+char *pjoin;
+int n;
+
+if (1 >= manythread)
+  {
+  if (1 == manythread) (*pfn)(parg0);
+  return 0;
+  }
+if (NULL == (ptid = (pthread_t *)malloc(manythread * sizeof(pthread_t))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+if (NULL == (pjoin = (char *)calloc(manythread, 1)))
+  {
+  free(ptid); fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 1; n < manythread; n++)
+  {
+  if ( ! pthread_create(ptid + n, NULL, pfn, (char *)parg0 + (n * szarg))) \
+                                                                *(pjoin + n) = 1;
+  }
+(*pfn)(parg0);
+for (n = 1; n < manythread; n++)
+  {
+  if (*(pjoin + n)) pthread_join(*(ptid + n), NULL);
+  else              (*pfn)((char *)parg0 + (n * szarg));
+  }
+free(pjoin); free(ptid);
+return 0;
+}
+/* ***************************************************************************/
@@ -0,0 +1,73 @@
+/* ************************************************************//** @file par.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header for running a function on several threads, and for the
+       counter-based random numbers which keep threaded results independent
+       of the number of threads.
+*//* *************************************************************************/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+int parallel(int, void *(*)(void *), void *, size_t);
+
+/* ************************************************************************//**
+@brief   Scramble a 64-bit integer (the finaliser of splitmix64).
+*//***************************************************************************/
+static inline uint64_t
+ rngmix(uint64_t x)
+{
+x += 0x9E3779B97F4A7C15ULL;
+x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+return x ^ (x >> 31);
+}
+/* ************************************************************************//**
+@brief   Seed a stream which depends only on a seed and a stream number.
+*//***************************************************************************/
+static inline uint64_t
+ rngstream(uint64_t seed, uint64_t stream)
+{
+return rngmix(seed ^ rngmix(stream));
+}
+/* ************************************************************************//**
+@brief   Next value from a stream (splitmix64).
+*//***************************************************************************/
+static inline uint64_t
+ rngnext(uint64_t *pstate)
+{
+*pstate += 0x9E3779B97F4A7C15ULL;
+return rngmix(*pstate);
+}
+/* ************************************************************************//**
+@brief   Next value from a stream, uniform on  0 <= value < n.
+*//***************************************************************************/
+static inline uint32_t
+ rngbelow(uint64_t *pstate, uint32_t n)
+{
+return (uint32_t)(((rngnext(pstate) >> 32) * (uint64_t)n) >> 32);
+}
+
+#endif /*PARALLEL_H*/
@@ -0,0 +1,851 @@
+/* ************************************************************//** @file plt.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Built-in renderer of graphs, writing SVG or PNG.
+
+The layout of a graph (the ranges and ticks of its axes, the margins, the
+legend) is worked out once, in pixels, and then drawn either as SVG text or
+into a raster of palette indices, so that the two look alike.  Text in the
+raster is drawn from a 5x7 font held below, doubled in size for graphs of
+480 pixels or more.  The PNG is compressed by deflate with its fixed Huffman
+codes, finding only repeats of the previous pixel or of the pixel above,
+which is all that a raster of flat colours and lines needs and is quick.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "plt.h"
+
+/** Colours of the palette: the paper, the ink, the grid, then the series */
+static const unsigned char palette[][3] =
+  {
+  {255, 255, 255}, {  0,   0,   0}, {221, 221, 221}, { 31, 119, 180},
+  {214,  39,  40}, { 44, 160,  44}, {255, 127,  14}, {148, 103, 189},
+  {140,  86,  75}, {227, 119, 194}, { 23, 190, 207}
+  };
+#define PLT_PAPER    (0)      /**< Index of the background colour            */
+#define PLT_INK      (1)      /**< Index of the colour of axes and text      */
+#define PLT_GRID     (2)      /**< Index of the colour of the gridlines      */
+#define PLT_SERIES   (3)      /**< Index of the colour of the first series   */
+#define PLT_MANYCOLOUR ((int)(sizeof(palette)/sizeof(palette[0])))
+/** Index of the colour of series n */
+#define COLOUR(n) (PLT_SERIES + (n) % (PLT_MANYCOLOUR - PLT_SERIES))
+#define PLT_MANYTINT (3)      /**< Tints of each colour of series, for bands */
+/** Index of a tint, from 0 (the palest) up, of a colour of a series */
+#define TINT(colour, level) \
+            (PLT_MANYCOLOUR + ((colour) - PLT_SERIES)*PLT_MANYTINT + (level))
+/** Number of colours and tints */
+#define PLT_MANYINDEX \
+            (PLT_MANYCOLOUR + (PLT_MANYCOLOUR - PLT_SERIES)*PLT_MANYTINT)
+
+/** Columns of the characters 32 to 126, the least significant bit at top */
+static const unsigned char font[95][5] =
+  {
+  {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00},     /*   ! */
+  {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},     /* " # */
+  {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62},     /* $ % */
+  {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},     /* & ' */
+  {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00},     /* ( ) */
+  {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},     /* * + */
+  {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08},     /* , - */
+  {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},     /* . / */
+  {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00},     /* 0 1 */
+  {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},     /* 2 3 */
+  {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39},     /* 4 5 */
+  {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},     /* 6 7 */
+  {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E},     /* 8 9 */
+  {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},     /* : ; */
+  {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14},     /* < = */
+  {0x41,0x22,0x14,0x08,0x00}, {0x02,0x01,0x51,0x09,0x06},     /* > ? */
+  {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E},     /* @ A */
+  {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},     /* B C */
+  {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41},     /* D E */
+  {0x7F,0x09,0x09,0x01,0x01}, {0x3E,0x41,0x41,0x51,0x32},     /* F G */
+  {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00},     /* H I */
+  {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},     /* J K */
+  {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x04,0x02,0x7F},     /* L M */
+  {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},     /* N O */
+  {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E},     /* P Q */
+  {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},     /* R S */
+  {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F},     /* T U */
+  {0x1F,0x20,0x40,0x20,0x1F}, {0x7F,0x20,0x18,0x20,0x7F},     /* V W */
+  {0x63,0x14,0x08,0x14,0x63}, {0x03,0x04,0x78,0x04,0x03},     /* X Y */
+  {0x61,0x51,0x49,0x45,0x43}, {0x00,0x00,0x7F,0x41,0x41},     /* Z [ */
+  {0x02,0x04,0x08,0x10,0x20}, {0x41,0x41,0x7F,0x00,0x00},     /* backslash ] */
+  {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},     /* ^ _ */
+  {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78},     /* ` a */
+  {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},     /* b c */
+  {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18},     /* d e */
+  {0x08,0x7E,0x09,0x01,0x02}, {0x08,0x14,0x54,0x54,0x3C},     /* f g */
+  {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00},     /* h i */
+  {0x20,0x40,0x44,0x3D,0x00}, {0x00,0x7F,0x10,0x28,0x44},     /* j k */
+  {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78},     /* l m */
+  {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},     /* n o */
+  {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C},     /* p q */
+  {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},     /* r s */
+  {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C},     /* t u */
+  {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},     /* v w */
+  {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C},     /* x y */
+  {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},     /* z { */
+  {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00},     /* | } */
+  {0x08,0x04,0x08,0x10,0x08}                                  /* ~ */
+  };
+
+/** Layout of a graph, in pixels, and its canvas */
+struct canvas
+  {
+  FILE          *pf;          /**< SVG being written, or NULL for a raster   */
+  unsigned char *ppix;        /**< Raster of palette indices                 */
+  int            width;       /**< Width of the graph                        */
+  int            height;      /**< Height of the graph                       */
+  int            scale;       /**< Pixels to a dot of the font               */
+  int            cw;          /**< Width of a character                      */
+  int            ch;          /**< Height of a line of text                  */
+  int            left;        /**< Edges of the area within the axes         */
+  int            right;
+  int            top;
+  int            bottom;
+  double         xlo, xhi, xstep;  /**< Range and ticks of the X axis        */
+  double         ylo, yhi, ystep;  /**< Range and ticks of the Y axis        */
+  };
+
+/* ************************************************************************//**
+@brief   Choose the range and tick interval of an axis: the interval is 1, 2
+         or 5 times a power of ten, and the range whole intervals covering
+         the data.
+*//***************************************************************************/
+static void
+ axis(double lo, double hi, int most, double *plo, double *phi, double *pstep)
+{
+double raw, p, f, st;
+
+if ( ! (lo <= hi)) { lo = 0.; hi = 1.; }
+if (lo == hi)
+  {
+  f = (0. == lo) ? 1. : 0.1*fabs(lo); lo -= f; hi += f;
+  }
+if (2 > most) most = 2;
+raw = (hi - lo)/most;
+p = pow(10., floor(log10(raw))); f = raw/p;
+st = p * ((1. >= f) ? 1. : (2. >= f) ? 2. : (5. >= f) ? 5. : 10.);
+*plo = st*floor(lo/st + 1e-9);
+*phi = st*ceil(hi/st - 1e-9);
+if (*phi <= *plo) *phi = *plo + st;
+*pstep = st;
+}
+/* ************************************************************************//**
+@brief   Label of a tick.
+*//***************************************************************************/
+static void
+ tick(char *pbf, double v, double st)
+{
+if (fabs(v) < 1e-6*st) v = 0.;
+snprintf(pbf, 24, "%g", v);
+}
+/* ************************************************************************//**
+@brief   Work out the layout of a graph.
+*//***************************************************************************/
+static void
+ layout(const struct plt *pplt, struct canvas *pc)
+{
+const struct pltseries *ps;
+double xlo, xhi, ylo, yhi, v;
+char bf[24];
+int n, k, b, widest;
+
+xlo = ylo = HUGE_VAL; xhi = yhi = -HUGE_VAL;
+for (n = 0; n < pplt->manyseries; n++)
+  {
+  ps = pplt->pseries + n;
+  for (k = 0; k < ps->many; k++)
+    {
+    if ( ! isfinite(ps->px[k]) || ! isfinite(ps->py[k])) continue;
+    if (ps->px[k] < xlo) xlo = ps->px[k];
+    if (ps->px[k] > xhi) xhi = ps->px[k];
+    if (ps->py[k] < ylo) ylo = ps->py[k];
+    if (ps->py[k] > yhi) yhi = ps->py[k];
+    for (b = 0; b < ps->manyband; b++)
+      {
+      v = ps->pplo[b][k];
+      if (isfinite(v) && (v < ylo)) ylo = v;
+      v = ps->pphi[b][k];
+      if (isfinite(v) && (v > yhi)) yhi = v;
+      }
+    }
+  }
+pc->width = pplt->width; pc->height = pplt->height;
+pc->scale = (480 <= ((pc->width < pc->height) ? pc->width : pc->height)) ? 2:1;
+pc->cw = 6*pc->scale; pc->ch = 8*pc->scale;
+pc->top = 2*pc->ch + pc->ch/2;
+pc->bottom = pc->height - 3*pc->ch - pc->ch/2;
+axis(ylo, yhi, (pc->bottom - pc->top)/(3*pc->ch), \
+                                           &pc->ylo, &pc->yhi, &pc->ystep);
+for (widest = 1, v = pc->ylo; v <= pc->yhi + 1e-6*pc->ystep; v += pc->ystep)
+  {
+  tick(bf, v, pc->ystep);
+  if ((int)strlen(bf) > widest) widest = strlen(bf);
+  }
+pc->left = 2*pc->ch + (widest + 1)*pc->cw;
+pc->right = pc->width - 3*pc->cw;
+axis(xlo, xhi, (pc->right - pc->left)/(10*pc->cw), \
+                                           &pc->xlo, &pc->xhi, &pc->xstep);
+}
+/** Horizontal pixel of an abscissa */
+#define XPIX(pc, v) \
+  ((pc)->left + ((v) - (pc)->xlo)/((pc)->xhi - (pc)->xlo) \
+                                             *((pc)->right - (pc)->left))
+/** Vertical pixel of an ordinate */
+#define YPIX(pc, v) \
+  ((pc)->bottom - ((v) - (pc)->ylo)/((pc)->yhi - (pc)->ylo) \
+                                             *((pc)->bottom - (pc)->top))
+
+/* ************************************************************************//**
+@brief   Red, green and blue of a colour or a tint, the tints being the
+         colours of the series mixed with white.
+*//***************************************************************************/
+static void
+ rgbof(int colour, unsigned char *prgb)
+{
+double mix;
+int k, level;
+
+if (PLT_MANYCOLOUR > colour) { memcpy(prgb, palette[colour], 3); return; }
+level = (colour - PLT_MANYCOLOUR) % PLT_MANYTINT;
+colour = PLT_SERIES + (colour - PLT_MANYCOLOUR)/PLT_MANYTINT;
+mix = 0.2 + 0.2*level;
+for (k = 0; k < 3; k++)
+  {
+  prgb[k] = (unsigned char)(255. - mix*(255 - palette[colour][k]) + 0.5);
+  }
+}
+/* ************************************************************************//**
+@brief   Colour or tint as SVG writes it.
+*//***************************************************************************/
+static const char *
+ hex(char *pbf, int colour)
+{
+unsigned char rgb[3];
+
+rgbof(colour, rgb);
+sprintf(pbf, "#%02x%02x%02x", rgb[0], rgb[1], rgb[2]);
+return pbf;
+}
+/* ************************************************************************//**
+@brief   Fill a rectangle of the raster, clipped to the graph.
+*//***************************************************************************/
+static void
+ fill(struct canvas *pc, int x0, int y0, int x1, int y1, int colour)
+{
+int x, y;
+
+if (0 > x0) x0 = 0;
+if (0 > y0) y0 = 0;
+if (pc->width <= x1) x1 = pc->width - 1;
+if (pc->height <= y1) y1 = pc->height - 1;
+for (y = y0; y <= y1; y++)
+  {
+  for (x = x0; x <= x1; x++) pc->ppix[(size_t)y*pc->width + x] = colour;
+  }
+}
+/* ************************************************************************//**
+@brief   Draw a line, one dot of the font thick.
+*//***************************************************************************/
+static void
+ line(struct canvas *pc, double fx0, double fy0, double fx1, double fy1, \
+                                                                 int colour)
+{
+char bf[8];
+int x0, y0, x1, y1, dx, dy, sx, sy, e, e2;
+
+if (pc->pf)
+  {
+  fprintf(pc->pf, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" "
+          "stroke=\"%s\" stroke-width=\"%i\"/>\n", fx0, fy0, fx1, fy1, \
+                                             hex(bf, colour), pc->scale);
+  return;
+  }
+x0 = (int)floor(fx0); y0 = (int)floor(fy0);
+x1 = (int)floor(fx1); y1 = (int)floor(fy1);
+dx = abs(x1 - x0); sx = (x0 < x1) ? 1 : -1;
+dy = -abs(y1 - y0); sy = (y0 < y1) ? 1 : -1;
+e = dx + dy;
+while (1)
+  {
+  fill(pc, x0, y0, x0 + pc->scale - 1, y0 + pc->scale - 1, colour);
+  if ((x0 == x1) && (y0 == y1)) break;
+  e2 = 2*e;
+  if (e2 >= dy) { e += dy; x0 += sx; }
+  if (e2 <= dx) { e += dx; y0 += sy; }
+  }
+}
+/* ************************************************************************//**
+@brief   Draw a rectangle, filled with one colour and edged with another.
+*//***************************************************************************/
+static void
+ box(struct canvas *pc, int x0, int y0, int x1, int y1, int paper, int edge)
+{
+char bf[8], bf2[8];
+
+if (pc->pf)
+  {
+  fprintf(pc->pf, "<rect x=\"%i\" y=\"%i\" width=\"%i\" height=\"%i\" "
+          "fill=\"%s\" stroke=\"%s\" stroke-width=\"%i\"/>\n", x0, y0, \
+          x1 - x0, y1 - y0, hex(bf, paper), hex(bf2, edge), pc->scale);
+  return;
+  }
+fill(pc, x0, y0, x1, y1, paper);
+line(pc, x0, y0, x1, y0, edge); line(pc, x1, y0, x1, y1, edge);
+line(pc, x1, y1, x0, y1, edge); line(pc, x0, y1, x0, y0, edge);
+}
+/* ************************************************************************//**
+@brief   Draw text centred vertically on a point.
+@param   pc       The canvas.
+@param   x        Its start, middle or end, as  anchor  is -1, 0 or 1.
+@param   y        Its middle.
+@param   ptext    The text; no more than  most  characters are drawn.
+@param   anchor   As above.
+@param   upright  Non-zero to read upwards, with  x  and  y  exchanged.
+@param   colour   The colour.
+*//***************************************************************************/
+static void
+ text(struct canvas *pc, double x, double y, const char *ptext, int most, \
+                                       int anchor, int upright, int colour)
+{
+static const char *ppanchor[3] = {"start", "middle", "end"};
+char bf[8];
+const unsigned char *pg;
+int many, n, c, r, s, a, b, along, x0, y0;
+
+many = strlen(ptext); if (many > most) many = most;
+if (0 >= many) return;
+if (pc->pf)
+  {
+  fprintf(pc->pf, "<text x=\"%.1f\" y=\"%.1f\" fill=\"%s\" text-anchor=\"%s\"",
+          x, y + 3.5*pc->scale, hex(bf, colour), ppanchor[anchor + 1]);
+  if (upright) fprintf(pc->pf, " transform=\"rotate(-90 %.1f %.1f)\"", x, y);
+  fprintf(pc->pf, ">");
+  for (n = 0; n < many; n++)
+    {
+    switch (ptext[n])
+      {
+      case '&': fprintf(pc->pf, "&amp;"); break;
+      case '<': fprintf(pc->pf, "&lt;"); break;
+      case '>': fprintf(pc->pf, "&gt;"); break;
+      default:  fputc((' ' <= ptext[n]) && ('~' >= ptext[n]) ? ptext[n] : '?',\
+                                                                   pc->pf);
+      }
+    }
+  fprintf(pc->pf, "</text>\n");
+  return;
+  }
+s = pc->scale;
+along = (anchor + 1)*(many*pc->cw - s)/2;
+x0 = (int)floor(x); y0 = (int)floor(y);
+for (n = 0; n < many; n++)
+  {
+  c = (unsigned char)ptext[n];
+  pg = font[((' ' <= c) && ('~' >= c)) ? c - ' ' : '?' - ' '];
+  for (c = 0; c < 5; c++)
+    {
+    for (r = 0; r < 7; r++)
+      {
+      if ( ! ((pg[c] >> r) & 1)) continue;
+      a = n*pc->cw + c*s - along;
+      b = r*s - 7*s/2;
+      if (upright) fill(pc, x0 + b, y0 - a - s, x0 + b + s - 1, y0 - a - 1, \
+                                                                   colour);
+      else         fill(pc, x0 + a, y0 + b, x0 + a + s - 1, y0 + b + s - 1, \
+                                                                   colour);
+      }
+    }
+  }
+}
+/* ************************************************************************//**
+@brief   Draw a series, as lines between successive points, or as a dot
+         where a point stands alone.
+*//***************************************************************************/
+static void
+ series(struct canvas *pc, const struct pltseries *ps, int colour)
+{
+char bf[8];
+double x, y;
+int k, run;
+
+for (k = 0, run = 0; k < ps->many; k++)
+  {
+  if ( ! isfinite(ps->px[k]) || ! isfinite(ps->py[k]))
+    {
+    if (pc->pf && (1 < run)) fprintf(pc->pf, "\"/>\n");
+    run = 0; continue;
+    }
+  x = XPIX(pc, ps->px[k]); y = YPIX(pc, ps->py[k]);
+  if ((k + 1 == ps->many) || ! isfinite(ps->px[k + 1]) || \
+                                          ! isfinite(ps->py[k + 1]))
+    {
+    if ( ! run)
+      {
+      if (pc->pf) fprintf(pc->pf, "<circle cx=\"%.1f\" cy=\"%.1f\" "
+                      "r=\"%.1f\" fill=\"%s\"/>\n", x, y, 1.5*pc->scale, \
+                                                          hex(bf, colour));
+      else fill(pc, (int)x - pc->scale, (int)y - pc->scale, \
+                      (int)x + pc->scale, (int)y + pc->scale, colour);
+      continue;
+      }
+    }
+  if (pc->pf)
+    {
+    if ( ! run) fprintf(pc->pf, "<polyline fill=\"none\" stroke=\"%s\" "
+                        "stroke-width=\"%i\" stroke-linejoin=\"round\" "
+                        "points=\"", hex(bf, colour), pc->scale);
+    fprintf(pc->pf, "%s%.1f,%.1f", run ? " " : "", x, y);
+    }
+  else if (run)
+    {
+    line(pc, XPIX(pc, ps->px[k - 1]), YPIX(pc, ps->py[k - 1]), x, y, colour);
+    }
+  run++;
+  }
+if (pc->pf && (1 < run)) fprintf(pc->pf, "\"/>\n");
+}
+/* ************************************************************************//**
+@brief   Fill a band of a series, between its lower and upper edges, column
+         by column in the raster, and as a polygon for each stretch of
+         finite points in SVG.
+*//***************************************************************************/
+static void
+ band(struct canvas *pc, const struct pltseries *ps, int b, int colour)
+{
+const double *plo, *phi;
+char bf[8];
+double xa, xb, t, ya, yb;
+int k, start, x, x0, x1;
+
+plo = ps->pplo[b]; phi = ps->pphi[b];
+for (k = 0, start = 0; k <= ps->many; k++)
+  {
+  if ((k < ps->many) && isfinite(ps->px[k]) && isfinite(plo[k]) && \
+                                                        isfinite(phi[k]))
+    {
+    continue;
+    }
+  if (1 < k - start)
+    {
+    if (pc->pf)
+      {
+      fprintf(pc->pf, "<polygon fill=\"%s\" stroke=\"none\" points=\"", \
+                                                          hex(bf, colour));
+      for (x = start; x < k; x++)
+        {
+        fprintf(pc->pf, "%.1f,%.1f ", XPIX(pc, ps->px[x]), YPIX(pc, phi[x]));
+        }
+      for (x = k - 1; x >= start; x--)
+        {
+        fprintf(pc->pf, "%.1f,%.1f%s", XPIX(pc, ps->px[x]), \
+                               YPIX(pc, plo[x]), (x > start) ? " " : "\"/>\n");
+        }
+      }
+    else for (x = start; x + 1 < k; x++)
+      {
+      xa = XPIX(pc, ps->px[x]); xb = XPIX(pc, ps->px[x + 1]);
+      x0 = (int)ceil((xa < xb) ? xa : xb);
+      x1 = (int)floor((xa < xb) ? xb : xa);
+      for (; x0 <= x1; x0++)
+        {
+        t = (xb == xa) ? 0. : (x0 - xa)/(xb - xa);
+        ya = YPIX(pc, plo[x] + t*(plo[x + 1] - plo[x]));
+        yb = YPIX(pc, phi[x] + t*(phi[x + 1] - phi[x]));
+        if (ya > yb) { t = ya; ya = yb; yb = t; }
+        fill(pc, x0, (int)floor(ya), x0, (int)floor(yb), colour);
+        }
+      }
+    }
+  start = k + 1;
+  }
+}
+/* ************************************************************************//**
+@brief   The tint of band b of a series: the innermost band is the darkest.
+*//***************************************************************************/
+static int
+ tintof(const struct pltseries *ps, int n, int b)
+{
+return TINT(COLOUR(n), (1 < ps->manyband) ? \
+          (b*(PLT_MANYTINT - 1))/(ps->manyband - 1) : PLT_MANYTINT/2);
+}
+/* ************************************************************************//**
+@brief   Draw the legend, at the top left within the axes, as many rows as
+         fit in half their height.
+*//***************************************************************************/
+static void
+ legend(struct canvas *pc, const struct plt *pplt)
+{
+char bf[40];
+int n, k, rowh, most, shown, more, chars, x0, y0, y;
+
+if (0 >= pplt->manyseries) return;
+rowh = pc->ch + 2*pc->scale;
+most = (pc->bottom - pc->top)/(2*rowh); if (1 > most) most = 1;
+shown = pplt->manyseries; more = 0;
+if (shown > most) { shown = most - 1; more = pplt->manyseries - shown; }
+most = (pc->right - pc->left)/pc->cw - 6;
+for (n = 0, chars = 0; n < shown; n++)
+  {
+  if ((int)strlen(pplt->pseries[n].pname) > chars) \
+                                        chars = strlen(pplt->pseries[n].pname);
+  }
+if (more) sprintf(bf, "... and %i more", more);
+if (more && ((int)strlen(bf) > chars)) chars = strlen(bf);
+if (chars > most) chars = most;
+x0 = pc->left + 4*pc->scale; y0 = pc->top + 4*pc->scale;
+box(pc, x0, y0, x0 + (5 + chars)*pc->cw, \
+    y0 + (shown + (more ? 1 : 0))*rowh + 2*pc->scale, PLT_PAPER, PLT_GRID);
+for (n = 0; n < shown; n++)
+  {
+  y = y0 + pc->scale + n*rowh + rowh/2;
+  if (pplt->pseries[n].manyband)
+    {
+    k = tintof(pplt->pseries + n, n, 0);
+    box(pc, x0 + pc->cw, y - pc->ch/2 + pc->scale, x0 + 3*pc->cw, \
+                                             y + pc->ch/2 - pc->scale, k, k);
+    }
+  line(pc, x0 + pc->cw, y, x0 + 3*pc->cw, y, COLOUR(n));
+  text(pc, x0 + 4*pc->cw, y, pplt->pseries[n].pname, chars, -1, 0, PLT_INK);
+  }
+if (more)
+  {
+  text(pc, x0 + 4*pc->cw, y0 + pc->scale + n*rowh + rowh/2, bf, chars, \
+                                                             -1, 0, PLT_INK);
+  }
+}
+/* ************************************************************************//**
+@brief   Draw a whole graph, once its layout is known.
+*//***************************************************************************/
+static void
+ render(struct canvas *pc, const struct plt *pplt)
+{
+char bf[24];
+double v, p;
+int n, b;
+
+box(pc, 0, 0, pc->width, pc->height, PLT_PAPER, PLT_PAPER);
+for (v = pc->ylo; v <= pc->yhi + 1e-6*pc->ystep; v += pc->ystep)
+  {
+  p = YPIX(pc, v);
+  line(pc, pc->left, p, pc->right, p, PLT_GRID);
+  tick(bf, v, pc->ystep);
+  text(pc, pc->left - pc->cw/2, p, bf, 24, 1, 0, PLT_INK);
+  }
+for (v = pc->xlo; v <= pc->xhi + 1e-6*pc->xstep; v += pc->xstep)
+  {
+  p = XPIX(pc, v);
+  line(pc, p, pc->top, p, pc->bottom, PLT_GRID);
+  tick(bf, v, pc->xstep);
+  text(pc, p, pc->bottom + pc->ch, bf, 24, 0, 0, PLT_INK);
+  }
+line(pc, pc->left, pc->top, pc->right, pc->top, PLT_INK);
+line(pc, pc->right, pc->top, pc->right, pc->bottom, PLT_INK);
+line(pc, pc->right, pc->bottom, pc->left, pc->bottom, PLT_INK);
+line(pc, pc->left, pc->bottom, pc->left, pc->top, PLT_INK);
+for (n = 0; n < pplt->manyseries; n++)
+  {
+  for (b = 0; b < pplt->pseries[n].manyband; b++)
+    {
+    band(pc, pplt->pseries + n, b, tintof(pplt->pseries + n, n, b));
+    }
+  }
+for (n = 0; n < pplt->manyseries; n++)
+  {
+  series(pc, pplt->pseries + n, COLOUR(n));
+  }
+legend(pc, pplt);
+if (pplt->ptitle) text(pc, pc->width/2, pc->ch + pc->ch/4, pplt->ptitle, \
+                                       pc->width/pc->cw - 2, 0, 0, PLT_INK);
+if (pplt->pxlabel) text(pc, (pc->left + pc->right)/2, pc->height - pc->ch, \
+              pplt->pxlabel, (pc->right - pc->left)/pc->cw, 0, 0, PLT_INK);
+if (pplt->pylabel) text(pc, pc->ch, (pc->top + pc->bottom)/2, pplt->pylabel, \
+                           (pc->bottom - pc->top)/pc->cw, 0, 1, PLT_INK);
+}
+/* ************************************************************************//**
+@brief   Check the size of a graph.
+*//***************************************************************************/
+static int
+ sizable(const struct plt *pplt)
+{
+if ((PLT_MINSIZE > pplt->width) || (PLT_MAXSIZE < pplt->width) || \
+    (PLT_MINSIZE > pplt->height) || (PLT_MAXSIZE < pplt->height))
+  {
+  fprintf(stderr, "ERROR: graph of %ix%i pixels: each side must be %i to %i\n",
+                  pplt->width, pplt->height, PLT_MINSIZE, PLT_MAXSIZE);
+  return 0;
+  }
+return 1;
+}
+/* ************************************************************************//**
+@brief   Write a graph as SVG.
+@param   pf    The file.
+@param   pplt  The graph.
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ pltsvg(FILE *pf, const struct plt *pplt)
+{
+struct canvas c0;
+
+if ( ! sizable(pplt)) return -1;
+memset(&c0, 0, sizeof(c0));
+layout(pplt, &c0);
+c0.pf = pf;
+fprintf(pf, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%i\" height=\"%i\" "
+        "viewBox=\"0 0 %i %i\" font-family=\"monospace\" font-size=\"%i\">\n",
+        c0.width, c0.height, c0.width, c0.height, 10*c0.scale);
+render(&c0, pplt);
+fprintf(pf, "</svg>\n");
+return ferror(pf) ? -16 : 0;
+}
+/*---------------------------------------------------------------------------*/
+/** Bits being written to a deflate stream, least significant first */
+struct bits
+  {
+  unsigned char *p;           /**< The stream                                */
+  size_t         at;          /**< Bytes written                             */
+  uint32_t       acc;         /**< Bits not yet written                      */
+  int            n;           /**< Number of them                            */
+  };
+
+/** Least lengths of the length codes 257 to 285 of deflate */
+static const unsigned short lengthbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, \
+   13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, \
+                                                              195, 227, 258};
+/** Extra bits of the length codes */
+static const unsigned char lengthextra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, \
+                      1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+/** Least distances of the distance codes 0 to 29 */
+static const unsigned short distbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, \
+   33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, \
+                                4097, 6145, 8193, 12289, 16385, 24577};
+/** Extra bits of the distance codes */
+static const unsigned char distextra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, \
+             4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/* ************************************************************************//**
+@brief   Write bits, least significant first.
+*//***************************************************************************/
+static void
+ put(struct bits *pb, uint32_t v, int n)
+{
+pb->acc |= v << pb->n; pb->n += n;
+while (8 <= pb->n)
+  {
+  pb->p[pb->at++] = pb->acc & 0xFF; pb->acc >>= 8; pb->n -= 8;
+  }
+}
+/* ************************************************************************//**
+@brief   Write a Huffman code, which goes most significant bit first.
+*//***************************************************************************/
+static void
+ huff(struct bits *pb, uint32_t code, int n)
+{
+uint32_t r;
+int k;
+
+for (r = 0, k = 0; k < n; k++) { r = (r << 1) | (code & 1); code >>= 1; }
+put(pb, r, n);
+}
+/* ************************************************************************//**
+@brief   Write a literal or length symbol in the fixed Huffman code.
+*//***************************************************************************/
+static void
+ symbol(struct bits *pb, int sym)
+{
+if      (144 > sym) huff(pb, 0x30 + sym, 8);
+else if (256 > sym) huff(pb, 0x190 + sym - 144, 9);
+else if (280 > sym) huff(pb, sym - 256, 7);
+else                huff(pb, 0xC0 + sym - 280, 8);
+}
+/* ************************************************************************//**
+@brief   Compress by deflate, as a single block in the fixed Huffman code,
+         looking for repeats only at distances 1 and  row .
+@return        Bytes written to  pout , which must hold  9*size/8 + 8 .
+*//***************************************************************************/
+static size_t
+ deflate(const unsigned char *praw, size_t size, size_t row, \
+                                                          unsigned char *pout)
+{
+struct bits b0;
+size_t i, n, best, dist;
+int k;
+
+memset(&b0, 0, sizeof(b0)); b0.p = pout;
+put(&b0, 1, 1); put(&b0, 1, 2);
+for (i = 0; i < size; )
+  {
+  best = 0; dist = 0;
+  if (1 <= i)
+    {
+    for (n = 0; (i + n < size) && (258 > n) && \
+                                       (praw[i + n] == praw[i + n - 1]); n++);
+    if (n > best) { best = n; dist = 1; }
+    }
+  if (row <= i)
+    {
+    for (n = 0; (i + n < size) && (258 > n) && \
+                                     (praw[i + n] == praw[i + n - row]); n++);
+    if (n > best) { best = n; dist = row; }
+    }
+  if (3 > best) { symbol(&b0, praw[i++]); continue; }
+  for (k = 28; lengthbase[k] > best; k--);
+  symbol(&b0, 257 + k);
+  if (lengthextra[k]) put(&b0, best - lengthbase[k], lengthextra[k]);
+  for (k = 29; distbase[k] > dist; k--);
+  huff(&b0, k, 5);
+  if (distextra[k]) put(&b0, dist - distbase[k], distextra[k]);
+  i += best;
+  }
+symbol(&b0, 256);
+if (b0.n) b0.p[b0.at++] = b0.acc & 0xFF;
+return b0.at;
+}
+/* ************************************************************************//**
+@brief   Write a 32-bit integer, most significant byte first.
+*//***************************************************************************/
+static void
+ big(unsigned char *p, uint32_t v)
+{
+p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+/* ************************************************************************//**
+@brief   Write a chunk of a PNG: its length, type, data and CRC.
+*//***************************************************************************/
+static void
+ chunk(FILE *pf, const uint32_t *pcrc, const char *ptype, \
+                                         const unsigned char *pdata, size_t sz)
+{
+unsigned char bf[4];
+uint32_t c;
+size_t k;
+
+big(bf, sz); fwrite(bf, 1, 4, pf);
+fwrite(ptype, 1, 4, pf);
+if (sz) fwrite(pdata, 1, sz, pf);
+c = 0xFFFFFFFF;
+for (k = 0; k < 4; k++)
+  {
+  c = pcrc[(c ^ (unsigned char)ptype[k]) & 0xFF] ^ (c >> 8);
+  }
+for (k = 0; k < sz; k++) c = pcrc[(c ^ pdata[k]) & 0xFF] ^ (c >> 8);
+big(bf, c ^ 0xFFFFFFFF); fwrite(bf, 1, 4, pf);
+}
+/* ************************************************************************//**
+@brief   Write a graph as PNG, with a palette of 8-bit indices.
+@param   pf    The file.
+@param   pplt  The graph.
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ pltpng(FILE *pf, const struct plt *pplt)
+{
+struct canvas c0;
+unsigned char head[13], plte[3*PLT_MANYINDEX], *praw, *pout;
+uint32_t crc[256], c, a1, a2;
+size_t row, size, sz, k;
+int n;
+
+if ( ! sizable(pplt)) return -1;
+memset(&c0, 0, sizeof(c0));
+layout(pplt, &c0);
+row = c0.width + 1; size = row*c0.height;
+c0.ppix = (unsigned char *)calloc((size_t)c0.width*c0.height, 1);
+praw = (unsigned char *)malloc(size);
+pout = (unsigned char *)malloc(2 + 9*size/8 + 8 + 4);
+if ((NULL == c0.ppix) || (NULL == praw) || (NULL == pout))
+  {
+  free(c0.ppix); free(praw); free(pout);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+render(&c0, pplt);
+/*-----------------------------------------------------------------------------
+EACH ROW IS PRECEDED BY ITS FILTER, NONE; THE ZLIB STREAM IS ITS HEADER, THE
+DEFLATE STREAM AND THE ADLER-32 OF THE ROWS
+-----------------------------------------------------------------------------*/
+for (n = 0; n < c0.height; n++)
+  {
+  praw[n*row] = 0;
+  memcpy(praw + n*row + 1, c0.ppix + (size_t)n*c0.width, c0.width);
+  }
+pout[0] = 0x78; pout[1] = 0x01;
+sz = 2 + deflate(praw, size, row, pout + 2);
+for (a1 = 1, a2 = 0, k = 0; k < size; k++)
+  {
+  a1 = (a1 + praw[k]) % 65521; a2 = (a2 + a1) % 65521;
+  }
+big(pout + sz, (a2 << 16) | a1); sz += 4;
+
+for (n = 0; n < 256; n++)
+  {
+  for (c = n, k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+  crc[n] = c;
+  }
+fwrite("\x89PNG\r\n\x1A\n", 1, 8, pf);
+big(head, c0.width); big(head + 4, c0.height);
+head[8] = 8; head[9] = 3; head[10] = head[11] = head[12] = 0;
+chunk(pf, crc, "IHDR", head, 13);
+for (n = 0; n < PLT_MANYINDEX; n++) rgbof(n, plte + 3*n);
+chunk(pf, crc, "PLTE", plte, sizeof(plte));
+chunk(pf, crc, "IDAT", pout, sz);
+chunk(pf, crc, "IEND", NULL, 0);
+free(c0.ppix); free(praw); free(pout);
+return ferror(pf) ? -16 : 0;
+}
+/* ************************************************************************//**
+@brief   Write a graph to a file, as PNG if its name ends in .png and as SVG
+         if it ends in .svg.
+@param   pfnm  The file.
+@param   pplt  The graph.
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ pltwrite(const char *pfnm, const struct plt *pplt)
+{
+const char *pext;
+FILE *pf;
+int rc;
+
+pext = strrchr(pfnm, '.');
+if ((NULL == pext) || (strcmp(pext, ".png") && strcmp(pext, ".svg")))
+  {
+  fprintf(stderr, "ERROR: graph must be named *.svg or *.png: %s\n", pfnm);
+  return -1;
+  }
+if (NULL == (pf = fopen(pfnm, "wb")))
+  {
+  fprintf(stderr, "ERROR: cannot open output file: %s\n", pfnm); return -16;
+  }
+rc = strcmp(pext, ".png") ? pltsvg(pf, pplt) : pltpng(pf, pplt);
+if (fclose(pf) && ! rc)
+  {
+  fprintf(stderr, "ERROR: cannot close file %s\n", pfnm); rc = -16;
+  }
+return rc;
+}
+/* ***************************************************************************/
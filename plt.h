@@ -0,0 +1,69 @@
+/* ************************************************************//** @file plt.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the built-in renderer of graphs.
+
+A graph is a set of series of points drawn as lines on common axes, with
+gridlines, ticks, a title, labels and a legend, written as SVG or as PNG
+without any program or library outside this project.  A series may carry
+bands about its line, such as the quantiles of many runs, drawn in tints of
+its colour, the innermost darkest.
+*//* *************************************************************************/
+
+#ifndef COV_PLOT_H
+#define COV_PLOT_H
+
+#include <stdio.h>
+
+/** One series of points */
+struct pltseries
+  {
+  const char   *pname;        /**< Its name in the legend                    */
+  int           many;         /**< Number of points                          */
+  const double *px;           /**< Abscissae                                 */
+  const double *py;           /**< Ordinates: a point not finite breaks the
+                                   line                                      */
+  int           manyband;     /**< Number of bands about the line            */
+  const double *const *pplo;  /**< Lower edge of each band, outermost first  */
+  const double *const *pphi;  /**< Upper edge of each band, outermost first  */
+  };
+
+/** A graph */
+struct plt
+  {
+  const char   *ptitle;       /**< Title, above the graph                    */
+  const char   *pxlabel;      /**< Label of the X axis                       */
+  const char   *pylabel;      /**< Label of the Y axis                       */
+  int           width;        /**< Width in pixels                           */
+  int           height;       /**< Height in pixels                          */
+  int           manyseries;   /**< Number of series                          */
+  const struct pltseries *pseries; /**< The series                           */
+  };
+
+#define PLT_MINSIZE (128)     /**< Least width or height of a graph          */
+#define PLT_MAXSIZE (8192)    /**< Greatest width or height of a graph       */
+
+int pltsvg(FILE *, const struct plt *);
+int pltpng(FILE *, const struct plt *);
+int pltwrite(const char *, const struct plt *);
+
+#endif /*COV_PLOT_H*/
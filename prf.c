@@ -0,0 +1,185 @@
+/* ************************************************************//** @file prf.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Hardware performance counters, where the system allows them.
+
+On Linux the counters are opened with perf_event_open(), which may be refused
+(see /proc/sys/kernel/perf_event_paranoid) or absent, as in many virtual
+machines; prfopen() then opens none, and the client reports times alone.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "prf.h"
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/** Names of the events, in the order of the values from prfread() */
+const char *const prfname[PRF_MANY] =
+  {
+  "cycles", "instructions", "cache-misses", "branch-misses"
+  };
+
+/** Names of the events of prfnode(), in the order of the values */
+const char *const prfnodename[PRF_MANYNODE] =
+  {
+  "node-loads", "node-load-misses"
+  };
+
+#ifdef __linux__
+/* ************************************************************************//**
+@brief   Open a group of counters on the calling thread, and start them; all
+         of them or none.  The first leads the group, so that all of them
+         count over the same intervals and are read together by prfread().
+@return  The number of counters open.
+*//***************************************************************************/
+static int
+ group(struct prf *pprf, uint32_t type, const uint64_t *pconfig, int many)
+{
+struct perf_event_attr attr;
+int n, fd;
+
+pprf->many = 0;
+for (n = 0; n < many; n++)
+  {
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = pconfig[n];
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.disabled = n ? 0 : 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, \
+                                               n ? pprf->fd[0] : -1, 0);
+  if (0 > fd) break;
+  pprf->fd[pprf->many++] = fd;
+  }
+if (pprf->many < many) prfclose(pprf);
+if (pprf->many)
+  {
+  ioctl(pprf->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(pprf->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+return pprf->many;
+}
+#endif
+
+/* ************************************************************************//**
+@brief   Open the counters on the calling thread, and start them.
+@param   pprf  The group of counters.
+@return        The number of counters open, zero if none could be.
+*//***************************************************************************/
+int
+ prfopen(struct prf *pprf)
+{
+#ifdef __linux__
+static const uint64_t config[PRF_MANY] =
+  {
+  PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+  };
+
+return group(pprf, PERF_TYPE_HARDWARE, config, PRF_MANY);
+#else
+pprf->many = 0;
+return 0;
+#endif
+}
+/* ************************************************************************//**
+@brief   Open instead the counters of loads from memory, and of those of them
+         served by another NUMA node, on the calling thread, and start them.
+@param   pprf  The group of counters.
+@return        The number of counters open, PRF_MANYNODE or zero.
+*//***************************************************************************/
+int
+ prfnode(struct prf *pprf)
+{
+#ifdef __linux__
+static const uint64_t config[PRF_MANYNODE] =
+  {
+  PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                                    (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16),
+  PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+                                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+  };
+
+return group(pprf, PERF_TYPE_HW_CACHE, config, PRF_MANYNODE);
+#else
+pprf->many = 0;
+return 0;
+#endif
+}
+/* ************************************************************************//**
+@brief   Read the running totals of the counters, all at one instant.
+@param   pprf    The group of counters.
+@param   pvalue  Location to receive one value per counter, PRF_MANY in all;
+                 zero for counters not open.
+*//***************************************************************************/
+void
+ prfread(const struct prf *pprf, uint64_t *pvalue)
+{
+uint64_t bf[1 + PRF_MANY];
+int n;
+
+for (n = 0; n < PRF_MANY; n++) { *(pvalue + n) = 0; }
+if (0 == pprf->many) return;
+/*-----------------------------------------------------------------------------
+THE LEADER GIVES THE NUMBER OF COUNTERS, THEN THE VALUE OF EACH IN TURN
+-----------------------------------------------------------------------------*/
+if ((ssize_t)((1 + pprf->many) * sizeof(uint64_t)) != \
+                                         read(pprf->fd[0], bf, sizeof(bf)))
+  {
+  return;
+  }
+for (n = 0; (n < pprf->many) && (n < (int)bf[0]); n++)
+  {
+  *(pvalue + n) = bf[1 + n];
+  }
+}
+/* ************************************************************************//**
+@brief   Close the counters.
+*//***************************************************************************/
+void
+ prfclose(struct prf *pprf)
+{
+int n;
+
+for (n = 0; n < pprf->many; n++) { close(pprf->fd[n]); }
+pprf->many = 0;
+}
+/* ************************************************************************//**
+@brief   Seconds on the monotonic clock.
+*//***************************************************************************/
+double
+ prfnow(void)
+{
+struct timespec ts;
+
+clock_gettime(CLOCK_MONOTONIC, &ts);
+return (double)ts.tv_sec + 1.e-9 * (double)ts.tv_nsec;
+}
+/* ***************************************************************************/
@@ -0,0 +1,51 @@
+/* ************************************************************//** @file prf.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header for the hardware performance counters and the clock used to
+       attribute the cost of a run of cov to its phases.
+*//* *************************************************************************/
+
+#ifndef PERFORMANCE_COUNTERS_H
+#define PERFORMANCE_COUNTERS_H
+
+#include <stdint.h>
+
+#define PRF_MANY (4)          /**< Hardware events counted, at most          */
+#define PRF_MANYNODE (2)      /**< Events counted by prfnode()               */
+
+/** A group of hardware counters on the calling thread */
+struct prf
+  {
+  int  fd[PRF_MANY];          /**< File descriptors from perf_event_open()   */
+  int  many;                  /**< Number of counters open, maybe zero       */
+  };
+
+extern const char *const prfname[PRF_MANY];
+extern const char *const prfnodename[PRF_MANYNODE];
+
+int    prfopen(struct prf *);
+int    prfnode(struct prf *);
+void   prfread(const struct prf *, uint64_t *);
+void   prfclose(struct prf *);
+double prfnow(void);
+
+#endif /*PERFORMANCE_COUNTERS_H*/
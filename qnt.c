@@ -0,0 +1,151 @@
+/* ************************************************************//** @file qnt.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Streaming histogram of quantiles, of values of any range.
+
+The first QNT_MANYFIRST values are kept exactly, and from their range the
+bins are placed, covering twice that range about it.  A later value below
+or above the bins doubles their width, merging them in pairs, and shifts
+their origin down by the old span if it was below, until the value fits:
+the edges of the old bins remain edges of the new, so no count moves
+between bins and the error of a quantile stays within the final width of a
+bin, 1/512 of the range of the values at worst.  A quantile is read by
+interpolating within its bin, clamped to the least and greatest values
+seen, so that a distribution with two separate peaks (runs that die out
+and runs that take off) keeps its gap.
+*//* *************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "qnt.h"
+
+/* ************************************************************************//**
+@brief   Start a histogram.
+*//***************************************************************************/
+void
+ qntinit(struct qnt *pq)
+{
+memset(pq, 0, sizeof(struct qnt));
+}
+/* ************************************************************************//**
+@brief   Count a value in its bin, widening the bins until it fits.
+*//***************************************************************************/
+static void
+ bin(struct qnt *pq, double x)
+{
+long k;
+int j;
+
+while (x < pq->origin)
+  {
+  for (j = QNT_MANYBIN - 1; j >= QNT_MANYBIN/2; j--)
+    {
+    pq->bin[j] = pq->bin[2*j - QNT_MANYBIN] + pq->bin[2*j - QNT_MANYBIN + 1];
+    }
+  memset(pq->bin, 0, (QNT_MANYBIN/2)*sizeof(uint32_t));
+  pq->origin -= QNT_MANYBIN*pq->width; pq->width *= 2.;
+  }
+while (x >= pq->origin + QNT_MANYBIN*pq->width)
+  {
+  for (j = 0; j < QNT_MANYBIN/2; j++)
+    {
+    pq->bin[j] = pq->bin[2*j] + pq->bin[2*j + 1];
+    }
+  memset(pq->bin + QNT_MANYBIN/2, 0, (QNT_MANYBIN/2)*sizeof(uint32_t));
+  pq->width *= 2.;
+  }
+k = (long)((x - pq->origin)/pq->width);
+if (0 > k) k = 0;
+if (QNT_MANYBIN <= k) k = QNT_MANYBIN - 1;
+pq->bin[k]++;
+}
+/* ************************************************************************//**
+@brief   Add a value; one not finite is ignored.
+*//***************************************************************************/
+void
+ qntadd(struct qnt *pq, double x)
+{
+double span;
+int k;
+
+if ( ! isfinite(x)) return;
+if ( ! pq->many) pq->lo = pq->hi = x;
+if (x < pq->lo) pq->lo = x;
+if (x > pq->hi) pq->hi = x;
+if (QNT_MANYFIRST > pq->many) { pq->first[pq->many++] = x; return; }
+if (0. == pq->width)
+  {
+  span = pq->hi - pq->lo;
+  if (0. < span)           pq->width = span/(QNT_MANYBIN/2);
+  else if (0. != pq->lo)   pq->width = fabs(pq->lo)/QNT_MANYBIN;
+  else                     pq->width = 1./QNT_MANYBIN;
+  pq->origin = pq->lo - (QNT_MANYBIN/4)*pq->width;
+  for (k = 0; k < QNT_MANYFIRST; k++) bin(pq, pq->first[k]);
+  }
+bin(pq, x);
+pq->many++;
+}
+/* ************************************************************************//**
+@brief   Order doubles.
+*//***************************************************************************/
+static int
+ ascending(const void *pv1, const void *pv2)
+{
+double x1, x2;
+
+x1 = *(const double *)pv1; x2 = *(const double *)pv2;
+return (x1 < x2) ? -1 : (x1 > x2) ? 1 : 0;
+}
+/* ************************************************************************//**
+@brief   A quantile: exact, by interpolation between the values in order, if
+         no more than QNT_MANYFIRST have been seen.
+@param   pq    The histogram.
+@param   p     The probability, 0 <= p <= 1.
+@return        The quantile, or NaN if no value has been seen.
+*//***************************************************************************/
+double
+ qntvalue(const struct qnt *pq, double p)
+{
+double sorted[QNT_MANYFIRST], want, below, x;
+int k;
+
+if (0 >= pq->many) return NAN;
+if (0. == pq->width)
+  {
+  memcpy(sorted, pq->first, pq->many*sizeof(double));
+  qsort(sorted, pq->many, sizeof(double), ascending);
+  want = p*(pq->many - 1); k = (int)want;
+  if (k + 1 >= pq->many) return sorted[pq->many - 1];
+  return sorted[k] + (want - k)*(sorted[k + 1] - sorted[k]);
+  }
+want = p*pq->many; below = 0.;
+for (k = 0; k < QNT_MANYBIN - 1; k++)
+  {
+  if (below + pq->bin[k] >= want) break;
+  below += pq->bin[k];
+  }
+x = pq->origin + pq->width*(pq->bin[k] ? k + (want - below)/pq->bin[k] : k);
+if (x < pq->lo) x = pq->lo;
+if (x > pq->hi) x = pq->hi;
+return x;
+}
+/* ***************************************************************************/
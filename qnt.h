@@ -0,0 +1,56 @@
+/* ************************************************************//** @file qnt.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the streaming histogram of quantiles.
+
+A histogram follows a stream of values in constant memory, whatever its
+length, and gives any quantile of them to within a bin, as ens.c does for
+the replicates of cov; but the values may have any range, which need not be
+known in advance: the bins widen by doubling whenever a value falls outside.
+*//* *************************************************************************/
+
+#ifndef COV_QUANTILE_H
+#define COV_QUANTILE_H
+
+#include <stdint.h>
+
+#define QNT_MANYBIN   (1024)  /**< Bins of a histogram                       */
+#define QNT_MANYFIRST (64)    /**< Values kept exactly, which place the bins */
+
+/** Histogram of a stream of values */
+struct qnt
+  {
+  long      many;             /**< Values seen                               */
+  double    lo;               /**< Least value seen                          */
+  double    hi;               /**< Greatest value seen                       */
+  double    origin;           /**< Lower edge of the first bin               */
+  double    width;            /**< Width of a bin, or zero until the first
+                                   QNT_MANYFIRST values have been seen       */
+  double    first[QNT_MANYFIRST]; /**< The first values                      */
+  uint32_t  bin[QNT_MANYBIN]; /**< Values in each bin                        */
+  };
+
+void   qntinit(struct qnt *);
+void   qntadd(struct qnt *, double);
+double qntvalue(const struct qnt *, double);
+
+#endif /*COV_QUANTILE_H*/
@@ -0,0 +1,354 @@
+/* ************************************************************//** @file rdr.c
+@copyright
+Copyright (C) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Reader of the output files of cov, and of any text file of columns.
+
+Each file is mapped into memory rather than read through a buffer, and each
+number is parsed by rdrfloat(), which handles the plain decimals written by
+cov without calling strtod(): up to 19 significant digits and a power of ten
+no greater than 22 in size give a correctly rounded double from a single
+multiplication or division by an exact power of ten, and anything else is
+passed to strtod(), as are words such as inf and nan.
+*//* *************************************************************************/
+#define _GNU_SOURCE               /* for mremap() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rdr.h"
+
+/** Powers of ten held exactly in a double */
+static const double exact[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, \
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, \
+                                                           1e20, 1e21, 1e22};
+
+/* ************************************************************************//**
+@brief   Parse a number.
+@param   p1    Its first character.
+@param   pend  The end of the text, which need not end in a zero.
+@param   pp    Set to the character after the number, or to  p1  if there
+               is none.
+@return        The number.
+*//***************************************************************************/
+double
+ rdrfloat(const char *p1, const char *pend, const char **pp)
+{
+char bf[64], *pbf;
+const char *p2, *p3;
+uint64_t mantissa;
+double x;
+int negative, digits, lost, power, exp10, esign, any;
+size_t sz;
+
+p2 = p1; negative = 0;
+if ((p2 < pend) && (('-' == *p2) || ('+' == *p2))) negative = ('-' == *p2++);
+mantissa = 0; digits = 0; lost = 0; power = 0; any = 0;
+for (esign = 0; esign < 2; esign++)
+  {
+  while ((p2 < pend) && isdigit((unsigned char)*p2))
+    {
+    if (19 > digits)
+      {
+      mantissa = 10 * mantissa + (*p2 - '0');
+      if (mantissa) digits++;
+      power -= esign;
+      }
+    else { lost |= ('0' != *p2); power += ! esign; }
+    p2++; any = 1;
+    }
+  if (esign || (p2 >= pend) || ('.' != *p2)) break;
+  p2++;
+  }
+if ( ! any)
+  {
+  for (sz = 0; (p1 + sz < pend) && ( ! isspace((unsigned char)p1[sz])) && \
+                                             (sizeof(bf) - 1 > sz); sz++) {;}
+  memcpy(bf, p1, sz); bf[sz] = 0;
+  x = strtod(bf, &pbf);
+  *pp = p1 + (pbf - bf);
+  return x;
+  }
+if ((p2 < pend) && (('e' == *p2) || ('E' == *p2)))
+  {
+  p3 = p2 + 1; esign = 1; exp10 = 0;
+  if ((p3 < pend) && (('-' == *p3) || ('+' == *p3))) esign = ('-' == *p3++) ? -1 : 1;
+  if ((p3 < pend) && isdigit((unsigned char)*p3))
+    {
+    while ((p3 < pend) && isdigit((unsigned char)*p3))
+      {
+      if (10000 > exp10) exp10 = 10 * exp10 + (*p3 - '0');
+      p3++;
+      }
+    power += esign * exp10; p2 = p3;
+    }
+  }
+*pp = p2;
+/*-----------------------------------------------------------------------------
+THE FAST PATH, EXACT WHEN BOTH THE MANTISSA AND THE POWER OF TEN ARE EXACT
+-----------------------------------------------------------------------------*/
+if (( ! lost) && (((uint64_t)1 << 53) >= mantissa) && \
+                                             (-22 <= power) && (22 >= power))
+  {
+  x = (double)mantissa;
+  x = (0 > power) ? x / exact[-power] : x * exact[power];
+  return negative ? -x : x;
+  }
+sz = p2 - p1; if (sz >= sizeof(bf)) sz = sizeof(bf) - 1;
+memcpy(bf, p1, sz); bf[sz] = 0;
+return strtod(bf, NULL);
+}
+/* ************************************************************************//**
+@brief   Map the whole of a file as it now is, mapping it afresh if it has
+         grown since it was last mapped.
+@return        Zero unless error.
+*//***************************************************************************/
+static int
+ map(struct rdr *prdr)
+{
+struct stat stat0;
+size_t size;
+void *pnew;
+
+if (fstat(prdr->fd, &stat0))
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", prdr->pname);
+  return -16;
+  }
+size = (size_t)stat0.st_size;
+if (size < prdr->size)
+  {
+  fprintf(stderr, "ERROR: input file has shrunk: %s\n", prdr->pname);
+  return -16;
+  }
+if (size == prdr->size) return 0;
+if (prdr->pbase) pnew = mremap(prdr->pbase, prdr->size, size, MREMAP_MAYMOVE);
+else pnew = mmap(NULL, size, PROT_READ, MAP_PRIVATE, prdr->fd, 0);
+if (MAP_FAILED == pnew)
+  {
+  fprintf(stderr, "ERROR: cannot map input file: %s\n", prdr->pname);
+  return -16;
+  }
+prdr->pbase = (char *)pnew; prdr->size = size;
+madvise(prdr->pbase, prdr->size, MADV_SEQUENTIAL);
+return 0;
+}
+/* ************************************************************************//**
+@brief   Read the headings, copying them one after another, each ending in a
+         zero.  A file being followed may not yet have a whole first line,
+         and its headings are then left until it has.
+@return        Zero unless error.
+*//***************************************************************************/
+static int
+ headings(struct rdr *prdr)
+{
+const char *p1, *p2, *pend;
+char *pout;
+
+pend = prdr->pbase + prdr->size;
+for (p1 = prdr->pbase; (p1 < pend) && ('\n' != *p1); p1++) {;}
+if (prdr->follow && (p1 >= pend)) return 0;
+if (NULL == (prdr->phead = (char *)malloc(p1 - prdr->pbase + 1)))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+pend = p1; pout = prdr->phead;
+for (p1 = prdr->pbase; p1 < pend; p1 = p2)
+  {
+  while ((p1 < pend) && isspace((unsigned char)*p1)) { p1++; }
+  if (p1 >= pend) break;
+  for (p2 = p1; (p2 < pend) && ( ! isspace((unsigned char)*p2)); p2++)
+    {
+    *pout++ = *p2;
+    }
+  *pout++ = 0; prdr->manycolumn++;
+  }
+prdr->at = (pend < prdr->pbase + prdr->size) ? pend - prdr->pbase + 1 \
+                                             : prdr->size;
+prdr->line = 1;
+if ( ! prdr->manycolumn)
+  {
+  fprintf(stderr, "ERROR: no headings in input file: %s\n", prdr->pname);
+  return -1;
+  }
+if (NULL == (prdr->prow = (double *)calloc(prdr->manycolumn, sizeof(double))))
+  {
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Open a file and read its headings.
+@param   prdr  The reader.
+@param   pfnm  The file.
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ rdropen(struct rdr *prdr, const char *pfnm)
+{
+int rc;
+
+memset(prdr, 0, sizeof(struct rdr));
+prdr->pname = pfnm;
+if (0 > (prdr->fd = open(pfnm, O_RDONLY)))
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", pfnm); return -16;
+  }
+if ((0 > (rc = map(prdr))) || (0 > (rc = headings(prdr)))) rdrclose(prdr);
+return rc;
+}
+/* ************************************************************************//**
+@brief   Open a file which may still be growing, as the output of a run of
+         cov given -f: it may not yet have its headings, and a last line not
+         ending in a newline is not read until it does.  Call rdrmore() when
+         the file has grown.
+@param   prdr  The reader.
+@param   pfnm  The file.
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ rdrfollow(struct rdr *prdr, const char *pfnm)
+{
+int rc;
+
+memset(prdr, 0, sizeof(struct rdr));
+prdr->pname = pfnm; prdr->follow = 1;
+if (0 > (prdr->fd = open(pfnm, O_RDONLY)))
+  {
+  fprintf(stderr, "ERROR: cannot open input file: %s\n", pfnm); return -16;
+  }
+if ((0 > (rc = map(prdr))) || (0 > (rc = headings(prdr)))) rdrclose(prdr);
+return rc;
+}
+/* ************************************************************************//**
+@brief   Take in what has been added to a file being followed, reading its
+         headings if they are now whole.  Only the new part is read by later
+         calls of rdrnext().
+@return        Zero unless error.
+*//***************************************************************************/
+int
+ rdrmore(struct rdr *prdr)
+{
+int rc;
+
+if (0 > (rc = map(prdr))) return rc;
+if (NULL == prdr->phead) return headings(prdr);
+return 0;
+}
+/* ************************************************************************//**
+@brief   The heading of a column.
+*//***************************************************************************/
+const char *
+ rdrheading(const struct rdr *prdr, int column)
+{
+const char *p1;
+
+if ((0 > column) || (column >= prdr->manycolumn)) return NULL;
+for (p1 = prdr->phead; column; column--) { p1 += strlen(p1) + 1; }
+return p1;
+}
+/* ************************************************************************//**
+@brief   The column with a heading.
+@return  The column, counting from zero, or -1 if there is none.
+*//***************************************************************************/
+int
+ rdrcolumn(const struct rdr *prdr, const char *pwant)
+{
+const char *p1;
+int column;
+
+for (column = 0, p1 = prdr->phead; column < prdr->manycolumn; column++)
+  {
+  if ( ! strcmp(pwant, p1)) return column;
+  p1 += strlen(p1) + 1;
+  }
+return -1;
+}
+/* ************************************************************************//**
+@brief   Read the next row into  .prow, skipping blank lines.  Only whole
+         lines, ending in a newline, are read, but for the last of a file
+         not being followed.
+@return  One if a row was read, zero at the end of the file, negative if
+         error.
+*//***************************************************************************/
+int
+ rdrnext(struct rdr *prdr)
+{
+const char *p1, *p2, *pend;
+int column;
+
+if (NULL == prdr->phead) return 0;
+while (prdr->at < prdr->size)
+  {
+  p1 = prdr->pbase + prdr->at;
+  pend = memchr(p1, '\n', prdr->size - prdr->at);
+  if ((NULL == pend) && prdr->follow) return 0;
+  if (NULL == pend) pend = prdr->pbase + prdr->size;
+  prdr->at = pend - prdr->pbase + (pend < prdr->pbase + prdr->size);
+  prdr->line++;
+  for (column = 0; ; column++)
+    {
+    while ((p1 < pend) && isspace((unsigned char)*p1)) { p1++; }
+    if (p1 >= pend) break;
+    if (column >= prdr->manycolumn)
+      {
+      fprintf(stderr, "ERROR: too many columns at line %i in file %s\n", \
+                                                   prdr->line, prdr->pname);
+      return -1;
+      }
+    prdr->prow[column] = rdrfloat(p1, pend, &p2);
+    if ((p2 == p1) || ((p2 < pend) && ( ! isspace((unsigned char)*p2))))
+      {
+      fprintf(stderr, "ERROR: cannot understand data at column %i, " \
+                    "line %i in file %s\n", column, prdr->line, prdr->pname);
+      return -1;
+      }
+    p1 = p2;
+    }
+  if ( ! column) continue;
+  if (column < prdr->manycolumn)
+    {
+    fprintf(stderr, "ERROR: insufficient data at line %i in file %s\n", \
+                                                   prdr->line, prdr->pname);
+    return -1;
+    }
+  return 1;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Close a file, releasing all that its reader holds.
+*//***************************************************************************/
+void
+ rdrclose(struct rdr *prdr)
+{
+if (prdr->pbase) munmap(prdr->pbase, prdr->size);
+if (0 <= prdr->fd) close(prdr->fd);
+free(prdr->phead); free(prdr->prow);
+prdr->pbase = NULL; prdr->fd = -1; prdr->phead = NULL; prdr->prow = NULL;
+}
+/* ***************************************************************************/
@@ -0,0 +1,61 @@
+/* ************************************************************//** @file rdr.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the reader of the output files of cov.
+
+A reader maps a whole file into memory and parses it one row at a time, so
+the memory it needs is that of one row, however long the file and however
+many files are read at once.  The first line gives the heading of each
+column; every other line is a row of numbers.  A file still being written
+may be followed, its new rows being read as they appear.
+*//* *************************************************************************/
+
+#ifndef COV_READER_H
+#define COV_READER_H
+
+#include <stddef.h>
+
+/** A file being read */
+struct rdr
+  {
+  const char *pname;          /**< The file                                  */
+  int         fd;             /**< Its descriptor, or -1                     */
+  char       *pbase;          /**< Its contents, mapped, or NULL if empty    */
+  size_t      size;           /**< Bytes mapped                              */
+  size_t      at;             /**< Offset of the next line to be read        */
+  int         line;           /**< Number of the line last read              */
+  int         manycolumn;     /**< Columns named by the headings             */
+  char       *phead;          /**< The headings, each ending in a zero       */
+  double     *prow;           /**< The values of the row last read           */
+  int         follow;         /**< Non-zero if the file may still grow       */
+  };
+
+int    rdropen(struct rdr *, const char *);
+int    rdrcolumn(const struct rdr *, const char *);
+const char *rdrheading(const struct rdr *, int);
+int    rdrfollow(struct rdr *, const char *);
+int    rdrmore(struct rdr *);
+int    rdrnext(struct rdr *);
+void   rdrclose(struct rdr *);
+double rdrfloat(const char *, const char *, const char **);
+
+#endif /*COV_READER_H*/
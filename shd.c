@@ -0,0 +1,794 @@
+/* ************************************************************//** @file shd.c
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief A synchronous epidemic run by shards, separate processes each owning a
+       contiguous range of nodes.
+
+This is a model of its own, not the epidemic of episweep() split up.  There
+each node sees the states its neighbours were given earlier the same day, in
+an order shuffled over all the nodes, which shards could only follow by
+meeting at every node.  Here the day is synchronous instead: every node is
+updated from the states of the day before, and the draws are the common
+random numbers of epicatch(), keyed by day, node and neighbour.  The result
+is therefore the same for any number of shards, but it is not that of the
+serial run on the same network, and is named apart from it.
+
+No process holds the whole network.  Each shard builds the lists of its own
+nodes by replaying the random stream of every range of swnpar() through
+swnowned(), keeping the links with an end among its nodes; this costs it the
+draws of the whole network, but no memory beyond one range.  The rare pairs
+of rewired links that coincide, which swnpar() redraws, are merged instead,
+so the network is that of swnpar() save where such a pair arose.  Patient
+zero and the inert nodes are drawn from the common random numbers as
+epiinit() draws them.  Each shard then publishes its halo, the nodes with a
+neighbour in another shard, whether across the boundary of the range or
+along a rewired link, and once all have, finds where in the halo of the
+others each of its outside neighbours lies.  The halo and the counts of each
+day are double buffered in shared memory, so that one barrier a day
+suffices: a shard writes the halo of day  d + 1  while others may still be
+reading that of day  d.
+
+Under NUMA placement each shard is pinned to a CPU before it allocates
+anything, the shards of each NUMA node being contiguous ranges, so that its
+nodes and lists are first touched, and so placed, on its own NUMA node, as
+is its part of the halo, which it alone writes.  At the end each shard looks
+up where the pages of its arrays lie and, where the system allows, counts
+its loads from memory and those served by another node.
+*//* *************************************************************************/
+#define _GNU_SOURCE               /* for sched_setaffinity() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "swn.h"
+#include "epi.h"
+#include "prf.h"
+#include "shd.h"
+
+#define SHD_LAPSE (1)         /**< Seconds between looks for a lost shard    */
+#define SHD_MANYPAGE (256)    /**< Pages looked up at a time by pages()      */
+
+/** The head of the memory shared by the shards: a barrier */
+struct shdshared
+  {
+  pthread_mutex_t lock;       /**< Guards all that follows                   */
+  pthread_cond_t  cond;       /**< Signals the barrier passed, or a failure  */
+  int             many;       /**< Shards                                    */
+  int             arrived;    /**< Shards waiting at the barrier             */
+  unsigned int    generation; /**< Barriers passed                           */
+  int             failed;     /**< Set once any shard has failed             */
+  pid_t           parent;     /**< Shard zero                                */
+  };
+
+/** What the parent works out for the shards before forking */
+struct shdplan
+  {
+  unsigned int      seedswn;  /**< Seed of the network, as for swnpar()      */
+  int               manynode; /**< Nodes                                     */
+  int             halfdegree; /**< Half the degree of nodes in the ring      */
+  double            dbeta;    /**< The rewiring fraction                     */
+  uint64_t          common;   /**< Key of the common random numbers          */
+  int               chance;   /**< Chance of infection, as for epiinit()     */
+  int               inert;    /**< Fraction of inert nodes, likewise         */
+  int             incubating; /**< Days before infectious, likewise          */
+  int               recovery; /**< Days before recovered, likewise           */
+  int              *pzero;    /**< Candidates for patient zero, by epizero() */
+  FILE             *pfout;    /**< Output, written by shard zero             */
+  int               flush;    /**< Non-zero to flush each day                */
+  int               manyday;  /**< Days to run                               */
+  int               manyshard;/**< Shards                                    */
+  int              *plo;      /**< First node of each shard, and manynode    */
+  struct shdshared *psh;      /**< The barrier, in shared memory             */
+  long             *pcount;   /**< Cases and edges, [2][shard][2], shared    */
+  long             *pstub;    /**< Length of the lists of each shard, shared */
+  int              *pmanyhalo;/**< Nodes in the halo of each shard, shared   */
+  int              *pdegree;  /**< Degree of each candidate, shared          */
+  int              *phalo0;   /**< Nodes of the halo, ascending, those of
+                                   shard  k  from .plo[k], shared            */
+  int              *phalo;    /**< States of the halo, [2][manynode], shared */
+  int               numa;     /**< Non-zero to pin the shards (see above)    */
+  int              *pnuma;    /**< NUMA node of each shard, or -1 if unknown */
+  int              *pcpu;     /**< CPU of each shard                         */
+  struct shdplace  *pplace;   /**< Where each shard's memory lies, shared    */
+  };
+
+/** Where the memory of a shard lies, under NUMA placement */
+struct shdplace
+  {
+  long      pages;            /**< Pages of its arrays, or -1 if unknown     */
+  long      remote;           /**< Those of them on another NUMA node        */
+  uint64_t  loads;            /**< Its loads from memory                     */
+  uint64_t  misses;           /**< Those of them served by another node      */
+  int       counted;          /**< Non-zero if .loads and .misses are known  */
+  };
+
+/* ************************************************************************//**
+@brief   Find the shard that owns a node.
+*//***************************************************************************/
+static int
+ owner(const struct shdplan *pl, int j)
+{
+int lo, hi, k;
+
+lo = 0; hi = pl->manyshard;
+while (1 < hi - lo)
+  {
+  k = (lo + hi) / 2;
+  if (pl->plo[k] <= j) lo = k; else hi = k;
+  }
+return lo;
+}
+/* ************************************************************************//**
+@brief   Mark the shards as failed, releasing any waiting at the barrier.
+*//***************************************************************************/
+static void
+ fail(struct shdshared *psh)
+{
+pthread_mutex_lock(&psh->lock);
+psh->failed = 1;
+pthread_cond_broadcast(&psh->cond);
+pthread_mutex_unlock(&psh->lock);
+}
+/* ************************************************************************//**
+@brief   Wait until every shard has reached the barrier.
+@param   k   The shard.  Every SHD_LAPSE seconds, shard zero looks for a
+             shard that has died and the others for the death of shard
+             zero, lest any wait for ever.
+@return  Zero, or -1 if any shard has failed.
+*//***************************************************************************/
+static int
+ barrier(struct shdshared *psh, int k)
+{
+struct timespec ts;
+siginfo_t info;
+unsigned int generation;
+int failed;
+
+pthread_mutex_lock(&psh->lock);
+generation = psh->generation;
+if (psh->many == ++psh->arrived)
+  {
+  psh->arrived = 0; psh->generation++;
+  pthread_cond_broadcast(&psh->cond);
+  }
+else while ((generation == psh->generation) && ! psh->failed)
+  {
+  clock_gettime(CLOCK_REALTIME, &ts); ts.tv_sec += SHD_LAPSE;
+  if (ETIMEDOUT != pthread_cond_timedwait(&psh->cond, &psh->lock, &ts)) \
+                                                                      continue;
+  memset(&info, 0, sizeof(info));
+  if (k && (getppid() != psh->parent)) psh->failed = 1;
+  else if ( ! k && (0 == waitid(P_ALL, 0, &info, \
+                         WEXITED | WNOHANG | WNOWAIT)) && info.si_pid)
+    {
+    fprintf(stderr, "ERROR: shard process %i died\n", (int)info.si_pid);
+    psh->failed = 1;
+    }
+  }
+failed = psh->failed;
+pthread_mutex_unlock(&psh->lock);
+return failed ? -1 : 0;
+}
+/* ************************************************************************//**
+@brief   Add the CPUs of a list such as  0-3,8,10-11  to a set.
+@return  Zero, or -1 if the list is malformed.
+*//***************************************************************************/
+static int
+ cpulist(const char *plist, cpu_set_t *pset)
+{
+char *pend;
+long a, b;
+
+while (('\0' != *plist) && ('\n' != *plist))
+  {
+  a = strtol(plist, &pend, 10);
+  if (pend == plist) return -1;
+  b = a;
+  if ('-' == *pend) { plist = pend + 1; b = strtol(plist, &pend, 10); }
+  if ((pend == plist) || (0 > a) || (b < a)) return -1;
+  for ( ; (a <= b) && (CPU_SETSIZE > a); a++) CPU_SET((int)a, pset);
+  plist = pend;
+  if (',' == *plist) plist++;
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Assign each shard a NUMA node and a CPU of it, among the CPUs this
+         process may use, dealing contiguous shards to each node in turn.
+         Without /sys/devices/system/node the nodes are unknown, and the
+         shards are dealt over the CPUs alone.
+@param   pl  The plan, whose .pnuma and .pcpu are set.
+@return  Zero unless error.
+*//***************************************************************************/
+static int
+ place(struct shdplan *pl)
+{
+char path[64], line[4096];
+cpu_set_t allowed, online, *pset;
+FILE *pf;
+int *pid;
+int manynuma, m, c, i, k, first;
+
+if (sched_getaffinity(0, sizeof(allowed), &allowed))
+  {
+  fprintf(stderr, "ERROR: cannot read the CPUs allowed: %s\n", \
+                                                             strerror(errno));
+  return -1;
+  }
+CPU_ZERO(&online);
+if ((pf = fopen("/sys/devices/system/node/online", "r")))
+  {
+  if ((NULL == fgets(line, sizeof(line), pf)) || cpulist(line, &online)) \
+                                                           CPU_ZERO(&online);
+  fclose(pf);
+  }
+m = CPU_COUNT(&online);
+pset = (cpu_set_t *)malloc((m ? m : 1) * sizeof(cpu_set_t));
+pid = (int *)malloc((m ? m : 1) * sizeof(int));
+if ((NULL == pset) || (NULL == pid))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n");
+  free(pset); free(pid); return -8;
+  }
+/*-----------------------------------------------------------------------------
+THE NUMA NODES ONLINE, EACH WITH THE ALLOWED CPUS OF ITS  cpulist
+-----------------------------------------------------------------------------*/
+for (k = 0, manynuma = 0; (CPU_SETSIZE > k) && m; k++)
+  {
+  if ( ! CPU_ISSET(k, &online)) continue;
+  m--;
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%i/cpulist", k);
+  CPU_ZERO(pset + manynuma);
+  if (NULL == (pf = fopen(path, "r"))) continue;
+  if (fgets(line, sizeof(line), pf) && ! cpulist(line, pset + manynuma))
+    {
+    CPU_AND(pset + manynuma, pset + manynuma, &allowed);
+    if (CPU_COUNT(pset + manynuma)) pid[manynuma++] = k;
+    }
+  fclose(pf);
+  }
+if ( ! manynuma) { pset[0] = allowed; pid[0] = -1; manynuma = 1; }
+/*-----------------------------------------------------------------------------
+SHARD  k  GOES TO NODE  m, AND THE SHARDS  first  ON OF THAT NODE TAKE ITS
+CPUS IN TURN
+-----------------------------------------------------------------------------*/
+for (k = 0; k < pl->manyshard; k++)
+  {
+  m = (int)(((long)k * manynuma) / pl->manyshard);
+  for (first = k; 0 < first; first--)
+    {
+    if (m != (int)(((long)(first - 1) * manynuma) / pl->manyshard)) break;
+    }
+  i = (k - first) % CPU_COUNT(pset + m);
+  for (c = 0; ; c++) { if (CPU_ISSET(c, pset + m) && (0 > --i)) break; }
+  pl->pnuma[k] = pid[m]; pl->pcpu[k] = c;
+  }
+free(pset); free(pid);
+return 0;
+}
+/* ************************************************************************//**
+@brief   Count the pages of an array, and those on other than a NUMA node.
+@param   numa     The NUMA node, or -1 to count the pages alone.
+@param   pplace   Where to add the counts; .pages becomes -1 if the system
+                  cannot say where pages lie.
+*//***************************************************************************/
+static void
+ pages(const void *p, size_t size, int numa, struct shdplace *pplace)
+{
+#ifdef SYS_move_pages
+void *ppage[SHD_MANYPAGE];
+int status[SHD_MANYPAGE];
+uintptr_t page, at, end;
+int many, n;
+
+if ((0 > pplace->pages) || (0 == size)) return;
+page = (uintptr_t)sysconf(_SC_PAGESIZE);
+at = (uintptr_t)p & ~(page - 1); end = (uintptr_t)p + size;
+while (at < end)
+  {
+  for (many = 0; (SHD_MANYPAGE > many) && (at < end); many++, at += page)
+    {
+    ppage[many] = (void *)at;
+    }
+  if (syscall(SYS_move_pages, 0, (unsigned long)many, ppage, NULL, status, 0))
+    {
+    pplace->pages = -1; return;
+    }
+  for (n = 0; n < many; n++)
+    {
+    if (0 > status[n]) continue;
+    pplace->pages++;
+    if ((0 <= numa) && (numa != status[n])) pplace->remote++;
+    }
+  }
+#else
+(void)p; (void)size; (void)numa; pplace->pages = -1;
+#endif
+}
+/* ************************************************************************//**
+@brief   Write where the memory of each shard lay, and its loads, to stderr.
+*//***************************************************************************/
+static void
+ report(const struct shdplan *pl)
+{
+const struct shdplace *pp;
+int k;
+
+fprintf(stderr, "Shard  NUMA   CPU       Pages  Remote" \
+                                            "          Loads  Remote\n");
+for (k = 0; k < pl->manyshard; k++)
+  {
+  pp = pl->pplace + k;
+  fprintf(stderr, "%5i  %4i  %4i", k, pl->pnuma[k], pl->pcpu[k]);
+  if (0 > pp->pages) fprintf(stderr, "  %10s  %6s", "-", "-");
+  else fprintf(stderr, "  %10li  %5.1f%%", pp->pages, \
+          pp->pages ? (100. * (double)pp->remote) / (double)pp->pages : 0.);
+  if ( ! pp->counted) fprintf(stderr, "  %13s  %6s\n", "-", "-");
+  else fprintf(stderr, "  %13llu  %5.1f%%\n", (unsigned long long)pp->loads, \
+          pp->loads ? (100. * (double)pp->misses) / (double)pp->loads : 0.);
+  }
+}
+/* ************************************************************************//**
+@brief   Build the lists of the nodes of a shard, replaying every range of
+         swnpar() to find the links with an end among them.  Each list is
+         ascending, with any duplicate merged, and each neighbour its node.
+@param   pl       The plan.
+@param   k        The shard.
+@param   ppstart  Where to put the start of each list, and the end of all.
+@param   ppadj    Where to put the lists.
+@return  Zero unless error.
+*//***************************************************************************/
+static int
+ build(const struct shdplan *pl, int k, long **ppstart, int **ppadj)
+{
+int *ptarget, *ppair, *padj;
+long *pstart;
+long manypair, roompair, e, f, a, b, end;
+void *pnew;
+int lo, n, c, many, i, j, l, m, g, kk;
+
+lo = pl->plo[k]; n = pl->plo[k + 1] - lo; kk = pl->halfdegree;
+*ppstart = NULL; *ppadj = NULL;
+roompair = (2 * (long)kk * n) + 1024;
+ptarget = (int *)malloc((size_t)SWN_RANGE * kk * sizeof(int));
+ppair = (int *)malloc(2 * roompair * sizeof(int));
+pstart = (long *)calloc(n + 1, sizeof(long));
+if ((NULL == ptarget) || (NULL == ppair) || (NULL == pstart))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n");
+  free(ptarget); free(ppair); free(pstart); return -8;
+  }
+/*-----------------------------------------------------------------------------
+KEEP EACH LINK WITH AN END IN THE SHARD, AS THE PAIR  (local node, far end)
+-----------------------------------------------------------------------------*/
+for (c = 0, manypair = 0; 0 < (many = swnowned(pl->seedswn, pl->manynode, \
+                                      kk, pl->dbeta, c, ptarget)); c++)
+  {
+  for (i = 0; i < many; i++)
+    {
+    if (manypair + (2 * kk) > roompair)
+      {
+      if (NULL == (pnew = realloc(ppair, 4 * roompair * sizeof(int))))
+        {
+        fprintf(stderr, "ERROR: memory allocation refused\n");
+        free(ptarget); free(ppair); free(pstart); return -8;
+        }
+      ppair = (int *)pnew; roompair *= 2;
+      }
+    j = (c * SWN_RANGE) + i;
+    for (l = 0; l < kk; l++)
+      {
+      m = *(ptarget + ((size_t)i * kk) + l);
+      if ((unsigned int)(j - lo) < (unsigned int)n)
+        {
+        ppair[2 * manypair] = j - lo; ppair[2 * manypair++ + 1] = m;
+        }
+      if ((unsigned int)(m - lo) < (unsigned int)n)
+        {
+        ppair[2 * manypair] = m - lo; ppair[2 * manypair++ + 1] = j;
+        }
+      }
+    }
+  }
+free(ptarget);
+/*-----------------------------------------------------------------------------
+GATHER THE PAIRS BY NODE, THEN SORT EACH LIST AND MERGE ITS DUPLICATES
+-----------------------------------------------------------------------------*/
+if (NULL == (padj = (int *)malloc((manypair ? manypair : 1) * sizeof(int))))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n");
+  free(ppair); free(pstart); return -8;
+  }
+for (e = 0; e < manypair; e++) { pstart[ppair[2 * e] + 1]++; }
+for (j = 0; j < n; j++) { pstart[j + 1] += pstart[j]; }
+for (e = 0; e < manypair; e++)
+  {
+  padj[pstart[ppair[2 * e]]++] = ppair[2 * e + 1];
+  }
+for (j = n; 0 < j; j--) { pstart[j] = pstart[j - 1]; }
+pstart[0] = 0;
+free(ppair);
+for (j = 0, f = 0; j < n; j++)
+  {
+  e = pstart[j]; end = pstart[j + 1]; pstart[j] = f;
+  for (a = e + 1; a < end; a++)
+    {
+    g = padj[a];
+    for (b = a; (e < b) && (padj[b - 1] > g); b--) { padj[b] = padj[b - 1]; }
+    padj[b] = g;
+    }
+  for (; e < end; e++)
+    {
+    if ((pstart[j] == f) || (padj[f - 1] != padj[e])) padj[f++] = padj[e];
+    }
+  }
+pstart[n] = f;
+if (f && (NULL != (pnew = realloc(padj, f * sizeof(int)))))
+  {
+  padj = (int *)pnew;
+  }
+*ppstart = pstart; *ppadj = padj;
+return 0;
+}
+/* ************************************************************************//**
+@brief   Run one shard of the epidemic to the end.
+@param   pl  The plan.
+@param   k   The shard.  Shard zero writes the output.
+@return  Zero unless error.
+*//***************************************************************************/
+static int
+ shard(const struct shdplan *pl, int k)
+{
+struct epidemic epi;
+struct shdplace *pplace;
+struct prf prf;
+cpu_set_t set;
+uint64_t value[PRF_MANY];
+unsigned char *pinert;
+long *pstart, *pc;
+long stub, e, manyedge;
+uint64_t today;
+int *padj, *pday, *pold, *pnew, *pin, *pout, *phalo0;
+int lo, n, manyshard, manynode, manyhalo, d, i, j, g, owns, lot, hi, mid;
+int day, zero, manycase, rc;
+
+manyshard = pl->manyshard; manynode = pl->manynode;
+lo = pl->plo[k]; n = pl->plo[k + 1] - lo;
+prf.many = 0;
+if (pl->numa)
+  {
+  CPU_ZERO(&set); CPU_SET(pl->pcpu[k], &set);
+  if (sched_setaffinity(0, sizeof(set), &set))
+    {
+    fprintf(stderr, "WORRY: cannot pin shard %i to CPU %i: %s\n", k, \
+                                               pl->pcpu[k], strerror(errno));
+    }
+  }
+if (0 > (rc = build(pl, k, &pstart, &padj))) { fail(pl->psh); return rc; }
+stub = pstart[n];
+pday = (int *)malloc(2 * n * sizeof(int));
+pinert = (unsigned char *)malloc(n);
+if ((NULL == pday) || (NULL == pinert))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n");
+  free(pstart); free(padj); free(pday); free(pinert);
+  fail(pl->psh); return -8;
+  }
+/*-----------------------------------------------------------------------------
+PUBLISH THE HALO, AND THE DEGREE OF ANY CANDIDATE FOR PATIENT ZERO IN THE
+SHARD, AND MEET
+-----------------------------------------------------------------------------*/
+phalo0 = pl->phalo0 + lo;
+for (j = 0, manyhalo = 0; j < n; j++)
+  {
+  for (e = pstart[j]; e < pstart[j + 1]; e++)
+    {
+    if ((lo > padj[e]) || (lo + n <= padj[e])) break;
+    }
+  if (e < pstart[j + 1]) phalo0[manyhalo++] = lo + j;
+  }
+pl->pmanyhalo[k] = manyhalo;
+for (i = 0; i < 2 * pl->halfdegree; i++)
+  {
+  g = pl->pzero[i];
+  if ((lo <= g) && (lo + n > g))
+    {
+    pl->pdegree[i] = (int)(pstart[g - lo + 1] - pstart[g - lo]);
+    }
+  }
+rc = barrier(pl->psh, k);
+/*-----------------------------------------------------------------------------
+MAKE EACH NEIGHBOUR A LOCAL INDEX, OR  -1 - h  FOR PLACE  h  OF THE HALO
+-----------------------------------------------------------------------------*/
+for (e = 0; (0 == rc) && (e < stub); e++)
+  {
+  g = padj[e];
+  if ((lo <= g) && (lo + n > g)) { padj[e] = g - lo; continue; }
+  owns = owner(pl, g);
+  lot = pl->plo[owns]; hi = lot + pl->pmanyhalo[owns];
+  while (lot < hi)
+    {
+    mid = (lot + hi) / 2;
+    if (pl->phalo0[mid] < g) lot = mid + 1; else hi = mid;
+    }
+  padj[e] = -1 - lot;
+  }
+/*-----------------------------------------------------------------------------
+SET DAY ZERO AS epiinit() WOULD: PATIENT ZERO IS THE CANDIDATE WHOSE
+NEIGHBOURS, WITH THOSE OF THE CANDIDATES BEFORE IT, FIRST NUMBER
+2*halfdegree.  EVERY NODE HAS A NEIGHBOUR, SO THERE ARE CANDIDATES ENOUGH.
+-----------------------------------------------------------------------------*/
+for (i = 0, d = pl->pdegree[0]; (2 * pl->halfdegree > d) && \
+                                  (2 * pl->halfdegree - 1 > i); )
+  {
+  d += pl->pdegree[++i];
+  }
+zero = pl->pzero[i];
+for (j = 0, manycase = 0, manyedge = 0; j < n; j++)
+  {
+  pday[j] = (lo + j == zero) ? 1 : 0;
+  pinert[j] = (unsigned char)(pday[j] ? 0 : \
+                                   epiinert(pl->common, pl->inert, lo + j));
+  if (pday[j]) manycase++;
+  else manyedge += pstart[j + 1] - pstart[j];
+  }
+for (i = 0; i < manyhalo; i++) { pl->phalo[lo + i] = pday[phalo0[i] - lo]; }
+pl->pcount[2 * k] = manycase; pl->pcount[2 * k + 1] = manyedge;
+pl->pstub[k] = stub;
+if (0 == rc) rc = barrier(pl->psh, k);
+memset(&epi, 0, sizeof(epi));
+epi.manynode = manynode;
+if ((0 == rc) && (0 == k))
+  {
+  for (i = 0; i < manyshard; i++)
+    {
+    epi.manycase += (int)pl->pcount[2 * i];
+    epi.manyedge += pl->pcount[2 * i + 1]; epi.manystub += pl->pstub[i];
+    }
+  epiline(pl->pfout, &epi);
+  if (pl->flush) fflush(pl->pfout);
+  }
+/*-----------------------------------------------------------------------------
+EACH DAY, UPDATE EVERY NODE FROM THE STATES OF THE DAY BEFORE, PUBLISH THE
+HALO AND THE COUNTS, AND MEET AT THE BARRIER.  SHARD ZERO THEN WRITES THE DAY.
+-----------------------------------------------------------------------------*/
+if (pl->numa) prfnode(&prf);
+for (d = 0; (0 == rc) && (pl->manyday > d); d++)
+  {
+  pold = pday + (d % 2) * n;       pnew = pday + ((d + 1) % 2) * n;
+  pin = pl->phalo + (size_t)(d % 2) * manynode;
+  pout = pl->phalo + (size_t)((d + 1) % 2) * manynode;
+  today = epitoday(pl->common, d);
+  manycase = 0; manyedge = 0;
+  for (j = 0; j < n; j++)
+    {
+    if (pinert[j] || pold[j]) pnew[j] = pold[j] ? pold[j] + 1 : 0;
+    else
+      {
+      pnew[j] = 0;
+      for (e = pstart[j]; e < pstart[j + 1]; e++)
+        {
+        day = (0 <= padj[e]) ? pold[padj[e]] : pin[-1 - padj[e]];
+        if ((pl->incubating < day) && (pl->recovery > day) && \
+            epicatch(today, pl->chance, lo + j, (int)(e - pstart[j])))
+          {
+          pnew[j] = 1; break;
+          }
+        }
+      }
+    if (pnew[j]) manycase++;
+    else manyedge += pstart[j + 1] - pstart[j];
+    }
+  for (i = 0; i < manyhalo; i++) { pout[lo + i] = pnew[phalo0[i] - lo]; }
+  pc = pl->pcount + 2 * (((d + 1) % 2) * manyshard + k);
+  pc[0] = manycase; pc[1] = manyedge;
+  if (0 > (rc = barrier(pl->psh, k)) || k) continue;
+  pc = pl->pcount + 2 * ((d + 1) % 2) * manyshard;
+  epi.day = d + 1; epi.manycase = 0; epi.manyedge = 0;
+  for (i = 0; i < manyshard; i++)
+    {
+    epi.manycase += (int)pc[2 * i]; epi.manyedge += pc[2 * i + 1];
+    }
+  epiline(pl->pfout, &epi);
+  if (pl->flush) fflush(pl->pfout);
+  }
+/*-----------------------------------------------------------------------------
+UNDER NUMA PLACEMENT, SAY WHERE THE ARRAYS LIE AND WHENCE THEY WERE LOADED
+-----------------------------------------------------------------------------*/
+if (pl->numa && (0 == rc))
+  {
+  pplace = pl->pplace + k;
+  pplace->counted = (PRF_MANYNODE == prf.many);
+  prfread(&prf, value); prfclose(&prf);
+  pplace->loads = value[0]; pplace->misses = value[1];
+  pages(pstart, (n + 1) * sizeof(long), pl->pnuma[k], pplace);
+  pages(padj, stub * sizeof(int), pl->pnuma[k], pplace);
+  pages(pday, 2 * n * sizeof(int), pl->pnuma[k], pplace);
+  pages(pinert, n, pl->pnuma[k], pplace);
+  if ((0 == (rc = barrier(pl->psh, k))) && (0 == k)) report(pl);
+  }
+free(pstart); free(padj); free(pday); free(pinert);
+return rc;
+}
+/* ************************************************************************//**
+@brief  Run the synchronous epidemic on shards, each building its own part of
+        the network of swnpar() (see above), and write it out as epidemic()
+        in cov does.
+@param  pfout       The output.
+@param  flush       Non-zero to flush the output after each day.
+@param  seedswn     Seed of the network, as for swnpar().
+@param  manynode    Its nodes.
+@param  halfdegree  Half the degree of nodes in the first-stage ring.
+@param  dbeta       The rewiring fraction.
+@param  manyday     Days to run.
+@param  manyshard   Processes to run it on, the caller being one; at most
+                    manynode are used.
+@param  numa        Non-zero to pin each shard to a CPU, spreading them over
+                    the NUMA nodes, and to report where their memory lay.
+@note   The other parameters are those of epiinit(), with common random
+        numbers always.
+@return             Zero unless error.
+*//* *************************************************************************/
+int
+ shdrun(FILE *pfout, int flush, unsigned int seedswn, int manynode, \
+           int halfdegree, double dbeta, unsigned int seedcov, int chance, \
+               int inert, int incubating, int recovery, int manyday, \
+                                                     int manyshard, int numa)
+{
+struct shdplan plan;
+pthread_mutexattr_t mattr;
+pthread_condattr_t cattr;
+cpu_set_t affinity;
+pid_t *ppid;
+size_t head, size;
+char *pmap;
+int k, m, beta, manyforked, status, rc;
+
+/*-----------------------------------------------------------------------------
+VALIDATE ARGUMENTS, AS swnpar() WOULD
+-----------------------------------------------------------------------------*/
+if ((0 >= halfdegree) || (manynode <= (2 * halfdegree)))
+  {
+  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
+                                                    2 * halfdegree); return -1;
+  }
+beta = (int)(nearbyint(1024. * dbeta));
+if ((0 > beta) || (1024 < beta)) \
+                  { fprintf(stderr, "ERROR: beta out of range\n"); return -1; }
+if (beta && (manynode <= (2 * halfdegree) + 1))
+  {
+  fprintf(stderr, "ERROR: too few nodes to rewire: must exceed %i\n", \
+                                                (2 * halfdegree) + 1); return -1;
+  }
+fprintf(pfout, "Day Infected Uninfected Contacts\n");
+if (flush) fflush(pfout);
+if (manynode < manyshard) manyshard = manynode;
+rc = 0;
+/*-----------------------------------------------------------------------------
+SPLIT THE NODES INTO RANGES, AND DRAW THE CANDIDATES FOR PATIENT ZERO
+-----------------------------------------------------------------------------*/
+memset(&plan, 0, sizeof(plan));
+plan.seedswn = seedswn; plan.manynode = manynode;
+plan.halfdegree = halfdegree; plan.dbeta = dbeta;
+plan.common = epicommon(seedcov); plan.chance = chance; plan.inert = inert;
+plan.incubating = incubating; plan.recovery = recovery;
+plan.pfout = pfout; plan.flush = flush; plan.manyday = manyday;
+plan.manyshard = manyshard; plan.numa = numa;
+plan.plo = (int *)malloc((manyshard + 1) * sizeof(int));
+plan.pzero = (int *)malloc(2 * halfdegree * sizeof(int));
+plan.pnuma = (int *)malloc(manyshard * sizeof(int));
+plan.pcpu = (int *)malloc(manyshard * sizeof(int));
+ppid = (pid_t *)malloc(manyshard * sizeof(pid_t));
+if ((NULL == plan.plo) || (NULL == plan.pzero) || (NULL == plan.pnuma) || \
+                                  (NULL == plan.pcpu) || (NULL == ppid))
+  {
+  fprintf(stderr, "ERROR: memory allocation refused\n");
+  rc = -8; goto out;
+  }
+if (numa && ((0 > (rc = place(&plan))) || \
+                        sched_getaffinity(0, sizeof(affinity), &affinity)))
+  {
+  if (0 == rc) rc = -1;
+  goto out;
+  }
+for (k = 0; k <= manyshard; k++)
+  {
+  plan.plo[k] = (int)(((long)k * manynode) / manyshard);
+  }
+epizero(plan.common, manynode, 2 * halfdegree, plan.pzero);
+/*-----------------------------------------------------------------------------
+MAP THE SHARED MEMORY: THE BARRIER, THEN THE COUNTS, STUBS AND PLACES, THEN
+THE SIZES OF THE HALOS, THE DEGREES OF THE CANDIDATES AND THE HALO.  EACH
+SHARD HAS ROOM IN THE HALO FOR ALL ITS NODES, BUT TOUCHES ONLY WHAT IT USES.
+-----------------------------------------------------------------------------*/
+head = (sizeof(struct shdshared) + 63) & ~(size_t)63;
+size = head + manyshard * (5 * sizeof(long) + sizeof(struct shdplace));
+size += (manyshard + (2 * (size_t)halfdegree) + (3 * (size_t)manynode)) * \
+                                                                   sizeof(int);
+pmap = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, \
+                                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+if (MAP_FAILED == pmap)
+  {
+  fprintf(stderr, "ERROR: cannot map memory for the shards\n");
+  rc = -8; goto out;
+  }
+plan.psh = (struct shdshared *)pmap;
+plan.pcount = (long *)(pmap + head);
+plan.pstub = plan.pcount + 4 * manyshard;
+plan.pplace = (struct shdplace *)(plan.pstub + manyshard);
+plan.pmanyhalo = (int *)(plan.pplace + manyshard);
+plan.pdegree = plan.pmanyhalo + manyshard;
+plan.phalo0 = plan.pdegree + 2 * halfdegree;
+plan.phalo = plan.phalo0 + manynode;
+pthread_mutexattr_init(&mattr);
+pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+pthread_mutex_init(&plan.psh->lock, &mattr);
+pthread_mutexattr_destroy(&mattr);
+pthread_condattr_init(&cattr);
+pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+pthread_cond_init(&plan.psh->cond, &cattr);
+pthread_condattr_destroy(&cattr);
+plan.psh->many = manyshard; plan.psh->parent = getpid();
+/*-----------------------------------------------------------------------------
+FORK THE OTHER SHARDS, RUN SHARD ZERO HERE, AND WAIT FOR THEM
+-----------------------------------------------------------------------------*/
+fflush(pfout); fflush(stdout); fflush(stderr);
+for (k = 1, manyforked = 0; k < manyshard; k++, manyforked++)
+  {
+  if (0 > (ppid[k] = fork()))
+    {
+    fprintf(stderr, "ERROR: cannot fork shard %i: %s\n", k, strerror(errno));
+    fail(plan.psh); rc = -1; break;
+    }
+  if (0 == ppid[k]) _exit(shard(&plan, k) ? 1 : 0);
+  }
+if (0 == rc) rc = shard(&plan, 0);
+for (k = 1; k <= manyforked; k++)
+  {
+  while ((0 > (m = waitpid(ppid[k], &status, 0))) && (EINTR == errno)) ;
+  if ((0 > m) || ! WIFEXITED(status) || WEXITSTATUS(status))
+    {
+    if (0 == rc)
+      {
+      fprintf(stderr, "ERROR: shard %i failed\n", k); rc = -1;
+      }
+    }
+  }
+if (numa) sched_setaffinity(0, sizeof(affinity), &affinity);
+pthread_cond_destroy(&plan.psh->cond);
+pthread_mutex_destroy(&plan.psh->lock);
+munmap(pmap, size);
+out:
+free(plan.plo); free(plan.pzero); free(plan.pnuma); free(plan.pcpu);
+free(ppid);
+return rc;
+}
+/* ***************************************************************************/
@@ -0,0 +1,45 @@
+/* ************************************************************//** @file shd.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the sharded epidemic.
+
+The sharded epidemic is a model of its own: each day is synchronous, every
+node being updated from the states of the day before, so its curve is not
+that of the serial run.  The nodes are split into contiguous ranges, each
+owned by a process of its own, which builds its part of the network itself
+and holds that and the state of its nodes and nothing more.  Each day the
+shards exchange only their halo, the states of the nodes that neighbours in
+other shards read, through shared memory.  Optionally each shard is pinned
+to a CPU, the shards spread over the NUMA nodes, so that the memory each
+uses is its node's own.
+*//* *************************************************************************/
+
+#ifndef COV_SHARD_H
+#define COV_SHARD_H
+
+#include <stdio.h>
+#include "swn.h"
+
+int shdrun(FILE *, int, unsigned int, int, int, double, unsigned int, int, \
+                                            int, int, int, int, int, int);
+
+#endif /*COV_SHARD_H*/
@@ -0,0 +1,426 @@
+/* ************************************************************//** @file srv.c
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Resident server of runs: a Unix domain socket, a pool of workers and
+       a cache of networks.
+
+Thread zero of the pool accepts connections and queues them; the others each
+take the oldest, read its request and serve it.  A network asked for while
+another worker is building it is waited for rather than built twice.  The
+server stops on SIGINT or SIGTERM, once the connections already accepted
+have been served.
+*//* *************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "swn.h"
+#include "net.h"
+#include "par.h"
+#include "ana.h"
+#include "hyb.h"
+#include "srv.h"
+
+#define SRV_LAPSE   (500)     /**< Milliseconds between looks for a signal   */
+#define SRV_PATIENCE (10)     /**< Seconds a connection may take to ask      */
+
+/** Set by a signal to stop */
+static volatile sig_atomic_t stopping;
+
+/** The work of one thread of the pool */
+struct srvthread
+  {
+  struct srv *psrv;           /**< The server                                */
+  int         index;          /**< Zero to accept connections, else serve    */
+  };
+
+/* ************************************************************************//**
+@brief   Note that the server is to stop.
+*//***************************************************************************/
+static void
+ onsignal(int sig)
+{
+(void)sig; stopping = 1;
+}
+/* ************************************************************************//**
+@brief   Find a network in the cache.
+@return  Its index, or -1 if it is not there.
+*//***************************************************************************/
+static int
+ find(const struct srv *ps, const struct srvkey *pk)
+{
+const struct srvkey *pw;
+int k;
+
+for (k = 0; k < ps->netmany; k++)
+  {
+  pw = &ps->pnet[k].key;
+  if ((pw->kind == pk->kind) && (pw->seed == pk->seed) && \
+      (pw->manynode == pk->manynode) && (pw->halfdegree == pk->halfdegree) && \
+      (pw->beta == pk->beta) && (pw->mtime == pk->mtime) && \
+                   (pw->size == pk->size) && ! strcmp(pw->path, pk->path))
+    {
+    return k;
+    }
+  }
+return -1;
+}
+/* ************************************************************************//**
+@brief   Release a network as it was made.
+*//***************************************************************************/
+static void
+ discard(struct srvnet *pn)
+{
+if (SRV_SWN == pn->key.kind) swn(0, pn->manynode, 0, 0., &pn->pnode0);
+else                         netfree(pn->manynode, &pn->pnode0);
+}
+/* ************************************************************************//**
+@brief   Release the least recently used networks not in use, until the cache
+         holds no more than it should.  The lock is held.
+*//***************************************************************************/
+static void
+ trim(struct srv *ps)
+{
+int k, lru;
+
+while (ps->netmany > ps->manynet)
+  {
+  for (lru = -1, k = 0; k < ps->netmany; k++)
+    {
+    if (ps->pnet[k].users || ! ps->pnet[k].ready) continue;
+    if ((0 > lru) || (ps->pnet[k].used < ps->pnet[lru].used)) lru = k;
+    }
+  if (0 > lru) break;
+  discard(ps->pnet + lru);
+  ps->pnet[lru] = ps->pnet[--ps->netmany];
+  }
+}
+/* ************************************************************************//**
+@brief   Get a network from the cache, building it if it is not there.
+@param   ps          The server.
+@param   pk          The network.
+@param   manythread  Threads for swnpar(), should it be built.
+@param   ppnode0     Set to the base of its nodes.
+@param   pmanynode   Set to their number.
+@param   pshape      Set to what hybmeasure() found of it, once when built.
+@return              1 if it was in the cache, 0 if built, or <0 if error.
+@note    Hand it back to srvrelease() once done with it.
+*//***************************************************************************/
+int
+ srvnetwork(struct srv *ps, const struct srvkey *pk, int manythread, \
+              struct node **ppnode0, int *pmanynode, struct hybnet *pshape)
+{
+struct srvnet *pn;
+struct node *pnode0;
+struct hybnet shape;
+int k, manynode, rc;
+
+pthread_mutex_lock(&ps->lock);
+while ((0 <= (k = find(ps, pk))) && ! ps->pnet[k].ready)
+  {
+  pthread_cond_wait(&ps->cond, &ps->lock);
+  }
+ps->tick++;
+if (0 <= k)
+  {
+  pn = ps->pnet + k; pn->users++; pn->used = ps->tick;
+  *ppnode0 = pn->pnode0; *pmanynode = pn->manynode; *pshape = pn->shape;
+  pthread_mutex_unlock(&ps->lock);
+  return 1;
+  }
+if (ps->netmany >= ps->netroom)
+  {
+  k = ps->netroom ? 2*ps->netroom : 8;
+  if (NULL == (pn = (struct srvnet *)realloc(ps->pnet, \
+                                                 k*sizeof(struct srvnet))))
+    {
+    pthread_mutex_unlock(&ps->lock);
+    fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+    }
+  ps->pnet = pn; ps->netroom = k;
+  }
+pn = ps->pnet + ps->netmany++;
+memset(pn, 0, sizeof(struct srvnet));
+pn->key = *pk; pn->users = 1; pn->used = ps->tick;
+pthread_mutex_unlock(&ps->lock);
+/*-----------------------------------------------------------------------------
+BUILD IT WITHOUT THE LOCK: OTHERS WANTING IT WAIT, THE REST CARRY ON
+-----------------------------------------------------------------------------*/
+pnode0 = NULL; manynode = pk->manynode;
+if (SRV_SWN == pk->kind) rc = swn(pk->seed, manynode, pk->halfdegree, \
+                                              pk->beta/1024., &pnode0);
+else if (SRV_SWNPAR == pk->kind) rc = swnpar(pk->seed, manynode, \
+                        pk->halfdegree, pk->beta/1024., manythread, &pnode0);
+else rc = netload(pk->path, &manynode, &pnode0);
+if ((0 <= rc) && \
+    (0 > (rc = hybmeasure(&shape, manynode, pnode0, manythread, NULL))))
+  {
+  if (SRV_SWN == pk->kind) swn(0, manynode, 0, 0., &pnode0);
+  else                     netfree(manynode, &pnode0);
+  }
+pthread_mutex_lock(&ps->lock);
+k = find(ps, pk); pn = ps->pnet + k;
+if (0 > rc) ps->pnet[k] = ps->pnet[--ps->netmany];
+else
+  {
+  pn->pnode0 = pnode0; pn->manynode = manynode; pn->shape = shape;
+  pn->ready = 1;
+  *ppnode0 = pnode0; *pmanynode = manynode; *pshape = shape;
+  trim(ps);
+  }
+pthread_cond_broadcast(&ps->cond);
+pthread_mutex_unlock(&ps->lock);
+return (0 > rc) ? rc : 0;
+}
+/* ************************************************************************//**
+@brief   Hand back a network got from srvnetwork().
+*//***************************************************************************/
+void
+ srvrelease(struct srv *ps, const struct node *pnode0)
+{
+int k;
+
+pthread_mutex_lock(&ps->lock);
+for (k = 0; k < ps->netmany; k++)
+  {
+  if (ps->pnet[k].ready && (pnode0 == ps->pnet[k].pnode0))
+    {
+    ps->pnet[k].users--; break;
+    }
+  }
+trim(ps);
+pthread_mutex_unlock(&ps->lock);
+}
+/* ************************************************************************//**
+@brief   Accept connections and queue them, until a signal comes.
+*//***************************************************************************/
+static void
+ accepting(struct srv *ps)
+{
+struct pollfd pfd;
+int *pnew, fd, rc;
+
+pfd.fd = ps->fd; pfd.events = POLLIN;
+while ( ! stopping)
+  {
+  pfd.revents = 0;
+  if (0 > (rc = poll(&pfd, 1, SRV_LAPSE)))
+    {
+    if (EINTR == errno) continue;
+    fprintf(stderr, "ERROR: cannot wait for connections: %s\n", \
+                                                           strerror(errno));
+    break;
+    }
+  if ( ! rc) continue;
+  if (0 > (fd = accept(ps->fd, NULL, NULL)))
+    {
+    if ((EINTR == errno) || (ECONNABORTED == errno) || (EAGAIN == errno)) \
+                                                                     continue;
+    fprintf(stderr, "ERROR: cannot accept a connection: %s\n", \
+                                                           strerror(errno));
+    break;
+    }
+  pthread_mutex_lock(&ps->lock);
+  if (ps->queuemany >= ps->queueroom)
+    {
+    rc = ps->queueroom ? 2*ps->queueroom : 64;
+    if (NULL == (pnew = (int *)realloc(ps->pqueue, rc*sizeof(int))))
+      {
+      pthread_mutex_unlock(&ps->lock); close(fd);
+      fprintf(stderr, "ERROR: memory request refused\n"); continue;
+      }
+    ps->pqueue = pnew; ps->queueroom = rc;
+    }
+  ps->pqueue[ps->queuemany++] = fd;
+  pthread_cond_broadcast(&ps->cond);
+  pthread_mutex_unlock(&ps->lock);
+  }
+pthread_mutex_lock(&ps->lock);
+ps->stop = 1;
+pthread_cond_broadcast(&ps->cond);
+pthread_mutex_unlock(&ps->lock);
+}
+/* ************************************************************************//**
+@brief   Serve the queued connections, oldest first, until told to stop and
+         none is left.
+*//***************************************************************************/
+static void
+ serving(struct srv *ps)
+{
+char request[SRV_MANYREQUEST];
+struct timeval tv;
+struct timespec ts0, ts1;
+FILE *pf;
+size_t got;
+ssize_t more;
+char *p1;
+int fd, rc;
+
+while (1)
+  {
+  pthread_mutex_lock(&ps->lock);
+  while ( ! ps->queuemany && ! ps->stop)
+    {
+    pthread_cond_wait(&ps->cond, &ps->lock);
+    }
+  if ( ! ps->queuemany) { pthread_mutex_unlock(&ps->lock); break; }
+  fd = ps->pqueue[0];
+  memmove(ps->pqueue, ps->pqueue + 1, --ps->queuemany*sizeof(int));
+  pthread_mutex_unlock(&ps->lock);
+/*-----------------------------------------------------------------------------
+READ THE REQUEST, A SINGLE LINE, WITHIN SRV_PATIENCE
+-----------------------------------------------------------------------------*/
+  tv.tv_sec = SRV_PATIENCE; tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  got = 0; p1 = NULL;
+  while (got < SRV_MANYREQUEST - 1)
+    {
+    if (0 >= (more = read(fd, &request[got], SRV_MANYREQUEST - 1 - got)))
+      {
+      if ((0 > more) && (EINTR == errno)) continue;
+      break;
+      }
+    got += more; request[got] = 0;
+    if (NULL != (p1 = strchr(&request[0], '\n'))) break;
+    }
+  request[got] = 0;
+  if (p1) *p1 = 0;
+  if ((p1 = strchr(&request[0], '\r'))) *p1 = 0;
+  if (NULL == (pf = fdopen(fd, "w"))) { close(fd); continue; }
+  clock_gettime(CLOCK_MONOTONIC, &ts0);
+  if (got >= SRV_MANYREQUEST - 1)
+    {
+    fprintf(pf, "ERROR: request too long\n"); rc = -1;
+    }
+  else rc = (*ps->pserve)(ps, pf, &request[0]);
+  fclose(pf);
+  clock_gettime(CLOCK_MONOTONIC, &ts1);
+  printf("%9.3f ms %s %s\n", 1e3*(ts1.tv_sec - ts0.tv_sec) + \
+         1e-6*(ts1.tv_nsec - ts0.tv_nsec), rc ? "failed:" : "served:", \
+                                                                  &request[0]);
+  fflush(stdout);
+  }
+}
+/* ************************************************************************//**
+@brief   Accept connections on one thread, or serve them on the others.
+*//***************************************************************************/
+static void *
+ srvthread(void *pv)
+{
+struct srvthread *pt;
+
+pt = (struct srvthread *)pv;
+if (pt->index) serving(pt->psrv);
+else           accepting(pt->psrv);
+return NULL;
+}
+/* ************************************************************************//**
+@brief   Serve requests on a Unix domain socket until SIGINT or SIGTERM.
+@param   psock       The path of the socket.  A socket left there by a server
+                     no longer listening is replaced.
+@param   manyworker  Workers in the pool, each serving one request at a time.
+@param   manynet     Networks the cache holds when none is in use.
+@param   pserve      The function that serves a request, given the server
+                     (for srvnetwork()), a stream back to the client and the
+                     request, without its newline.  It returns zero unless
+                     error, and the stream is closed after it returns.
+@return              Zero unless error.
+*//***************************************************************************/
+int
+ srvrun(const char *psock, int manyworker, int manynet, \
+                                 int (*pserve)(struct srv *, FILE *, char *))
+{
+struct srv s;
+struct srvthread *pt;
+struct sockaddr_un addr;
+struct sigaction sa;
+struct stat st;
+int k, rc;
+
+memset(&s, 0, sizeof(s));
+memset(&addr, 0, sizeof(addr)); addr.sun_family = AF_UNIX;
+if (sizeof(addr.sun_path) <= strlen(psock))
+  {
+  fprintf(stderr, "ERROR: name of socket too long: %s\n", psock); return -1;
+  }
+strcpy(addr.sun_path, psock);
+if (0 > (s.fd = socket(AF_UNIX, SOCK_STREAM, 0)))
+  {
+  fprintf(stderr, "ERROR: cannot make a socket: %s\n", strerror(errno));
+  return -16;
+  }
+if ( ! stat(psock, &st))
+  {
+  if ( ! S_ISSOCK(st.st_mode) || ! connect(s.fd, (struct sockaddr *)&addr, \
+                                                                sizeof(addr)))
+    {
+    fprintf(stderr, "ERROR: %s: %s\n", S_ISSOCK(st.st_mode) ? \
+              "a server is listening already on" : "not a socket", psock);
+    close(s.fd); return -16;
+    }
+  close(s.fd); unlink(psock);
+  if (0 > (s.fd = socket(AF_UNIX, SOCK_STREAM, 0)))
+    {
+    fprintf(stderr, "ERROR: cannot make a socket: %s\n", strerror(errno));
+    return -16;
+    }
+  }
+if (bind(s.fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(s.fd, 64))
+  {
+  fprintf(stderr, "ERROR: cannot listen on %s: %s\n", psock, strerror(errno));
+  close(s.fd); return -16;
+  }
+if (NULL == (pt = (struct srvthread *)calloc(manyworker + 1, \
+                                                   sizeof(struct srvthread))))
+  {
+  close(s.fd); unlink(psock);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+s.manyworker = manyworker; s.manynet = manynet; s.pserve = pserve;
+pthread_mutex_init(&s.lock, NULL); pthread_cond_init(&s.cond, NULL);
+memset(&sa, 0, sizeof(sa)); sa.sa_handler = onsignal;
+sigaction(SIGINT, &sa, NULL); sigaction(SIGTERM, &sa, NULL);
+signal(SIGPIPE, SIG_IGN);
+for (k = 0; k <= manyworker; k++) { pt[k].psrv = &s; pt[k].index = k; }
+printf("listening on %s: %i workers, %i networks cached\n", psock, \
+                                                         manyworker, manynet);
+fflush(stdout);
+/*-----------------------------------------------------------------------------
+SERVE UNTIL A SIGNAL, THEN RELEASE EVERYTHING
+-----------------------------------------------------------------------------*/
+rc = parallel(manyworker + 1, srvthread, pt, sizeof(struct srvthread));
+close(s.fd); unlink(psock);
+for (k = 0; k < s.netmany; k++) discard(s.pnet + k);
+free(s.pnet); free(s.pqueue); free(pt);
+pthread_cond_destroy(&s.cond); pthread_mutex_destroy(&s.lock);
+printf("stopped serving on %s\n", psock);
+return rc;
+}
+/* ***************************************************************************/
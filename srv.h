@@ -0,0 +1,95 @@
+/* ************************************************************//** @file srv.h
+@copyright
+Copyright (c) 2020  Richard Michael Thomas <rmthomas@sciolus.org>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+______________________________________________________________________________
+@brief Header required by clients of the resident server of runs.
+
+The server listens on a Unix domain socket.  Each connection carries one
+request, a single line, which a worker of the pool reads and hands to the
+client's function together with a stream back to the connection; the
+connection is closed once the function returns.  The networks the requests
+need are kept in a cache shared by the workers, the least recently used
+being released once there are more than the cache holds and none is in use.
+*//* *************************************************************************/
+
+#ifndef COV_SERVER_H
+#define COV_SERVER_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "swn.h"
+#include "hyb.h"
+
+#define SRV_MANYREQUEST (4096)  /**< Longest request, with its newline       */
+
+/** How a network is made */
+enum { SRV_SWN, SRV_SWNPAR, SRV_FILE };
+
+/** What identifies a network in the cache */
+struct srvkey
+  {
+  int           kind;         /**< SRV_SWN, SRV_SWNPAR or SRV_FILE           */
+  unsigned int  seed;         /**< Seed of swn() or swnpar()                 */
+  int           manynode;     /**< Nodes                                     */
+  int           halfdegree;   /**< Half the degree of the ring               */
+  int           beta;         /**< Rewiring fraction, in 1024ths             */
+  char          path[1024];   /**< The file given to netload(), or empty     */
+  long          mtime;        /**< Its time of modification                  */
+  long          size;         /**< Its size                                  */
+  };
+
+/** A network in the cache */
+struct srvnet
+  {
+  struct srvkey key;          /**< What it is                                */
+  struct node  *pnode0;       /**< Its nodes                                 */
+  int           manynode;     /**< Their number                              */
+  struct hybnet shape;        /**< What hybmeasure() found of it             */
+  int           ready;        /**< Zero while it is being built              */
+  int           users;        /**< Requests using it now                     */
+  long          used;         /**< When it was last asked for                */
+  };
+
+/** The server */
+struct srv
+  {
+  int              fd;        /**< The listening socket                      */
+  int              manyworker;/**< Workers in the pool                       */
+  int              manynet;   /**< Networks the cache holds, if none in use  */
+  int            (*pserve)(struct srv *, FILE *, char *); /**< Serves each  */
+  pthread_mutex_t  lock;      /**< Guards all that follows                   */
+  pthread_cond_t   cond;      /**< Signals a connection or a network ready   */
+  int             *pqueue;    /**< Connections accepted, not yet served      */
+  int              queuemany; /**< Their number                              */
+  int              queueroom; /**< Room at .pqueue                           */
+  struct srvnet   *pnet;      /**< The cache                                 */
+  int              netmany;   /**< Networks in it, or being built for it     */
+  int              netroom;   /**< Room at .pnet                             */
+  long             tick;      /**< Count of requests for networks            */
+  int              stop;      /**< Set once the server is to stop            */
+  };
+
+int  srvrun(const char *, int, int, int (*)(struct srv *, FILE *, char *));
+int  srvnetwork(struct srv *, const struct srvkey *, int, struct node **, \
+                                                    int *, struct hybnet *);
+void srvrelease(struct srv *, const struct node *);
+
+#endif /*COV_SERVER_H*/
@@ -32,9 +32,27 @@ References:                                                                 \n
 #include <errno.h>
 #include <math.h>
 #include <assert.h>
+#include <stdint.h>
 #include "swn.h"
+#include "net.h"
+#include "par.h"
 
-int BarratWeigt(int,double,int,double *);
+#define SWN_TRIES     (1024)  /**< Random redraws of a duplicate link before
+                                   resorting to a search of all nodes        */
+#define SWN_NEGLIGIBLE (1.e-12) /**< Probability below which the tail of the
+                                   distribution of Ref.[2] is dropped        */
+
+static int bwtable(int, double);
+
+/** Memo of the distribution of Ref.[2] for the last (halfdegree, beta) */
+static struct
+  {
+  int     k;           /**< Halfdegree                                       */
+  double  beta;        /**< Rewiring parameter                               */
+  double *pc0;         /**< Probability of each degree from zero             */
+  int     manyc;       /**< Number of degrees tabulated                      */
+  int     roomc;       /**< Number of entries allocated at .pc0              */
+  } bwmemo;
 
 /* ************************************************************************//**
 @brief   Insert an edge beween two nodes.
@@ -133,53 +151,89 @@ for (n = 0; n < 2; n++)
 return 0;
 }
 /* ************************************************************************//**
-@param   swnseed     Seed for srand().        
+@brief   Tabulate the degree distribution alongside the distribution
+         expected from Ref.[2].
+@param   pf          The output file.
 @param   manynode    The number of nodes,
 @param   halfdegree  Half the degree of nodes in the first-stage ring.
 @param   dbeta       The rewiring fraction.
-@param   ppnode0     Location to receive the base of the array of nodes.
+@param   pnode0      The base of the array of nodes.
 @return              Zero unless error.
-@note                To free memory, call with the extant manynode and ppnode0,
-                     but with halfdegree=0.  On return *ppnode0 will be NULL.
+@note    The constructors no longer write this report themselves: a client
+         wanting it calls this function, with a file of its own choosing.
+@note    It reads the table of Ref.[2] through BarratWeigt(), whose memo of
+         it is one per process and unlocked: call it from one thread only,
+         never from the workers of cov -S, which is why -S serves no -d.
 *//* *************************************************************************/
 int
- swn(unsigned int swnseed, int manynode, int halfdegree, double dbeta, \
-                                                         struct node **ppnode0)
+ swnreport(FILE *pf, int manynode, int halfdegree, double dbeta, \
+                                                          struct node *pnode0)
 {
-struct node *pnode0, **pp;
-int j, m, n, lap, other;
+struct node **pp;
+int j, m, n;
 int manytub, *ptub0;
-unsigned int seed;
-int beta;
-FILE *pftubs;
 int chktubs;
 double bw, chkbw, tail;
-int rc;
 
-rc = 0;
-/*-----------------------------------------------------------------------------
-FREE MEMORY
------------------------------------------------------------------------------*/
-if ( ! halfdegree)
+manytub = 6 * halfdegree;
+if (NULL == (ptub0 = (int *)malloc(manytub * sizeof(int))))
   {
-  if (NULL != (pnode0 = *ppnode0))
-    {
-    for (j = 0; j < manynode; j++) { free((pnode0 + j)->pp0); }
-    free(pnode0); *ppnode0 = NULL;
-    }
-  return 0;
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
   }
 /*-----------------------------------------------------------------------------
-VALIDATE ARGUMENTS
+GET THE DEGREE DISTRIBUTION
 -----------------------------------------------------------------------------*/
-if (manynode <= (2 * halfdegree))
+for (n = 0; n < manytub; n++) { *(ptub0 + n) = 0; }
+for (j = 0, n = 0; j < manynode; j++)
   {
-  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
-                                                    2 * halfdegree); return -1;
+  pp = (pnode0 + j)->pp0;
+  while (NULL != *pp) { pp++; }
+  n = pp - ((pnode0 + j)->pp0);
+  if (manytub <= n) n = manytub - 1;
+  (*(ptub0 + n))++;
   }
-beta = (int)(nearbyint(1024. * dbeta));
-if ((0 > beta) || (1024 < beta)) \
-                  { fprintf(stderr, "ERROR: beta out of range\n"); return -1; }
+for (n = 0, m = 0; n < manytub; n++) { m += *(ptub0 + n); }
+if (manynode != m) { free(ptub0); return -6; }
+
+fprintf(pf, "%7i=manynode, %i=halfdegree, %5.3f=beta\n\n", \
+                                                  manynode, halfdegree, dbeta);
+fprintf(pf, "  Degree   Node count   Fraction     Ref.[2]\n");
+chktubs = 0; chkbw = 0.;
+for (n = 0; n < manytub - 1; n++)
+  {
+  if (0 > BarratWeigt(halfdegree, dbeta, n, &bw)) {;}
+
+  fprintf(pf,"  %4i       %7i    %8.6f    %8.6f\n", \
+             n, *(ptub0 + n), ((double)(*(ptub0 + n)))/((double)manynode), bw);
+  chktubs += *(ptub0 + n);
+  chkbw += bw;
+  }
+tail = 0.;
+for (m = n; m < bwmemo.manyc; m++) { tail += *(bwmemo.pc0 + m); }
+assert(n == manytub - 1);
+chktubs += *(ptub0 + n);
+fprintf(pf,">=%4i       %7i    %8.6f    %8.6f\n", \
+           n, *(ptub0 + n), ((double)(*(ptub0 + n)))/((double)manynode), tail);
+chkbw += tail;
+assert(chktubs == manynode);
+assert(1.e-7 > fabs(1. - chkbw));
+free(ptub0);
+return 0;
+}
+/* ************************************************************************//**
+@brief   Construct the ring lattice from which the small-world network is
+         derived by rewiring.
+@param   manynode    The number of nodes,
+@param   halfdegree  Half the degree of nodes in the ring.
+@param   ppnode0     Location to receive the base of the array of nodes.
+@return              Zero unless error.
+*//* *************************************************************************/
+static int
+ ring(int manynode, int halfdegree, struct node **ppnode0)
+{
+struct node *pnode0;
+int j, m, n;
+
 /*-----------------------------------------------------------------------------
 ALLOCATE MEMORY
 -----------------------------------------------------------------------------*/
@@ -197,11 +251,6 @@ for (j = 0; j < manynode; j++)
     }
   *((pnode0 + j)->pp0) = NULL;
   }
-manytub = 6 * halfdegree;
-if (NULL == (ptub0 = (int *)malloc(manytub * sizeof(int))))
-  {
-  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
-  }
 /*-----------------------------------------------------------------------------
 CONSTRUCT THE RING LATTICE.
 
@@ -228,6 +277,54 @@ for (j = 0; j < manynode; j++)
     if (0 > setupedge((pnode0 + j), (pnode0 + m))) return -2;
     }
   }
+return 0;
+}
+/* ************************************************************************//**
+@param   swnseed     Seed for srand().        
+@param   manynode    The number of nodes,
+@param   halfdegree  Half the degree of nodes in the first-stage ring.
+@param   dbeta       The rewiring fraction.
+@param   ppnode0     Location to receive the base of the array of nodes.
+@return              Zero unless error.
+@note                To free memory, call with the extant manynode and ppnode0,
+                     but with halfdegree=0.  On return *ppnode0 will be NULL.
+*//* *************************************************************************/
+int
+ swn(unsigned int swnseed, int manynode, int halfdegree, double dbeta, \
+                                                         struct node **ppnode0)
+{
+struct node *pnode0, **pp;
+int j, m, lap, other;
+unsigned int seed;
+int beta;
+int rc;
+
+rc = 0;
+/*-----------------------------------------------------------------------------
+FREE MEMORY
+-----------------------------------------------------------------------------*/
+if ( ! halfdegree)
+  {
+  if (NULL != (pnode0 = *ppnode0))
+    {
+    for (j = 0; j < manynode; j++) { free((pnode0 + j)->pp0); }
+    free(pnode0); *ppnode0 = NULL;
+    }
+  return 0;
+  }
+/*-----------------------------------------------------------------------------
+VALIDATE ARGUMENTS
+-----------------------------------------------------------------------------*/
+if (manynode <= (2 * halfdegree))
+  {
+  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
+                                                    2 * halfdegree); return -1;
+  }
+beta = (int)(nearbyint(1024. * dbeta));
+if ((0 > beta) || (1024 < beta)) \
+                  { fprintf(stderr, "ERROR: beta out of range\n"); return -1; }
+if (0 > (rc = ring(manynode, halfdegree, ppnode0))) return rc;
+pnode0 = *ppnode0;
 /*-----------------------------------------------------------------------------
 REWIRE.
 
@@ -261,104 +358,533 @@ CHOOSE ANOTHER NODE TO LINK TO, REJECTING DUPLICATES AND LOOPS
     if (0 < rc) return -5;
     }
   }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Construct, or add rewiring to, a small-world network in which the
+         links rewired at one beta are a subset of those rewired at any
+         larger beta.
+
+Ring link  e = j*halfdegree + l  of node  j  (to node  j+l+1) has its own
+random stream, whose first value  u  is uniform on  0 <= u < 1.  The link is
+rewired once beta exceeds  u, to a node drawn from the same stream that is
+neither  j  nor already a neighbour of  j.  Thus a series of networks for
+increasing beta is obtained by rewiring only the links with
+dbetawas <= u < dbeta  at each step; neighbouring networks in the series
+differ only in those links, which also couples the epidemics run on them.
+
+@param   swnseed     Seed for the random streams.
+@param   manynode    The number of nodes,
+@param   halfdegree  Half the degree of nodes in the first-stage ring.
+@param   dbetawas    The rewiring fraction of the network at  *ppnode0.
+@param   dbeta       The rewiring fraction wanted, not less than dbetawas.
+@param   ppnode0     Location of the base of the array of nodes.  If this
+                     holds NULL the ring lattice is constructed first, and
+                     dbetawas is ignored.
+@return              Zero unless error.
+@note    Release the network with swn(), as for swn() itself.  The network is
+         statistically, but not exactly, that which swn() would construct.
+*//* *************************************************************************/
+int
+ swncouple(unsigned int swnseed, int manynode, int halfdegree, \
+                          double dbetawas, double dbeta, struct node **ppnode0)
+{
+struct node *pnode0, **pp;
+uint64_t state;
+size_t e;
+double u;
+int j, m, lap, other, tries;
+int rc;
+
 /*-----------------------------------------------------------------------------
-GET THE DEGREE DISTRIBUTION
+VALIDATE ARGUMENTS
 -----------------------------------------------------------------------------*/
-for (n = 0; n < manytub; n++) { *(ptub0 + n) = 0; }
-for (j = 0, n = 0; j < manynode; j++)
+if ((0 >= halfdegree) || (manynode <= (2 * halfdegree)))
   {
-  pp = (pnode0 + j)->pp0;
-  while (NULL != *pp) { pp++; }
-  n = pp - ((pnode0 + j)->pp0);
-  if (manytub <= n) n = manytub - 1;
-  (*(ptub0 + n))++;
+  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
+                                                    2 * halfdegree); return -1;
   }
-for (n = 0, m = 0; n < manytub; n++) { m += *(ptub0 + n); }
-if (manynode != m) return -6;
-
-if (NULL == (pftubs = fopen("tubs.txt", "w")))
+if (NULL == *ppnode0) dbetawas = 0.;
+if ((0. > dbetawas) || (dbetawas > dbeta) || (1. < dbeta)) \
+                  { fprintf(stderr, "ERROR: beta out of range\n"); return -1; }
+if (NULL == *ppnode0)
   {
-  fprintf(stderr, "WORRY: cannot open output file: %s\n", "tubs.txt");
+  if (0 > (rc = ring(manynode, halfdegree, ppnode0))) return rc;
   }
-else
+pnode0 = *ppnode0;
+/*-----------------------------------------------------------------------------
+REWIRE THE LINKS WHOSE THRESHOLDS LIE IN  dbetawas <= u < dbeta, IN THE ORDER
+USED BY swn().  A RING LINK IS ONLY EVER REMOVED BY ITS OWN REWIRING, SO IT IS
+STILL PRESENT WHEN ITS THRESHOLD IS REACHED.
+-----------------------------------------------------------------------------*/
+for (lap = 0; lap < halfdegree; lap++)
   {
-  fprintf(pftubs, "%7i=manynode, %i=halfdegree, %5.3f=beta\n\n", \
-                                                  manynode, halfdegree, dbeta);
-  fprintf(pftubs, "  Degree   Node count   Fraction     Ref.[2]\n");
-  chktubs = 0; chkbw = 0.;
-  for (n = 0; n < manytub - 1; n++)
+  for (j = 0; j < manynode; j++)
     {
-    if (0 > BarratWeigt(halfdegree, dbeta, n, &bw)) {;}
+    e = ((size_t)j * halfdegree) + lap;
+    state = rngstream((uint64_t)swnseed, (uint64_t)e);
+    u = (double)(rngnext(&state) >> 11) / 9007199254740992.;
+    if ((dbetawas > u) || (dbeta <= u)) continue;
+    m = j + (lap + 1);
+    if (manynode <= m) m -= manynode;
+    for (tries = 0, other = 0; tries < SWN_TRIES + manynode; tries++)
+      {
+      if (SWN_TRIES > tries) other = (int)rngbelow(&state, manynode);
+      else if (++other >= manynode) other = 0;
+      if (other == j) continue;
+      pp = (pnode0 + j)->pp0;
+      while (NULL != *pp) { if ((pnode0 + other) == *pp) break; pp++; }
+      if (NULL == *pp) break;
+      }
+    if (tries >= SWN_TRIES + manynode)
+      {
+      fprintf(stderr, "ERROR: network too dense to rewire\n"); return -5;
+      }
+    if (0 != breakedge((pnode0 + j), (pnode0 + m))) return -3;
+    if (0 > (rc = setupedge((pnode0 + j), (pnode0 + other)))) return -4;
+    if (0 < rc) return -5;
+    }
+  }
+return 0;
+}
+/* ************************************************************************//**
+@brief   Distance between two nodes, measured around the ring.
+*//***************************************************************************/
+static inline int
+ around(int manynode, int j, int m)
+{
+int d;
 
-    fprintf(pftubs,"  %4i       %7i    %8.6f    %8.6f\n", \
-             n, *(ptub0 + n), ((double)(*(ptub0 + n)))/((double)manynode), bw);
-    chktubs += *(ptub0 + n);
-    chkbw += bw;
+d = (j > m) ? j - m : m - j;
+return (d + d > manynode) ? manynode - d : d;
+}
+/* ************************************************************************//**
+@brief   Draw the far end of every link owned by the nodes of range  c, from
+         the random stream of the range.
+@param   ptarget  Where to put them:  halfdegree  for each node of the range.
+*//***************************************************************************/
+static void
+ rewire(uint64_t seed, int manynode, int k, int beta, int c, int *ptarget)
+{
+uint64_t state;
+int j, jend, l, m;
+
+j = c * SWN_RANGE;
+jend = ((manynode - j) > SWN_RANGE) ? j + SWN_RANGE : manynode;
+state = rngstream(seed, (uint64_t)c);
+for (; j < jend; j++)
+  {
+  for (l = 0; l < k; l++)
+    {
+    m = j + (l + 1); if (manynode <= m) m -= manynode;
+    if (beta > (int)rngbelow(&state, 1024))
+      {
+      do { m = (int)rngbelow(&state, manynode); }
+      while (k >= around(manynode, j, m));
+      }
+    *ptarget++ = m;
     }
-  tail = 0.; m = n;
-  while (1.e-8 < fabs(bw))
+  }
+}
+/* ************************************************************************//**
+@brief   Draw the links owned by the nodes of one range of SWN_RANGE, as
+         swnpar() first draws them, before any duplicate is redrawn.  A
+         client may so find the links of any set of nodes from the ranges
+         alone, without the network as a whole.
+@param   swnseed     Seed for the random streams, as for swnpar().
+@param   manynode    The number of nodes,
+@param   halfdegree  Half the degree of nodes in the first-stage ring.
+@param   dbeta       The rewiring fraction.
+@param   c           The range, of nodes  c*SWN_RANGE  on.
+@param   ptarget     Where to put the far end of link  l  of node
+                     c*SWN_RANGE + i, at  i*halfdegree + l: room for
+                     SWN_RANGE*halfdegree  in all.
+@return              The number of nodes in the range, zero beyond the last.
+@note    The arguments are not checked: swnpar() would accept them.
+*//* *************************************************************************/
+int
+ swnowned(unsigned int swnseed, int manynode, int halfdegree, double dbeta, \
+                                                           int c, int *ptarget)
+{
+int j;
+
+if ((0 > c) || ((size_t)c * SWN_RANGE >= (size_t)manynode)) return 0;
+j = c * SWN_RANGE;
+rewire((uint64_t)swnseed, manynode, halfdegree, \
+                      (int)(nearbyint(1024. * dbeta)), c, ptarget);
+return ((manynode - j) > SWN_RANGE) ? SWN_RANGE : manynode - j;
+}
+/** Phases of the work done on each range of nodes by swnpar()               */
+enum { SWN_REWIRE, SWN_COUNT, SWN_FILL, SWN_CHECK };
+
+/** Work on the ranges of nodes assigned to one thread of swnpar()           */
+struct swnwork
+  {
+  int           phase;        /**< One of SWN_REWIRE...SWN_CHECK             */
+  int           thread;       /**< This thread's number                      */
+  int           manythread;   /**< The number of threads                     */
+  int           manynode;     /**< The number of nodes                       */
+  int           halfdegree;   /**< Half the degree of nodes in the ring      */
+  int           beta;         /**< Rewiring probability, in 1024ths          */
+  uint64_t      seed;         /**< Seed from which range streams derive      */
+  int          *ptarget;      /**< Far end of every link owned by each node  */
+  int          *pdegree;      /**< Degree counts, later fill cursors         */
+  struct node  *pnode0;       /**< The base of the array of nodes            */
+  size_t       *pclash;       /**< Links found to duplicate another          */
+  size_t        manyclash;    /**< Number of entries in use at .pclash       */
+  size_t        roomclash;    /**< Number of entries allocated at .pclash    */
+  int           rc;           /**< Zero unless error                         */
+  };
+
+/* ************************************************************************//**
+@brief   Carry out one phase of swnpar() on the ranges of nodes assigned to
+         one thread.  Range  c  of SWN_RANGE nodes goes to thread  c  modulo
+         the number of threads, and has its own random stream, so the result
+         does not depend on the number of threads.
+*//***************************************************************************/
+static void *
+ swnrange(void *pvoid)
+{
+struct swnwork *pw;
+struct node *pnode0, **pp, **ppend;
+int *ptarget;
+size_t e, sz, *pclash;
+void *pnew;
+int c, j, jend, k, l, m, n, manynode;
+
+pw = (struct swnwork *)pvoid;
+pnode0 = pw->pnode0; ptarget = pw->ptarget;
+manynode = pw->manynode; k = pw->halfdegree;
+for (c = pw->thread; (c * (size_t)SWN_RANGE) < (size_t)manynode; \
+                                                         c += pw->manythread)
+  {
+  j = c * SWN_RANGE;
+  jend = ((manynode - j) > SWN_RANGE) ? j + SWN_RANGE : manynode;
+  switch (pw->phase)
     {
-    if (0 > BarratWeigt(halfdegree, dbeta, m, &bw)) {;}
-    tail += bw; m++;
+/*-----------------------------------------------------------------------------
+REWIRE THE LINK OF NODE  j  TO NODE  j+l+1  WITH PROBABILITY  beta  TO A NODE
+MORE THAN  halfdegree  AWAY ROUND THE RING.  SUCH A LINK CANNOT DUPLICATE ANY
+LINK OF THE RING, THOUGH IT MAY DUPLICATE ANOTHER REWIRED LINK.
+-----------------------------------------------------------------------------*/
+    case SWN_REWIRE:
+      rewire(pw->seed, manynode, k, pw->beta, c, ptarget + ((size_t)j * k));
+      break;
+    case SWN_COUNT:
+      for (; j < jend; j++)
+        {
+        __atomic_fetch_add(pw->pdegree + j, k, __ATOMIC_RELAXED);
+        for (l = 0; l < k; l++)
+          {
+          m = *(ptarget + ((size_t)j * k) + l);
+          __atomic_fetch_add(pw->pdegree + m, 1, __ATOMIC_RELAXED);
+          }
+        }
+      break;
+/*-----------------------------------------------------------------------------
+THE LINKS OWNED BY NODE  j  OCCUPY THE FIRST  halfdegree  PLACES IN ITS LIST
+-----------------------------------------------------------------------------*/
+    case SWN_FILL:
+      for (; j < jend; j++)
+        {
+        for (l = 0; l < k; l++)
+          {
+          m = *(ptarget + ((size_t)j * k) + l);
+          *((pnode0 + j)->pp0 + l) = pnode0 + m;
+          n = k + __atomic_fetch_add(pw->pdegree + m, 1, __ATOMIC_RELAXED);
+          *((pnode0 + m)->pp0 + n) = pnode0 + j;
+          }
+        }
+      break;
+/*-----------------------------------------------------------------------------
+SORT EACH LIST, AND RECORD ALL BUT ONE OF EVERY SET OF DUPLICATE LINKS
+BETWEEN  j  AND A LATER NODE  m.  ALL SUCH LINKS ARE REWIRED ONES, OWNED
+BY EITHER  j  OR  m.
+-----------------------------------------------------------------------------*/
+    case SWN_CHECK:
+      for (; j < jend; j++)
+        {
+        pp = (pnode0 + j)->pp0;
+        ppend = pp; while (NULL != *ppend) { ppend++; }
+        sz = (size_t)(ppend - pp);
+        netsort(pp, sz);
+        for (pp++; pp < ppend; pp++)
+          {
+          if ((*pp != *(pp - 1)) || (*pp < pnode0 + j)) continue;
+          m = (int)(*pp - pnode0);
+          for (n = 0, l = 0; l < 2 * k; l++)
+            {
+            if (k > l) e = ((size_t)j * k) + l;
+            else       e = ((size_t)m * k) + (l - k);
+            if (*(ptarget + e) != ((k > l) ? m : j)) continue;
+            if ( ! n++) continue;
+            if (pw->manyclash >= pw->roomclash)
+              {
+              sz = pw->roomclash ? 2 * pw->roomclash : 64;
+              if (NULL == (pnew = realloc(pw->pclash, sz * sizeof(size_t))))
+                {
+                pw->rc = -8; return NULL;
+                }
+              pw->pclash = (size_t *)pnew; pw->roomclash = sz;
+              }
+            pclash = pw->pclash + pw->manyclash++;
+            *pclash = e;
+            }
+          while ((pp + 1 < ppend) && (*(pp + 1) == *pp)) { pp++; }
+          }
+        }
+      break;
     }
-  assert(n == manytub - 1);
-  chktubs += *(ptub0 + n);
-  fprintf(pftubs,">=%4i       %7i    %8.6f    %8.6f\n", \
-           n, *(ptub0 + n), ((double)(*(ptub0 + n)))/((double)manynode), tail);
-  chkbw += tail;
-  fclose(pftubs);
-  assert(chktubs == manynode);
-  assert(1.e-7 > fabs(1. - chkbw));
   }
-if (ptub0) free(ptub0);
-return 0;
+return NULL;
 }
 /* ************************************************************************//**
-@brief  Probability distribution of degree.
+@brief   Order of link numbers, for qsort().
+*//***************************************************************************/
+static int
+ bylink(const void *pa, const void *pb)
+{
+size_t a = *(const size_t *)pa;
+size_t b = *(const size_t *)pb;
 
-@note   See: A.Barrat & M.Weigt 1999 "On the properties of small-world network
-        models", arXiv:cond-mat/9903411v2
+return (a > b) - (a < b);
+}
+/* ************************************************************************//**
+@brief   Construct the small-world network using several threads.
 
-@param  k         Halfdegree.
-@param  c         Connectivity.
-@param  beta      Rewiring parameter.
-@param  presult   Location to receive the probability.
+The ring links owned by each range of nodes are rewired concurrently, each
+range drawing on its own random stream.  A rewired link is never sent to
+within  halfdegree  of its owner round the ring, so only two rewired links can
+ever coincide; after the neighbour lists have been filled, any such duplicates
+are redrawn one at a time and the lists filled again.  The degree distribution
+is statistically that of swn(), and for a given seed the network is the same
+whatever the number of threads; it is not the network swn() would construct.
+
+@param   swnseed     Seed for the random streams.
+@param   manynode    The number of nodes,
+@param   halfdegree  Half the degree of nodes in the first-stage ring.
+@param   dbeta       The rewiring fraction.
+@param   manythread  The number of threads.
+@param   ppnode0     Location to receive the base of the array of nodes.
+@return              Zero unless error.
+@note    The network is a slab network: release it with netfree().
 *//* *************************************************************************/
 int
- BarratWeigt(int k, double beta, int c, double *presult)
+ swnpar(unsigned int swnseed, int manynode, int halfdegree, double dbeta, \
+                                         int manythread, struct node **ppnode0)
 {
-double sum, betacomp, t1, t2, t3, t4, t5, t6;
-int j, l, m, n, il, im;
+struct swnwork *pw0, *pw;
+struct node *pnode0, **pp;
+int *ptarget, *pdegree;
+size_t *pclash, manyclash, e;
+uint64_t state;
+int j, m, n, k, tries, phase, beta, rc;
 
-if (c < k) { *presult = 0.; return 0; }
-sum = 0.; betacomp = 1. - beta;
-for (n = 0; (n <= k) && (n <= (c - k)); n++)
+*ppnode0 = NULL; k = halfdegree;
+/*-----------------------------------------------------------------------------
+VALIDATE ARGUMENTS
+-----------------------------------------------------------------------------*/
+if ((0 >= halfdegree) || (manynode <= (2 * halfdegree)))
   {
-  m = 1; l = 1;
-  im = k; il = l;
-  for (j = 0; j < n; j++)
+  fprintf(stderr, "ERROR: too few nodes: must exceed %i\n", \
+                                                    2 * halfdegree); return -1;
+  }
+beta = (int)(nearbyint(1024. * dbeta));
+if ((0 > beta) || (1024 < beta)) \
+                  { fprintf(stderr, "ERROR: beta out of range\n"); return -1; }
+if (beta && (manynode <= (2 * halfdegree) + 1))
+  {
+  fprintf(stderr, "ERROR: too few nodes to rewire: must exceed %i\n", \
+                                                (2 * halfdegree) + 1); return -1;
+  }
+if (1 > manythread) manythread = 1;
+/*-----------------------------------------------------------------------------
+ALLOCATE MEMORY
+-----------------------------------------------------------------------------*/
+ptarget = (int *)malloc((size_t)manynode * k * sizeof(int));
+pdegree = (int *)malloc((size_t)manynode * sizeof(int));
+pw0 = (struct swnwork *)calloc(manythread, sizeof(struct swnwork));
+if ((NULL == ptarget) || (NULL == pdegree) || (NULL == pw0))
+  {
+  free(ptarget); free(pdegree); free(pw0);
+  fprintf(stderr, "ERROR: memory request refused\n"); return -8;
+  }
+for (n = 0; n < manythread; n++)
+  {
+  pw = pw0 + n;
+  pw->thread = n; pw->manythread = manythread;
+  pw->manynode = manynode; pw->halfdegree = k; pw->beta = beta;
+  pw->seed = (uint64_t)swnseed; pw->ptarget = ptarget; pw->pdegree = pdegree;
+  }
+/*-----------------------------------------------------------------------------
+REWIRE, THEN FILL AND CHECK THE LISTS UNTIL NO DUPLICATE LINKS REMAIN
+-----------------------------------------------------------------------------*/
+pnode0 = NULL; rc = 0;
+for (phase = SWN_REWIRE; phase <= SWN_CHECK; phase++)
+  {
+  if (SWN_COUNT == phase)
+    {
+    netfree(manynode, &pnode0);
+    memset(pdegree, 0, (size_t)manynode * sizeof(int));
+    }
+  if (SWN_FILL == phase)
+    {
+    if (0 > (rc = netslab(manynode, pdegree, &pnode0))) break;
+    memset(pdegree, 0, (size_t)manynode * sizeof(int));
+    }
+  for (n = 0; n < manythread; n++)
     {
-    m = m * im; im--;
-    l = l * il; il++;
+    (pw0 + n)->phase = phase; (pw0 + n)->pnode0 = pnode0;
+    (pw0 + n)->manyclash = 0;
     }
+  if (0 > (rc = parallel(manythread, swnrange, pw0, sizeof(struct swnwork))))
+    {
+    break;
+    }
+  for (n = 0; n < manythread; n++) { if ((pw0 + n)->rc) rc = (pw0 + n)->rc; }
+  if (rc) break;
+  if (SWN_CHECK != phase) continue;
+/*-----------------------------------------------------------------------------
+GATHER THE DUPLICATES IN A FIXED ORDER, AND REDRAW EACH AS IT WOULD HAVE BEEN
+DRAWN BY swn(): NOT WITHIN  halfdegree  ROUND THE RING, NOT ALREADY A
+NEIGHBOUR, AND NOT THE TARGET OF ANOTHER REDRAWN LINK OF THE SAME NODE.
+-----------------------------------------------------------------------------*/
+  for (n = 0, manyclash = 0; n < manythread; n++)
+    {
+    manyclash += (pw0 + n)->manyclash;
+    }
+  if ( ! manyclash) break;
+  if (NULL == (pclash = (size_t *)malloc(manyclash * sizeof(size_t))))
+    {
+    fprintf(stderr, "ERROR: memory request refused\n"); rc = -8; break;
+    }
+  for (n = 0, manyclash = 0; n < manythread; n++)
+    {
+    memcpy(pclash + manyclash, (pw0 + n)->pclash, \
+                                         (pw0 + n)->manyclash * sizeof(size_t));
+    manyclash += (pw0 + n)->manyclash;
+    }
+  qsort(pclash, manyclash, sizeof(size_t), bylink);
+  for (e = 0; e < manyclash; e++)
+    {
+    j = (int)(*(pclash + e) / k);
+    state = rngstream(rngmix((uint64_t)swnseed), *(pclash + e));
+    for (tries = 0; tries < SWN_TRIES + manynode; tries++)
+      {
+      if (SWN_TRIES > tries) m = (int)rngbelow(&state, manynode);
+      else if (++m >= manynode) m = 0;
+      if (k >= around(manynode, j, m)) continue;
+      for (pp = (pnode0 + j)->pp0; NULL != *pp; pp++)
+        {
+        if (*pp == pnode0 + m) break;
+        }
+      if (NULL != *pp) continue;
+      for (n = 0; n < k; n++)
+        {
+        if (m == *(ptarget + ((size_t)j * k) + n)) break;
+        if (j == *(ptarget + ((size_t)m * k) + n)) break;
+        }
+      if (n >= k) break;
+      }
+    if (tries >= SWN_TRIES + manynode)
+      {
+      fprintf(stderr, "ERROR: network too dense to rewire\n"); rc = -5; break;
+      }
+    *(ptarget + *(pclash + e)) = m;
+    }
+  free(pclash);
+  if (rc) break;
+  phase = SWN_REWIRE;
+  }
+for (n = 0; n < manythread; n++) { free((pw0 + n)->pclash); }
+free(pw0); free(pdegree); free(ptarget);
+if (rc)
+  {
+  netfree(manynode, &pnode0); return rc;
+  }
+*ppnode0 = pnode0;
+return 0;
+}
+/* ************************************************************************//**
+@brief  Logarithm of  x  to the power  e, taking  0  to the power  0  as  1.
+*//* *************************************************************************/
+static inline double
+ logpow(double x, int e)
+{
+if ( ! e) return 0.;
+if (0. >= x) return -HUGE_VAL;
+return e * log(x);
+}
+/* ************************************************************************//**
+@brief  Tabulate the distribution of Ref.[2] for one (halfdegree, beta), unless
+        it is the one already tabulated.
 
-  assert( ! (m % l));
-  t1 = (double)(m / l);
+Each term is summed in log space, using lgamma() for the binomial coefficient
+and the factorial, so neither overflows however large  k.  The table runs out
+to the degree beyond  2k  at which the probability falls below  SWN_NEGLIGIBLE,
+and successive calls for the same  k  and beta reuse it.  The memo is shared,
+so BarratWeigt() must not be called from several threads at once.
 
-  t2 = 1.; for (j = 0; j < n; j++)       { t2 = t2 * betacomp; }
+@param  k         Halfdegree.
+@param  beta      Rewiring parameter.
+@return           Zero unless error.
+*//* *************************************************************************/
+static int
+ bwtable(int k, double beta)
+{
+double sum, lbinom, lterm;
+double *pnew;
+int c, n, room;
 
-  assert(0 <= (k - n));
-  t3 = 1.; for (j = 0; j < (k - n); j++) { t3 = t3 * beta; }
+if (bwmemo.pc0 && (k == bwmemo.k) && (beta == bwmemo.beta)) return 0;
+bwmemo.manyc = 0; room = bwmemo.roomc;
+for (c = 0; ; c++)
+  {
+  sum = 0.;
+  for (n = 0; (c >= k) && (n <= k) && (n <= (c - k)); n++)
+    {
+    lbinom = lgamma(k + 1.) - lgamma(n + 1.) - lgamma(k - n + 1.);
+    lterm = lbinom + logpow(1. - beta, n) + logpow(beta, k - n) \
+          + logpow(k * beta, c - k - n) - lgamma(c - k - n + 1.) - (beta * k);
+    sum += exp(lterm);
+    }
+  if (c >= room)
+    {
+    room = room ? 2 * room : 64;
+    if (NULL == (pnew = (double *)realloc(bwmemo.pc0, room * sizeof(double))))
+      {
+      fprintf(stderr, "ERROR: memory request refused\n");
+      bwmemo.pc0 = NULL; bwmemo.roomc = 0; return -8;
+      }
+    bwmemo.pc0 = pnew; bwmemo.roomc = room;
+    }
+  *(bwmemo.pc0 + c) = sum;
+  bwmemo.manyc = c + 1;
+  if ((2 * k < c) && (SWN_NEGLIGIBLE > sum)) break;
+  }
+bwmemo.k = k; bwmemo.beta = beta;
+return 0;
+}
+/* ************************************************************************//**
+@brief  Probability distribution of degree.
 
-  assert(0 <= (c - k - n));
-  t4 = 1.; for (j = 0; j < (c - k - n); j++) { t4 = t4 * ( k * beta); }
-  t5 = 1.; for (j = c - k - n; 0 < j; j--) { t5 = t5 * j; }
+@note   See: A.Barrat & M.Weigt 1999 "On the properties of small-world network
+        models", arXiv:cond-mat/9903411v2
 
-  t6 = exp( - (beta * k));
+@param  k         Halfdegree.
+@param  beta      Rewiring parameter.
+@param  c         Connectivity.
+@param  presult   Location to receive the probability.
+@return           Zero unless error.
+*//* *************************************************************************/
+int
+ BarratWeigt(int k, double beta, int c, double *presult)
+{
+int rc;
 
-  sum += (t1 * t2 * t3 * t4 * t6) / t5;
-  }
-*presult = sum;
+*presult = 0.;
+if (0 > (rc = bwtable(k, beta))) return rc;
+if ((0 <= c) && (c < bwmemo.manyc)) *presult = *(bwmemo.pc0 + c);
 return 0;
 }
 /* ***************************************************************************/
@@ -26,6 +26,10 @@ ______________________________________________________________________________
 #ifndef SMALL_WORLD_MODEL_H
 #define SMALL_WORLD_MODEL_H
 
+#include <stdio.h>
+
+#define SWN_RANGE (1 << 16)  /**< Nodes in a range with its own random stream */
+
 /** A single elementary node */
 struct node
   {
@@ -33,5 +37,12 @@ struct node
   void         *pvoid;   /**< Pointer for convenience of client programs     */
   };
 
+int swn(unsigned int, int, int, double, struct node **);
+int swnpar(unsigned int, int, int, double, int, struct node **);
+int swnowned(unsigned int, int, int, double, int, int *);
+int swncouple(unsigned int, int, int, double, double, struct node **);
+int swnreport(FILE *, int, int, double, struct node *);
+int BarratWeigt(int, double, int, double *);
+
 #endif /*SMALL_WORLD_NETWORK_H*/
 